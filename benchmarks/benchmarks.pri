@@ -0,0 +1,20 @@
+exists( $${PWD}/../../config.pri ) : include($${PWD}/../../config.pri)
+QT = core network
+TEMPLATE = app
+CONFIG *= console c++11
+CONFIG -= app_bundle
+
+# the library is built in, LIBRARY_PATH may name another checkout to compare against
+isEmpty( LIBRARY_PATH ) : LIBRARY_PATH = $${PWD}/..
+COMMON_PATH = $${PWD}/common
+# the fake master of the tests serves the subagents
+include( $${PWD}/../tests/common/common.pri )
+INCLUDEPATH *= $${LIBRARY_PATH}/src $${COMMON_PATH} $${PWD}/../src
+HEADERS *= $$files( $${LIBRARY_PATH}/src/*.h ) $$files( $${COMMON_PATH}/*.h )
+SOURCES *= $$files( $${LIBRARY_PATH}/src/*.cpp ) $$files( $${COMMON_PATH}/*.cpp )
+# the fake master keeps OIDs in the class of this checkout
+!exists( $${LIBRARY_PATH}/src/QtSnmpOid.h ) {
+    HEADERS *= $${PWD}/../src/QtSnmpOid.h
+    SOURCES *= $${PWD}/../src/QtSnmpOid.cpp
+}
+unix : LIBS *= $$system(net-snmp-config --agent-libs)
@@ -0,0 +1,11 @@
+TEMPLATE = subdirs
+SUBDIRS *= suite \
+           latency \
+           lookup \
+           walk \
+           values \
+           types \
+           startup \
+           transport \
+           shards \
+           memory
@@ -0,0 +1,167 @@
+#include "QtSnmpBenchmark.h"
+#include <QCoreApplication>
+#include <QCommandLineOption>
+#include <QJsonDocument>
+#include <QProcess>
+#include <QFile>
+#include <QThread>
+#include <QSysInfo>
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+#include <stdio.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+    const char*const child_option = "child";
+
+    double to_us( const qint64 ns ) {
+        return static_cast< double >( ns ) / 1000.0;
+    }
+}
+
+void QtSnmpBenchmark::addCommonOptions( QCommandLineParser& parser ) {
+    parser.addHelpOption();
+    QCommandLineOption output( "output", "File of the JSON report, - for stdout.", "file" );
+    output.setDefaultValue( "-" );
+    parser.addOption( output );
+    QCommandLineOption transport( "transport", "Socket of the master: unix or tcp.", "transport" );
+    transport.setDefaultValue( "unix" );
+    parser.addOption( transport );
+    QCommandLineOption backend( "backend", "Protocol engine of the subagent: agentx or netsnmp.", "backend" );
+    backend.setDefaultValue( "agentx" );
+    parser.addOption( backend );
+    parser.addOption( QCommandLineOption( child_option, "Measures one configuration for the parent process." ) );
+}
+
+bool QtSnmpBenchmark::isChild( const QCommandLineParser& parser ) {
+    return parser.isSet( child_option );
+}
+
+QVector< int > QtSnmpBenchmark::parseList( const QString& text ) {
+    QVector< int > result;
+    for ( const auto& item : text.split( ',' ) ) {
+        bool ok;
+        const int value = item.trimmed().toInt( &ok );
+        if ( ok && ( value > 0 ) ) {
+            result << value;
+        } else {
+            qWarning() << "Ignoring the value " << item;
+        }
+    }
+    return result;
+}
+
+qint64 QtSnmpBenchmark::residentBytes() {
+    QFile file( "/proc/self/statm" );
+    if ( not file.open( QIODevice::ReadOnly ) ) {
+        return 0;
+    }
+    // size resident shared text lib data dt, in pages
+    const QList< QByteArray > fields = file.readAll().split( ' ' );
+    return fields.value( 1 ).toLongLong() * sysconf( _SC_PAGESIZE );
+}
+
+qint64 QtSnmpBenchmark::heapBytes() {
+#if defined( __GLIBC__ ) && ( ( __GLIBC__ > 2 ) || ( ( 2 == __GLIBC__ ) && ( __GLIBC_MINOR__ >= 33 ) ) )
+    const struct mallinfo2 info = mallinfo2();
+    return static_cast< qint64 >( info.uordblks + info.hblkhd );
+#elif defined( __GLIBC__ )
+    // the fields of mallinfo() wrap at 4 GiB
+    const struct mallinfo info = mallinfo();
+    return static_cast< qint64 >( static_cast< unsigned >( info.uordblks ) ) + static_cast< unsigned >( info.hblkhd );
+#else
+    return 0;
+#endif
+}
+
+QJsonObject QtSnmpBenchmark::latencyReport( QVector< qint64 >& latencies, const qint64 elapsed ) {
+    QJsonObject result;
+    result.insert( "count", latencies.size() );
+    if ( latencies.isEmpty() ) {
+        return result;
+    }
+    std::sort( latencies.begin(), latencies.end() );
+    const auto percentile = [ &latencies ]( const int percent ) {
+        const int index = static_cast< int >( ( static_cast< qint64 >( latencies.size() ) * percent ) / 100 );
+        return latencies.at( qMin( index, latencies.size() - 1 ) );
+    };
+    qint64 total = 0;
+    for ( const qint64 latency : latencies ) {
+        total += latency;
+    }
+    result.insert( "per_second", ( elapsed > 0 ) ? latencies.size() * 1e9 / elapsed : 0.0 );
+    result.insert( "mean_us", to_us( total / latencies.size() ) );
+    result.insert( "p50_us", to_us( percentile( 50 ) ) );
+    result.insert( "p99_us", to_us( percentile( 99 ) ) );
+    result.insert( "max_us", to_us( latencies.last() ) );
+    return result;
+}
+
+QJsonArray QtSnmpBenchmark::runChildren( const QList< QStringList >& configurations ) {
+    QJsonArray result;
+    for ( const auto& configuration : configurations ) {
+        const QStringList arguments = QStringList() << QString( "--%1" ).arg( child_option ) << configuration;
+        QProcess process;
+        process.setProcessChannelMode( QProcess::ForwardedErrorChannel );
+        process.start( QCoreApplication::applicationFilePath(), arguments );
+        QJsonObject child;
+        if ( not process.waitForFinished( -1 )
+             || ( QProcess::NormalExit != process.exitStatus() )
+             || ( 0 != process.exitCode() ) )
+        {
+            child.insert( "error", QString( "exit code %1" ).arg( process.exitCode() ) );
+        } else {
+            QJsonParseError error;
+            const QJsonDocument document = QJsonDocument::fromJson( process.readAllStandardOutput(), &error );
+            if ( document.isObject() ) {
+                child = document.object();
+            } else {
+                child.insert( "error", error.errorString() );
+            }
+        }
+        if ( child.contains( "error" ) ) {
+            child.insert( "arguments", configuration.join( ' ' ) );
+            qWarning() << "Configuration " << configuration << " has failed";
+        }
+        result.append( child );
+    }
+    return result;
+}
+
+void QtSnmpBenchmark::writeChildResult( const QJsonObject& result ) {
+    const QByteArray json = QJsonDocument( result ).toJson( QJsonDocument::Compact );
+    fwrite( json.constData(), 1, static_cast< size_t >( json.size() ), stdout );
+    fflush( stdout );
+}
+
+QJsonObject QtSnmpBenchmark::report( const QString& name, const QJsonObject& parameters, const QJsonValue& results ) {
+    QJsonObject environment;
+    environment.insert( "qt", QString( qVersion() ) );
+    environment.insert( "os", QSysInfo::prettyProductName() );
+    environment.insert( "cpu", QSysInfo::currentCpuArchitecture() );
+    environment.insert( "threads", QThread::idealThreadCount() );
+
+    QJsonObject result;
+    result.insert( "benchmark", name );
+    result.insert( "timestamp_ms", QDateTime::currentMSecsSinceEpoch() );
+    result.insert( "environment", environment );
+    result.insert( "parameters", parameters );
+    result.insert( "results", results );
+    return result;
+}
+
+bool QtSnmpBenchmark::writeReport( const QJsonObject& report, const QString& path ) {
+    QFile file( path );
+    const bool is_open = ( "-" == path ) ? file.open( stdout, QIODevice::WriteOnly )
+                                         : file.open( QIODevice::WriteOnly );
+    if ( not is_open ) {
+        qWarning() << "Could not write the report to " << path << ": " << file.errorString();
+        return false;
+    }
+    file.write( QJsonDocument( report ).toJson() );
+    return true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QCommandLineParser>
+#include "QtSnmpTestSupport.h"
+
+// Helpers shared by the benchmarks. A benchmark measures every configuration in a child
+// process of its own, so the memory of one scale does not inflate the next, and writes
+// one JSON report of the results. The subagents are served by the fake master of the tests.
+namespace QtSnmpBenchmark {
+    // --output, --transport, --backend and --child, which every benchmark understands
+    void addCommonOptions( QCommandLineParser& parser );
+    bool isChild( const QCommandLineParser& parser );
+    // "1000,10000,100000"
+    QVector< int > parseList( const QString& text );
+
+    // bytes resident in memory, 0 where /proc/self/statm is not available
+    qint64 residentBytes();
+    // bytes allocated on the heap and not freed, 0 where the C library does not report them
+    qint64 heapBytes();
+
+    // count, per_second, p50_us, p99_us and max_us of the latencies in ns, which get sorted;
+    // elapsed ns of the whole run
+    QJsonObject latencyReport( QVector< qint64 >& latencies, const qint64 elapsed );
+
+    // Runs the program again with --child and the arguments of every configuration, collects
+    // the JSON objects the children have written and adds the failed configurations as errors
+    QJsonArray runChildren( const QList< QStringList >& configurations );
+    // the result of a child for its parent
+    void writeChildResult( const QJsonObject& result );
+
+    // the benchmark, the parameters, the environment and the results
+    QJsonObject report( const QString& name, const QJsonObject& parameters, const QJsonValue& results );
+    // writes to the file or to stdout for "-"
+    bool writeReport( const QJsonObject& report, const QString& path );
+}
@@ -0,0 +1,5 @@
+include( $${PWD}/../benchmarks.pri )
+TARGET = qtsnmp_benchmark_latency
+SOURCES *= $${PWD}/main.cpp
+# only the API of the first versions is used, so the benchmark builds against them too
+SOURCES -= $${TEST_SUPPORT_PATH}/QtSnmpTestSubagent.cpp
@@ -0,0 +1,156 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDebug>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Latency of single GET and GETNEXT requests and wakeups of an idle subagent, served by the
+// net-snmp backend of instance(). Only the API of the first versions of the library is used,
+// so built with qmake LIBRARY_PATH=<checkout> it compares the 100 ms polling timer of those
+// versions with the socket notifiers of this one.
+
+namespace {
+    // the master of instance(), the first versions could not change it
+    const char*const default_master = "tcp:localhost:705";
+    const char*const application_name = "lemz-ads-b-subagent";
+    const char*const first_oid = ".1.3.6.1.4.1.99999.1.1.0";
+    const char*const second_oid = ".1.3.6.1.4.1.99999.1.2.0";
+    // ms
+    const int startup_timeout = 30000;
+    const int registration_quiet_period = 500;
+
+    struct Usage {
+        qint64 voluntary_switches = 0;
+        qint64 cpu_us = 0;
+    };
+
+    // all threads of the process
+    Usage current_usage() {
+        rusage usage;
+        getrusage( RUSAGE_SELF, &usage );
+        Usage result;
+        result.voluntary_switches = usage.ru_nvcsw;
+        result.cpu_us = ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * Q_INT64_C( 1000000 )
+                        + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+        return result;
+    }
+
+    // net-snmp reads the address of the master from the configuration of the application,
+    // which is the only way to move the master of the first versions
+    bool configure_master( const QTemporaryDir& directory, const QString& master ) {
+        QFile file( directory.filePath( QString( "%1.conf" ).arg( application_name ) ) );
+        if ( not file.open( QIODevice::WriteOnly ) ) {
+            qWarning() << "Could not write " << file.fileName();
+            return false;
+        }
+        file.write( QString( "agentXSocket %1\n" ).arg( master ).toUtf8() );
+        qputenv( "SNMPCONFPATH", directory.path().toUtf8() );
+        return true;
+    }
+
+    QJsonObject measure( QtSnmpFakeMaster& master, const QtSnmpFakeMaster::Request& request, const int count ) {
+        QJsonObject result;
+        QtSnmpFakeMaster::Response response;
+        if ( not master.execute( request, &response )
+             || ( QtSnmpFakeMaster::NoError != response.error )
+             || ( 1 != response.varbinds.size() )
+             || ( QtSnmpFakeMaster::TypeInteger != response.varbinds.first().type ) )
+        {
+            result.insert( "error", QString( "unexpected response, error %1" ).arg( response.error ) );
+            return result;
+        }
+
+        QVector< qint64 > latencies;
+        latencies.reserve( count );
+        QElapsedTimer total;
+        total.start();
+        for ( int i = 0; i < count; ++i ) {
+            QElapsedTimer timer;
+            timer.start();
+            if ( not master.execute( request ) ) {
+                result.insert( "error", QString( "request %1 has not been answered" ).arg( i ) );
+                return result;
+            }
+            latencies << timer.nsecsElapsed();
+        }
+        return QtSnmpBenchmark::latencyReport( latencies, total.nsecsElapsed() );
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Request latency and idle wakeups of the net-snmp subagent." );
+    parser.addHelpOption();
+    QCommandLineOption output( "output", "File of the JSON report, - for stdout.", "file" );
+    output.setDefaultValue( "-" );
+    parser.addOption( output );
+    QCommandLineOption master_option( "master", "Address of the fake master, tcp:localhost:705 needs privileges.", "address" );
+    master_option.setDefaultValue( default_master );
+    parser.addOption( master_option );
+    QCommandLineOption label( "label", "Name of the measured version in the report, e.g. timer or notifier.", "label" );
+    parser.addOption( label );
+    QCommandLineOption requests( "requests", "Requests measured of every kind.", "count" );
+    requests.setDefaultValue( "200" );
+    parser.addOption( requests );
+    QCommandLineOption idle( "idle", "ms the idle subagent is watched.", "ms" );
+    idle.setDefaultValue( "2000" );
+    parser.addOption( idle );
+    parser.process( application );
+
+    const int count = qMax( 1, parser.value( requests ).toInt() );
+    const int idle_time = qMax( 1, parser.value( idle ).toInt() );
+    QtSnmpFakeMaster master;
+    if ( not master.listen( parser.value( master_option ) ) ) {
+        return 1;
+    }
+    QTemporaryDir directory;
+    if ( ( default_master != parser.value( master_option ) )
+         && not ( directory.isValid() && configure_master( directory, master.address() ) ) )
+    {
+        return 1;
+    }
+
+    // instance() connects at once, the objects are registered with the open session
+    QtSnmpSubagent*const subagent = QtSnmpSubagent::instance();
+    if ( not master.waitForSessions( 1, startup_timeout ) ) {
+        qWarning() << "The subagent has not connected to " << master.address();
+        return 1;
+    }
+    subagent->registerSnmpObject( QtSnmpObjectDescription( first_oid, QtSnmpObjectDescription::TypeInterger ), 42 );
+    subagent->registerSnmpObject( QtSnmpObjectDescription( second_oid, QtSnmpObjectDescription::TypeInterger ), 43 );
+    if ( not master.waitForRegistrations( 1, startup_timeout ) ) {
+        qWarning() << "The subagent has not registered its objects";
+        return 1;
+    }
+    master.serve( registration_quiet_period );
+
+    QJsonObject results;
+    results.insert( "get", measure( master, QtSnmpFakeMaster::getRequest( { QtSnmpOid::fromString( first_oid ) } ), count ) );
+    results.insert( "getnext", measure( master, QtSnmpFakeMaster::getNextRequest( { QtSnmpOid::fromString( first_oid ) } ), count ) );
+
+    // the master does not send anything, every wakeup is the subagent's own
+    const Usage before = current_usage();
+    master.serve( idle_time );
+    const Usage after = current_usage();
+    QJsonObject idle_result;
+    idle_result.insert( "ms", idle_time );
+    idle_result.insert( "voluntary_switches", after.voluntary_switches - before.voluntary_switches );
+    idle_result.insert( "switches_per_second", ( after.voluntary_switches - before.voluntary_switches ) * 1000.0 / idle_time );
+    idle_result.insert( "cpu_ms", ( after.cpu_us - before.cpu_us ) / 1000.0 );
+    results.insert( "idle", idle_result );
+
+    QJsonObject parameters;
+    parameters.insert( "label", parser.value( label ) );
+    parameters.insert( "master", master.address() );
+    parameters.insert( "requests", count );
+    // the subagent of instance() keeps running until the process exits
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "latency", parameters, results ),
+                                         parser.value( output ) ) ? 0 : 1;
+}
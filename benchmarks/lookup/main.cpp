@@ -0,0 +1,202 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <atomic>
+#include <new>
+#include <random>
+#include <stdlib.h>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Cost of finding objects in the registry: value() calls and GET PDUs of one and of many
+// varbinds, in ns and in heap allocations of the whole process, one child per scale.
+
+namespace {
+    std::atomic< quint64 > allocations( 0 );
+}
+
+void* operator new( std::size_t size ) {
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    if ( void*const pointer = malloc( size ? size : 1 ) ) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete( void* pointer ) noexcept {
+    free( pointer );
+}
+
+void operator delete( void* pointer, std::size_t ) noexcept {
+    free( pointer );
+}
+
+namespace {
+    const int branch = 1;
+    const int request_variants = 1024;
+    const int large_pdu_varbinds = 64;
+    // ms
+    const int startup_timeout = 120000;
+
+    struct Cost {
+        qint64 ns = 0;
+        quint64 allocations = 0;
+    };
+
+    QtSnmpOid random_key( std::mt19937& random, const int objects ) {
+        return QtSnmpTestSupport::objectKey( branch, std::uniform_int_distribution< int >( 1, objects )( random ) );
+    }
+
+    QJsonObject cost_report( const Cost& cost, const int count, const int varbinds ) {
+        QJsonObject result;
+        result.insert( "count", count );
+        result.insert( "varbinds", varbinds );
+        result.insert( "ns_per_request", static_cast< double >( cost.ns ) / count );
+        result.insert( "ns_per_varbind", static_cast< double >( cost.ns ) / count / varbinds );
+        result.insert( "allocations_per_request", static_cast< double >( cost.allocations ) / count );
+        result.insert( "allocations_per_varbind", static_cast< double >( cost.allocations ) / count / varbinds );
+        return result;
+    }
+
+    // value() of random objects on the calling thread
+    Cost measure_value( QtSnmpSubagent*const subagent, const int objects, const int count ) {
+        std::mt19937 random( 1 );
+        QStringList oids;
+        for ( int i = 0; i < request_variants; ++i ) {
+            oids << random_key( random, objects ).toString();
+        }
+        qint64 sum = 0;
+        Cost result;
+        const quint64 before = allocations.load();
+        QElapsedTimer timer;
+        timer.start();
+        for ( int i = 0; i < count; ++i ) {
+            sum += subagent->value( oids.at( i % oids.size() ) ).toInt();
+        }
+        result.ns = timer.nsecsElapsed();
+        result.allocations = allocations.load() - before;
+        if ( 0 == sum ) {
+            qWarning() << "The objects have not been found";
+        }
+        return result;
+    }
+
+    // GET PDUs of random objects, the master skips decoding the responses
+    Cost measure_get( QtSnmpFakeMaster& master, const int objects, const int varbinds, const int count ) {
+        std::mt19937 random( 2 );
+        QVector< QtSnmpFakeMaster::Request > requests;
+        for ( int i = 0; i < request_variants; ++i ) {
+            QVector< QtSnmpOid > oids;
+            for ( int j = 0; j < varbinds; ++j ) {
+                oids << random_key( random, objects );
+            }
+            requests << QtSnmpFakeMaster::getRequest( oids );
+        }
+
+        Cost result;
+        QtSnmpFakeMaster::Response response;
+        if ( not master.execute( requests.first(), &response ) || ( QtSnmpFakeMaster::NoError != response.error ) ) {
+            result.ns = -1;
+            return result;
+        }
+        const quint64 before = allocations.load();
+        QElapsedTimer timer;
+        timer.start();
+        for ( int i = 0; i < count; ++i ) {
+            if ( not master.execute( requests.at( i % requests.size() ) ) ) {
+                result.ns = -1;
+                return result;
+            }
+        }
+        result.ns = timer.nsecsElapsed();
+        result.allocations = allocations.load() - before;
+        return result;
+    }
+
+    int run_child( const QCommandLineParser& parser, const int objects, const int count ) {
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( parser.value( "transport" ), "qtsnmp-lookup" ) ) ) {
+            return 1;
+        }
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( parser.value( "backend" ), "qtsnmp-lookup" );
+        QtSnmpSubagent::ObjectList list;
+        list.reserve( objects );
+        for ( int index = 1; index <= objects; ++index ) {
+            list << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( branch, index ),
+                                                        QtSnmpObjectDescription::TypeInterger ),
+                               QVariant( index ) );
+        }
+        if ( not subagent->registerSnmpObjects( list )
+             || ( QtSnmpTestSupport::startSubagent( subagent, master, startup_timeout ) < 0 ) )
+        {
+            return 1;
+        }
+
+        const Cost single = measure_get( master, objects, 1, count );
+        const Cost large = measure_get( master, objects, large_pdu_varbinds, count );
+        if ( ( single.ns < 0 ) || ( large.ns < 0 ) ) {
+            qWarning() << "The GET requests have failed";
+            return 1;
+        }
+        // the cost of the PDU itself cancels out
+        QJsonObject marginal;
+        marginal.insert( "ns_per_varbind",
+                         static_cast< double >( large.ns - single.ns ) / count / ( large_pdu_varbinds - 1 ) );
+        marginal.insert( "allocations_per_varbind",
+                         ( static_cast< double >( large.allocations ) - single.allocations ) / count / ( large_pdu_varbinds - 1 ) );
+
+        QJsonObject result;
+        result.insert( "objects", objects );
+        result.insert( "value", cost_report( measure_value( subagent, objects, count * large_pdu_varbinds ),
+                                             count * large_pdu_varbinds, 1 ) );
+        result.insert( "get_1", cost_report( single, count, 1 ) );
+        result.insert( QString( "get_%1" ).arg( large_pdu_varbinds ), cost_report( large, count, large_pdu_varbinds ) );
+        result.insert( "get_marginal", marginal );
+        QtSnmpBenchmark::writeChildResult( result );
+
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Time and heap allocations of registry lookups." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption scales( "scales", "Numbers of registered objects, comma separated.", "list" );
+    scales.setDefaultValue( "10000,100000" );
+    parser.addOption( scales );
+    QCommandLineOption requests( "requests", "GET PDUs measured of every size.", "count" );
+    requests.setDefaultValue( "2000" );
+    parser.addOption( requests );
+    QCommandLineOption objects( "objects", "Objects of the configuration measured by a child.", "count" );
+    parser.addOption( objects );
+    parser.process( application );
+
+    const int count = qMax( 1, parser.value( requests ).toInt() );
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        return run_child( parser, qMax( 1, parser.value( objects ).toInt() ), count );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray scale_list;
+    for ( const int scale : QtSnmpBenchmark::parseList( parser.value( scales ) ) ) {
+        configurations << ( QStringList() << "--objects" << QString::number( scale )
+                                          << "--requests" << QString::number( count )
+                                          << "--backend" << parser.value( "backend" )
+                                          << "--transport" << parser.value( "transport" ) );
+        scale_list.append( scale );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "scales", scale_list );
+    parameters.insert( "requests", count );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "lookup", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QDebug>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpTable.h"
+#include "QtSnmpBenchmark.h"
+
+// Bytes per object of the registry: objects without constraints, objects sharing one set of
+// limits, objects of limits of their own and the cells of a table, one child per scale and
+// layout so the heap of one does not hold the freed memory of another.
+
+namespace {
+    const int branch = 1;
+    const char*const table_entry = ".1.3.6.1.4.1.99999.2.1";
+    const int table_columns = 4;
+
+    QtSnmpSubagent::ObjectList create_objects( const QString& layout, const int objects ) {
+        QtSnmpSubagent::ObjectList result;
+        result.reserve( objects );
+        for ( int index = 1; index <= objects; ++index ) {
+            QtSnmpObjectDescription description( QtSnmpTestSupport::objectOid( branch, index ), QtSnmpObjectDescription::TypeInterger );
+            if ( "shared" == layout ) {
+                description.setLimits( 0, 1000 );
+            } else if ( "distinct" == layout ) {
+                description.setLimits( 0, index );
+            }
+            result << qMakePair( description, QVariant( 0 ) );
+        }
+        return result;
+    }
+
+    // the rows hold the objects, table_columns cells each
+    QSharedPointer< QtSnmpTable > create_table( QtSnmpSubagent*const subagent, const int objects ) {
+        QList< QtSnmpObjectDescription > columns;
+        for ( int column = 1; column <= table_columns; ++column ) {
+            columns << QtSnmpObjectDescription( QString( "%1.%2" ).arg( table_entry ).arg( column ),
+                                                QtSnmpObjectDescription::TypeInterger );
+        }
+        const QSharedPointer< QtSnmpTable > table = subagent->registerSnmpTable( columns );
+        if ( table.isNull() ) {
+            return table;
+        }
+        const QVariantList row = { 0, 0, 0, 0 };
+        for ( quint32 index = 1; index <= static_cast< quint32 >( objects / table_columns ); ++index ) {
+            table->setRow( index, row );
+        }
+        return table;
+    }
+
+    int run_child( const QString& layout, const int objects ) {
+        // a message per object would be allocated too
+        QLoggingCategory::setFilterRules( "default.debug=false" );
+        // the agent thread runs without a session, the master does not hold registry memory
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", "qtsnmp-memory" );
+        const QtSnmpSubagent::ObjectList list = ( "table" == layout ) ? QtSnmpSubagent::ObjectList()
+                                                                      : create_objects( layout, objects );
+        const qint64 heap_before = QtSnmpBenchmark::heapBytes();
+        const qint64 resident_before = QtSnmpBenchmark::residentBytes();
+        QSharedPointer< QtSnmpTable > table;
+        if ( "table" == layout ) {
+            table = create_table( subagent, objects );
+            if ( table.isNull() ) {
+                return 1;
+            }
+        } else if ( not subagent->registerSnmpObjects( list ) ) {
+            return 1;
+        }
+        const qint64 heap_bytes = QtSnmpBenchmark::heapBytes() - heap_before;
+        const qint64 resident_bytes = QtSnmpBenchmark::residentBytes() - resident_before;
+
+        QJsonObject result;
+        result.insert( "layout", layout );
+        result.insert( "objects", objects );
+        result.insert( "heap_bytes", static_cast< double >( heap_bytes ) );
+        result.insert( "heap_bytes_per_object", static_cast< double >( heap_bytes ) / objects );
+        result.insert( "resident_bytes", static_cast< double >( resident_bytes ) );
+        result.insert( "resident_bytes_per_object", static_cast< double >( resident_bytes ) / objects );
+        QtSnmpBenchmark::writeChildResult( result );
+
+        table.clear();
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Memory footprint of the registry in bytes per object." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption scales( "scales", "Numbers of registered objects, comma separated.", "list" );
+    scales.setDefaultValue( "10000,100000" );
+    parser.addOption( scales );
+    QCommandLineOption layouts( "layouts", "Registry layouts, comma separated: plain, shared, distinct, table.", "list" );
+    layouts.setDefaultValue( "plain,shared,distinct,table" );
+    parser.addOption( layouts );
+    QCommandLineOption objects( "objects", "Objects of the configuration measured by a child.", "count" );
+    parser.addOption( objects );
+    QCommandLineOption layout( "layout", "Registry layout of the configuration measured by a child.", "layout" );
+    parser.addOption( layout );
+    parser.process( application );
+
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        return run_child( parser.value( layout ), qMax( table_columns, parser.value( objects ).toInt() ) );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray scale_list;
+    QJsonArray layout_list;
+    const QStringList layout_names = parser.value( layouts ).split( ',' );
+    for ( const auto& name : layout_names ) {
+        layout_list.append( name );
+    }
+    for ( const int scale : QtSnmpBenchmark::parseList( parser.value( scales ) ) ) {
+        for ( const auto& name : layout_names ) {
+            configurations << ( QStringList() << "--objects" << QString::number( scale ) << "--layout" << name );
+        }
+        scale_list.append( scale );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "scales", scale_list );
+    parameters.insert( "layouts", layout_list );
+    parameters.insert( "table_columns", table_columns );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "memory", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
@@ -0,0 +1,3 @@
+include( $${PWD}/../benchmarks.pri )
+TARGET = qtsnmp_benchmark_memory
+SOURCES *= $${PWD}/main.cpp
@@ -0,0 +1,132 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Requests per second served by 1 to N subagent instances, each with its own thread and
+// session, while requests are kept outstanding on all sessions; one child per shard count.
+// The PDUs carry several varbinds so the subagents, not the master, do most of the work.
+
+namespace {
+    const int branch = 1;
+    // ms
+    const int pipeline_timeout = 300000;
+
+    struct Options {
+        int objects = 0;
+        int varbinds = 0;
+        int requests = 0;
+        int depth = 0;
+    };
+
+    int run_child( const QCommandLineParser& parser, const int shards, const Options& options ) {
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( parser.value( "transport" ), "qtsnmp-shards" ) ) ) {
+            return 1;
+        }
+        QtSnmpSubagent::ObjectList list;
+        for ( int index = 1; index <= options.objects; ++index ) {
+            list << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( branch, index ),
+                                                        QtSnmpObjectDescription::TypeGauge ),
+                               QVariant( static_cast< uint >( index ) ) );
+        }
+        // every shard serves the same objects on its own session
+        QVector< QtSnmpSubagent* > subagents;
+        QVector< int > sessions;
+        for ( int shard = 0; shard < shards; ++shard ) {
+            QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", QString( "qtsnmp-shard-%1" ).arg( shard ) );
+            subagents << subagent;
+            sessions << shard;
+            if ( not subagent->registerSnmpObjects( list )
+                 || ( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) < 0 ) )
+            {
+                return 1;
+            }
+        }
+
+        QVector< QtSnmpOid > oids;
+        for ( int i = 0; i < options.varbinds; ++i ) {
+            oids << QtSnmpTestSupport::objectKey( branch, 1 + ( i * 7919 ) % options.objects );
+        }
+        const QtSnmpFakeMaster::Request request = QtSnmpFakeMaster::getRequest( oids );
+        // warms up every session before the measured run
+        master.pipeline( request, sessions, shards * options.depth, options.depth, pipeline_timeout );
+        const qint64 elapsed = master.pipeline( request, sessions, options.requests, options.depth, pipeline_timeout );
+
+        QJsonObject result;
+        result.insert( "shards", shards );
+        if ( elapsed <= 0 ) {
+            result.insert( "error", QString( "the pipeline has timed out" ) );
+        } else {
+            result.insert( "ms", elapsed / 1e6 );
+            result.insert( "requests_per_second", options.requests * 1e9 / elapsed );
+            result.insert( "varbinds_per_second", static_cast< double >( options.requests ) * options.varbinds * 1e9 / elapsed );
+        }
+        QtSnmpBenchmark::writeChildResult( result );
+
+        for ( QtSnmpSubagent*const subagent : subagents ) {
+            QtSnmpTestSupport::destroySubagent( subagent );
+        }
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Requests per second against the number of subagent instances." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption shard_counts( "shard-counts", "Numbers of subagent instances, comma separated.", "list" );
+    shard_counts.setDefaultValue( "1,2,4,8" );
+    parser.addOption( shard_counts );
+    QCommandLineOption shards( "shards", "Subagent instances of the configuration measured by a child.", "count" );
+    parser.addOption( shards );
+    QCommandLineOption objects( "objects", "Objects served by every instance.", "count" );
+    objects.setDefaultValue( "10000" );
+    parser.addOption( objects );
+    QCommandLineOption varbinds( "varbinds", "Varbinds of a GET PDU.", "count" );
+    varbinds.setDefaultValue( "32" );
+    parser.addOption( varbinds );
+    QCommandLineOption requests( "requests", "GET PDUs measured over all instances.", "count" );
+    requests.setDefaultValue( "50000" );
+    parser.addOption( requests );
+    QCommandLineOption depth( "depth", "Requests outstanding on every session.", "count" );
+    depth.setDefaultValue( "8" );
+    parser.addOption( depth );
+    parser.process( application );
+
+    Options options;
+    options.objects = qMax( 1, parser.value( objects ).toInt() );
+    options.varbinds = qMax( 1, parser.value( varbinds ).toInt() );
+    options.requests = qMax( 1, parser.value( requests ).toInt() );
+    options.depth = qMax( 1, parser.value( depth ).toInt() );
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        // net-snmp has one agent per process, only the AgentX backend is sharded
+        return run_child( parser, qMax( 1, parser.value( shards ).toInt() ), options );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray shard_list;
+    for ( const int count : QtSnmpBenchmark::parseList( parser.value( shard_counts ) ) ) {
+        configurations << ( QStringList() << "--shards" << QString::number( count )
+                                          << "--objects" << QString::number( options.objects )
+                                          << "--varbinds" << QString::number( options.varbinds )
+                                          << "--requests" << QString::number( options.requests )
+                                          << "--depth" << QString::number( options.depth )
+                                          << "--transport" << parser.value( "transport" ) );
+        shard_list.append( count );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "shard_counts", shard_list );
+    parameters.insert( "objects", options.objects );
+    parameters.insert( "varbinds", options.varbinds );
+    parameters.insert( "requests", options.requests );
+    parameters.insert( "depth", options.depth );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "shards", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
@@ -0,0 +1,3 @@
+include( $${PWD}/../benchmarks.pri )
+TARGET = qtsnmp_benchmark_shards
+SOURCES *= $${PWD}/main.cpp
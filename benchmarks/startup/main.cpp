@@ -0,0 +1,158 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QDebug>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Startup of N objects registered one by one with registerSnmpObject() or at once with
+// registerSnmpObjects(), which registers the runs of adjacent objects as ranges, and removal
+// of all of them by unregisterSnmpSubtree(); one child per scale and mode.
+
+namespace {
+    const char*const branch_oid = ".1.3.6.1.4.1.99999.1";
+    const int branch = 1;
+    // every gap_period-th index is left out in the gaps layout, so runs are shorter
+    const int gap_period = 8;
+    // ms
+    const int startup_timeout = 300000;
+    const int unregister_timeout = 300000;
+
+    QtSnmpSubagent::ObjectList create_objects( const int objects, const bool has_gaps ) {
+        QtSnmpSubagent::ObjectList result;
+        result.reserve( objects );
+        for ( int index = 1; result.size() < objects; ++index ) {
+            if ( has_gaps && ( 0 == index % gap_period ) ) {
+                continue;
+            }
+            result << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( branch, index ),
+                                                          QtSnmpObjectDescription::TypeInterger ),
+                                 QVariant( index ) );
+        }
+        return result;
+    }
+
+    bool register_objects( QtSnmpSubagent*const subagent, const QString& mode, const QtSnmpSubagent::ObjectList& list ) {
+        if ( "single" == mode ) {
+            for ( const auto& object : list ) {
+                if ( not subagent->registerSnmpObject( object.first, object.second ) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if ( "bulk" != mode ) {
+            qWarning() << "Unknown registration mode " << mode;
+            return false;
+        }
+        return subagent->registerSnmpObjects( list );
+    }
+
+    int run_child( const QCommandLineParser& parser, const QString& mode, const int objects, const bool has_gaps ) {
+        // a message per object would be measured too
+        QLoggingCategory::setFilterRules( "default.debug=false" );
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( parser.value( "transport" ), "qtsnmp-startup" ) ) ) {
+            return 1;
+        }
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( parser.value( "backend" ), "qtsnmp-startup" );
+        const QtSnmpSubagent::ObjectList list = create_objects( objects, has_gaps );
+        const qint64 resident_before = QtSnmpBenchmark::residentBytes();
+        QElapsedTimer timer;
+        timer.start();
+        if ( not register_objects( subagent, mode, list ) ) {
+            qWarning() << "Could not register the objects";
+            return 1;
+        }
+        const qint64 registry_time = timer.nsecsElapsed();
+        const qint64 startup_time = QtSnmpTestSupport::startSubagent( subagent, master, startup_timeout );
+        if ( startup_time < 0 ) {
+            return 1;
+        }
+
+        QJsonObject result;
+        result.insert( "objects", objects );
+        result.insert( "mode", mode );
+        result.insert( "gaps", has_gaps );
+        result.insert( "registry_ms", registry_time / 1e6 );
+        result.insert( "startup_ms", startup_time );
+        result.insert( "registration_pdus", master.registrationPdus() );
+        result.insert( "master_registrations", master.registrations().size() );
+        result.insert( "resident_bytes", static_cast< double >( QtSnmpBenchmark::residentBytes() - resident_before ) );
+
+        // the Unregister PDUs are answered before the master holds no registration
+        const int pdus = master.registrationPdus();
+        timer.restart();
+        if ( not subagent->unregisterSnmpSubtree( branch_oid )
+             || not master.waitUntil( [ &master ]() { return master.registrations().isEmpty(); }, unregister_timeout ) )
+        {
+            result.insert( "error", QString( "the objects have not been unregistered" ) );
+        } else {
+            result.insert( "unregister_ms", timer.nsecsElapsed() / 1e6 );
+            result.insert( "unregister_pdus", master.registrationPdus() - pdus );
+        }
+        QtSnmpBenchmark::writeChildResult( result );
+
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Startup and removal of the registry by registration mode." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption scales( "scales", "Numbers of registered objects, comma separated.", "list" );
+    scales.setDefaultValue( "1000,10000,100000" );
+    parser.addOption( scales );
+    QCommandLineOption modes( "modes", "Registration modes, comma separated: single, bulk.", "list" );
+    modes.setDefaultValue( "single,bulk" );
+    parser.addOption( modes );
+    QCommandLineOption gaps( "gaps", "Also measure indexes with a gap every 8 objects." );
+    parser.addOption( gaps );
+    QCommandLineOption objects( "objects", "Objects of the configuration measured by a child.", "count" );
+    parser.addOption( objects );
+    QCommandLineOption mode( "mode", "Registration mode of the configuration measured by a child.", "mode" );
+    parser.addOption( mode );
+    QCommandLineOption with_gaps( "with-gaps", "The configuration measured by a child has gaps." );
+    parser.addOption( with_gaps );
+    parser.process( application );
+
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        return run_child( parser, parser.value( mode ), qMax( 1, parser.value( objects ).toInt() ), parser.isSet( with_gaps ) );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray scale_list;
+    QJsonArray mode_list;
+    const QStringList mode_names = parser.value( modes ).split( ',' );
+    for ( const auto& name : mode_names ) {
+        mode_list.append( name );
+    }
+    for ( const int scale : QtSnmpBenchmark::parseList( parser.value( scales ) ) ) {
+        for ( const auto& name : mode_names ) {
+            const QStringList configuration = QStringList() << "--objects" << QString::number( scale )
+                                                            << "--mode" << name
+                                                            << "--backend" << parser.value( "backend" )
+                                                            << "--transport" << parser.value( "transport" );
+            configurations << configuration;
+            if ( parser.isSet( gaps ) ) {
+                configurations << ( QStringList( configuration ) << "--with-gaps" );
+            }
+        }
+        scale_list.append( scale );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "scales", scale_list );
+    parameters.insert( "modes", mode_list );
+    parameters.insert( "gap_period", parser.isSet( gaps ) ? gap_period : 0 );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "startup", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
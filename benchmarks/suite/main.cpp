@@ -0,0 +1,268 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <random>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Registers N objects with a subagent served by the fake master and measures the registration,
+// GET, GETNEXT, GETBULK and SET at every scale, one child process per scale.
+
+namespace {
+    enum Branch {
+        BranchInteger = 1,
+        BranchGauge,
+        BranchString,
+        BranchCounter64,
+        LimitOfBranches = BranchCounter64
+    };
+
+    // distinct requests which are sent in turn, encoded before the measurement
+    const int request_variants = 1024;
+    const int bulk_repetitions = 10;
+    const int pipeline_depth = 16;
+    // ms
+    const int startup_timeout = 120000;
+
+    struct Options {
+        int objects = 0;
+        int requests = 0;
+    };
+
+    int objects_in_branch( const int objects, const int branch ) {
+        return ( objects + LimitOfBranches - branch ) / LimitOfBranches;
+    }
+
+    QtSnmpSubagent::ObjectList create_objects( const int objects ) {
+        QtSnmpSubagent::ObjectList result;
+        result.reserve( objects );
+        for ( int branch = BranchInteger; branch <= LimitOfBranches; ++branch ) {
+            for ( int index = 1; index <= objects_in_branch( objects, branch ); ++index ) {
+                const QString oid = QtSnmpTestSupport::objectOid( branch, index );
+                switch ( branch ) {
+                case BranchInteger:
+                    {
+                        QtSnmpObjectDescription description( oid, QtSnmpObjectDescription::TypeInterger );
+                        description.setLimits( 0, 1000000 );
+                        result << qMakePair( description, QVariant( index ) );
+                    }
+                    break;
+                case BranchGauge:
+                    result << qMakePair( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeGauge ),
+                                         QVariant( static_cast< uint >( index ) ) );
+                    break;
+                case BranchString:
+                    {
+                        QtSnmpObjectDescription description( oid, QtSnmpObjectDescription::TypeString );
+                        description.setReadOnly( true );
+                        result << qMakePair( description, QVariant( QString( "object %1" ).arg( index ) ) );
+                    }
+                    break;
+                case BranchCounter64:
+                    result << qMakePair( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeCounter64 ),
+                                         QVariant( Q_UINT64_C( 0x100000000 ) + static_cast< quint64 >( index ) ) );
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
+    // a random object of any branch
+    QtSnmpOid random_key( std::mt19937& random, const int objects ) {
+        const int branch = std::uniform_int_distribution< int >( BranchInteger, LimitOfBranches )( random );
+        const int index = std::uniform_int_distribution< int >( 1, objects_in_branch( objects, branch ) )( random );
+        return QtSnmpTestSupport::objectKey( branch, index );
+    }
+
+    QJsonObject measure( QtSnmpFakeMaster& master,
+                         const QVector< QtSnmpFakeMaster::Request >& requests,
+                         const int count )
+    {
+        // the first request warms up and checks the response
+        QtSnmpFakeMaster::Response response;
+        if ( not master.execute( requests.first(), &response ) || ( QtSnmpFakeMaster::NoError != response.error ) ) {
+            QJsonObject result;
+            result.insert( "error", QString( "response error %1" ).arg( response.error ) );
+            return result;
+        }
+
+        QVector< qint64 > latencies;
+        latencies.reserve( count );
+        QElapsedTimer total;
+        total.start();
+        for ( int i = 0; i < count; ++i ) {
+            QElapsedTimer timer;
+            timer.start();
+            if ( not master.execute( requests.at( i % requests.size() ) ) ) {
+                QJsonObject result;
+                result.insert( "error", QString( "request %1 has not been answered" ).arg( i ) );
+                return result;
+            }
+            latencies << timer.nsecsElapsed();
+        }
+        return QtSnmpBenchmark::latencyReport( latencies, total.nsecsElapsed() );
+    }
+
+    // TestSet, CommitSet and CleanupSet of one Integer object per SET
+    QJsonObject measure_set( QtSnmpFakeMaster& master, const int objects, const int count ) {
+        std::mt19937 random( 3 );
+        QVector< QtSnmpFakeMaster::Request > requests;
+        for ( int i = 0; i < request_variants; ++i ) {
+            const int index = std::uniform_int_distribution< int >( 1, objects_in_branch( objects, BranchInteger ) )( random );
+            const QtSnmpOid oid = QtSnmpTestSupport::objectKey( BranchInteger, index );
+            requests << QtSnmpFakeMaster::testSetRequest( { QtSnmpFakeMaster::integerVarbind( oid, i ) } );
+        }
+        const QtSnmpFakeMaster::Request commit = QtSnmpFakeMaster::emptyRequest( QtSnmpFakeMaster::PduCommitSet );
+
+        QJsonObject result;
+        QVector< qint64 > latencies;
+        latencies.reserve( count );
+        QElapsedTimer total;
+        total.start();
+        for ( int i = 0; i <= count; ++i ) {
+            // above the ids of the SETs made by the master itself
+            const quint32 transaction_id = 0x10000000u + static_cast< quint32 >( i );
+            QElapsedTimer timer;
+            timer.start();
+            QtSnmpFakeMaster::Response test;
+            QtSnmpFakeMaster::Response commit_response;
+            if ( not master.execute( requests.at( i % requests.size() ), &test, 0, transaction_id )
+                 || ( QtSnmpFakeMaster::NoError != test.error )
+                 || not master.execute( commit, &commit_response, 0, transaction_id )
+                 || ( QtSnmpFakeMaster::NoError != commit_response.error ) )
+            {
+                result.insert( "error", QString( "SET %1 has failed" ).arg( i ) );
+                return result;
+            }
+            master.cleanupSet( transaction_id );
+            // the first SET warms up
+            if ( 0 == i ) {
+                total.start();
+                continue;
+            }
+            latencies << timer.nsecsElapsed();
+        }
+        return QtSnmpBenchmark::latencyReport( latencies, total.nsecsElapsed() );
+    }
+
+    int run_child( const QCommandLineParser& parser, const Options& options ) {
+        const QString backend = parser.value( "backend" );
+        const QString transport = parser.value( "transport" );
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( transport, "qtsnmp-suite" ) ) ) {
+            return 1;
+        }
+
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( backend, "qtsnmp-suite" );
+        const QtSnmpSubagent::ObjectList objects = create_objects( options.objects );
+        const qint64 resident_before = QtSnmpBenchmark::residentBytes();
+        QElapsedTimer timer;
+        timer.start();
+        if ( not subagent->registerSnmpObjects( objects ) ) {
+            qWarning() << "Could not register the objects";
+            return 1;
+        }
+        const qint64 registry_time = timer.nsecsElapsed();
+        const qint64 resident_after = QtSnmpBenchmark::residentBytes();
+
+        const qint64 startup_time = QtSnmpTestSupport::startSubagent( subagent, master, startup_timeout );
+        if ( startup_time < 0 ) {
+            return 1;
+        }
+
+        QJsonObject registration;
+        registration.insert( "registry_ms", registry_time / 1e6 );
+        registration.insert( "startup_ms", startup_time );
+        registration.insert( "session_ms", subagent->sessionStatistics().registration_time );
+        registration.insert( "pdus", master.registrationPdus() );
+
+        QJsonObject memory;
+        memory.insert( "resident_bytes", resident_after );
+        memory.insert( "registry_bytes", resident_after - resident_before );
+        memory.insert( "bytes_per_object", static_cast< double >( resident_after - resident_before ) / options.objects );
+
+        std::mt19937 random( 1 );
+        QVector< QtSnmpFakeMaster::Request > gets;
+        QVector< QtSnmpFakeMaster::Request > get_nexts;
+        QVector< QtSnmpFakeMaster::Request > get_bulks;
+        for ( int i = 0; i < request_variants; ++i ) {
+            const QtSnmpOid key = random_key( random, options.objects );
+            gets << QtSnmpFakeMaster::getRequest( { key } );
+            get_nexts << QtSnmpFakeMaster::getNextRequest( { key } );
+            get_bulks << QtSnmpFakeMaster::getBulkRequest( { key }, 0, bulk_repetitions );
+        }
+
+        const QJsonObject get = measure( master, gets, options.requests );
+        const QJsonObject get_next = measure( master, get_nexts, options.requests );
+        QJsonObject get_bulk = measure( master, get_bulks, options.requests );
+        get_bulk.insert( "max_repetitions", bulk_repetitions );
+        const QJsonObject set = measure_set( master, options.objects, options.requests );
+
+        QJsonObject get_pipelined;
+        const qint64 pipeline_time = master.pipeline( gets.first(), { 0 }, options.requests, pipeline_depth );
+        get_pipelined.insert( "depth", pipeline_depth );
+        get_pipelined.insert( "count", options.requests );
+        get_pipelined.insert( "per_second", ( pipeline_time > 0 ) ? options.requests * 1e9 / pipeline_time : 0.0 );
+
+        QJsonObject result;
+        result.insert( "objects", options.objects );
+        result.insert( "backend", backend );
+        result.insert( "transport", transport );
+        result.insert( "registration", registration );
+        result.insert( "memory", memory );
+        result.insert( "get", get );
+        result.insert( "getnext", get_next );
+        result.insert( "getbulk", get_bulk );
+        result.insert( "set", set );
+        result.insert( "get_pipelined", get_pipelined );
+        QtSnmpBenchmark::writeChildResult( result );
+
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Throughput, latency and memory of a subagent served by a fake AgentX master." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption scales( "scales", "Numbers of registered objects, comma separated.", "list" );
+    scales.setDefaultValue( "1000,10000,100000" );
+    parser.addOption( scales );
+    QCommandLineOption requests( "requests", "Requests measured of every kind.", "count" );
+    requests.setDefaultValue( "10000" );
+    parser.addOption( requests );
+    QCommandLineOption objects( "objects", "Objects of the configuration measured by a child.", "count" );
+    parser.addOption( objects );
+    parser.process( application );
+
+    Options options;
+    options.requests = qMax( 1, parser.value( requests ).toInt() );
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        options.objects = qMax( 1, parser.value( objects ).toInt() );
+        return run_child( parser, options );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray scale_list;
+    for ( const int scale : QtSnmpBenchmark::parseList( parser.value( scales ) ) ) {
+        configurations << ( QStringList() << "--objects" << QString::number( scale )
+                                          << "--requests" << QString::number( options.requests )
+                                          << "--backend" << parser.value( "backend" )
+                                          << "--transport" << parser.value( "transport" ) );
+        scale_list.append( scale );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "scales", scale_list );
+    parameters.insert( "requests", options.requests );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "suite", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
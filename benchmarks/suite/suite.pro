@@ -0,0 +1,3 @@
+include( $${PWD}/../benchmarks.pri )
+TARGET = qtsnmp_benchmark_suite
+SOURCES *= $${PWD}/main.cpp
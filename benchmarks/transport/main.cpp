@@ -0,0 +1,127 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Latency of a GET of one varbind over loopback TCP and over a Unix socket, one request at a
+// time and pipelined; one child per transport, so the sockets of one do not load the other.
+
+namespace {
+    const int branch = 1;
+    const int objects = 100;
+    // ms
+    const int pipeline_timeout = 300000;
+
+    QJsonObject measure_latency( QtSnmpFakeMaster& master, const int count ) {
+        QJsonObject result;
+        QVector< QtSnmpFakeMaster::Request > requests;
+        for ( int index = 1; index <= objects; ++index ) {
+            requests << QtSnmpFakeMaster::getRequest( { QtSnmpTestSupport::objectKey( branch, index ) } );
+        }
+
+        QVector< qint64 > latencies;
+        latencies.reserve( count );
+        QElapsedTimer total;
+        total.start();
+        for ( int i = 0; i < count; ++i ) {
+            QElapsedTimer timer;
+            timer.start();
+            if ( not master.execute( requests.at( i % requests.size() ) ) ) {
+                result.insert( "error", QString( "request %1 has not been answered" ).arg( i ) );
+                return result;
+            }
+            latencies << timer.nsecsElapsed();
+        }
+        return QtSnmpBenchmark::latencyReport( latencies, total.nsecsElapsed() );
+    }
+
+    QJsonObject measure_pipeline( QtSnmpFakeMaster& master, const int count, const int depth ) {
+        QJsonObject result;
+        result.insert( "depth", depth );
+        const qint64 elapsed = master.pipeline( QtSnmpFakeMaster::getRequest( { QtSnmpTestSupport::objectKey( branch, 1 ) } ),
+                                                { 0 }, count, depth, pipeline_timeout );
+        if ( elapsed < 0 ) {
+            result.insert( "error", QString( "the pipeline has timed out" ) );
+            return result;
+        }
+        result.insert( "count", count );
+        result.insert( "per_second", count * 1e9 / elapsed );
+        return result;
+    }
+
+    int run_child( const QCommandLineParser& parser, const int count, const int depth ) {
+        const QString transport = parser.value( "transport" );
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( transport, "qtsnmp-transport" ) ) ) {
+            return 1;
+        }
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( parser.value( "backend" ), "qtsnmp-transport" );
+        QtSnmpSubagent::ObjectList list;
+        for ( int index = 1; index <= objects; ++index ) {
+            list << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( branch, index ),
+                                                        QtSnmpObjectDescription::TypeInterger ),
+                               QVariant( index ) );
+        }
+        if ( not subagent->registerSnmpObjects( list )
+             || ( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) < 0 ) )
+        {
+            return 1;
+        }
+
+        QJsonObject result;
+        result.insert( "transport", transport );
+        result.insert( "backend", parser.value( "backend" ) );
+        result.insert( "latency", measure_latency( master, count ) );
+        result.insert( "pipelined", measure_pipeline( master, count, depth ) );
+        QtSnmpBenchmark::writeChildResult( result );
+
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "GET latency over loopback TCP and a Unix socket." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption transports( "transports", "Transports compared, comma separated: unix, tcp.", "list" );
+    transports.setDefaultValue( "unix,tcp" );
+    parser.addOption( transports );
+    QCommandLineOption requests( "requests", "GET PDUs measured on every transport.", "count" );
+    requests.setDefaultValue( "20000" );
+    parser.addOption( requests );
+    QCommandLineOption depth( "depth", "Requests outstanding in the pipelined run.", "count" );
+    depth.setDefaultValue( "8" );
+    parser.addOption( depth );
+    parser.process( application );
+
+    const int request_count = qMax( 1, parser.value( requests ).toInt() );
+    const int depth_count = qMax( 1, parser.value( depth ).toInt() );
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        return run_child( parser, request_count, depth_count );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray transport_list;
+    for ( const auto& transport : parser.value( transports ).split( ',' ) ) {
+        configurations << ( QStringList() << "--transport" << transport.trimmed()
+                                          << "--backend" << parser.value( "backend" )
+                                          << "--requests" << QString::number( request_count )
+                                          << "--depth" << QString::number( depth_count ) );
+        transport_list.append( transport.trimmed() );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "transports", transport_list );
+    parameters.insert( "objects", objects );
+    parameters.insert( "requests", request_count );
+    parameters.insert( "depth", depth_count );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "transport", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <random>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Cost of GET by the type of the objects: PDUs of several varbinds of one type, so the
+// encoding of the values dominates the cost of the PDU.
+
+namespace {
+    struct TypeInfo {
+        const char* name;
+        QtSnmpObjectDescription::Type type;
+    };
+
+    const TypeInfo types[] = {
+        { "integer", QtSnmpObjectDescription::TypeInterger },
+        { "gauge", QtSnmpObjectDescription::TypeGauge },
+        { "counter", QtSnmpObjectDescription::TypeCounter },
+        { "timeticks", QtSnmpObjectDescription::TypeTimeTicks },
+        { "ipaddress", QtSnmpObjectDescription::TypeIpAddress },
+        { "string", QtSnmpObjectDescription::TypeString },
+        { "real", QtSnmpObjectDescription::TypeReal },
+        { "counter64", QtSnmpObjectDescription::TypeCounter64 },
+        { "float", QtSnmpObjectDescription::TypeFloat },
+        { "double", QtSnmpObjectDescription::TypeDouble }
+    };
+    // the objects of a type are below their own branch
+    const int first_branch = 10;
+    const int request_variants = 1024;
+    // ms
+    const int startup_timeout = 120000;
+
+    QVariant sample_value( const QtSnmpObjectDescription::Type type, const int index ) {
+        switch ( type ) {
+        case QtSnmpObjectDescription::TypeInterger:
+            return index;
+        case QtSnmpObjectDescription::TypeIpAddress:
+            return QString( "10.0.%1.%2" ).arg( index / 256 % 256 ).arg( index % 256 );
+        case QtSnmpObjectDescription::TypeString:
+            return QString( "object %1 of the benchmark" ).arg( index );
+        case QtSnmpObjectDescription::TypeReal:
+        case QtSnmpObjectDescription::TypeFloat:
+        case QtSnmpObjectDescription::TypeDouble:
+            return index / 7.0;
+        case QtSnmpObjectDescription::TypeCounter64:
+            return Q_UINT64_C( 0x100000000 ) * static_cast< quint64 >( index );
+        default:
+            break;
+        }
+        return static_cast< uint >( index );
+    }
+
+    QJsonObject measure( QtSnmpFakeMaster& master, const int branch, const int objects, const int varbinds, const int count ) {
+        std::mt19937 random( static_cast< unsigned >( branch ) );
+        QVector< QtSnmpFakeMaster::Request > requests;
+        for ( int i = 0; i < request_variants; ++i ) {
+            QVector< QtSnmpOid > oids;
+            for ( int j = 0; j < varbinds; ++j ) {
+                oids << QtSnmpTestSupport::objectKey( branch, std::uniform_int_distribution< int >( 1, objects )( random ) );
+            }
+            requests << QtSnmpFakeMaster::getRequest( oids );
+        }
+
+        QJsonObject result;
+        QtSnmpFakeMaster::Response response;
+        if ( not master.execute( requests.first(), &response ) || ( QtSnmpFakeMaster::NoError != response.error ) ) {
+            result.insert( "error", QString( "response error %1" ).arg( response.error ) );
+            return result;
+        }
+        result.insert( "asn_type", response.varbinds.value( 0 ).type );
+
+        QVector< qint64 > latencies;
+        latencies.reserve( count );
+        QElapsedTimer total;
+        total.start();
+        for ( int i = 0; i < count; ++i ) {
+            QElapsedTimer timer;
+            timer.start();
+            if ( not master.execute( requests.at( i % requests.size() ) ) ) {
+                result.insert( "error", QString( "request %1 has not been answered" ).arg( i ) );
+                return result;
+            }
+            latencies << timer.nsecsElapsed();
+        }
+        const qint64 elapsed = total.nsecsElapsed();
+        result.insert( "latency", QtSnmpBenchmark::latencyReport( latencies, elapsed ) );
+        result.insert( "ns_per_varbind", static_cast< double >( elapsed ) / count / varbinds );
+        return result;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "GET cost by the type of the objects." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption objects( "objects", "Objects of every type.", "count" );
+    objects.setDefaultValue( "1000" );
+    parser.addOption( objects );
+    QCommandLineOption varbinds( "varbinds", "Varbinds of a GET PDU.", "count" );
+    varbinds.setDefaultValue( "16" );
+    parser.addOption( varbinds );
+    QCommandLineOption requests( "requests", "GET PDUs measured of every type.", "count" );
+    requests.setDefaultValue( "5000" );
+    parser.addOption( requests );
+    parser.process( application );
+
+    const int object_count = qMax( 1, parser.value( objects ).toInt() );
+    const int varbind_count = qMax( 1, parser.value( varbinds ).toInt() );
+    const int request_count = qMax( 1, parser.value( requests ).toInt() );
+
+    QtSnmpFakeMaster master;
+    if ( not master.listen( QtSnmpTestSupport::masterAddress( parser.value( "transport" ), "qtsnmp-types" ) ) ) {
+        return 1;
+    }
+    QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( parser.value( "backend" ), "qtsnmp-types" );
+    QtSnmpSubagent::ObjectList list;
+    for ( int i = 0; i < static_cast< int >( sizeof( types ) / sizeof( types[ 0 ] ) ); ++i ) {
+        for ( int index = 1; index <= object_count; ++index ) {
+            QtSnmpObjectDescription description( QtSnmpTestSupport::objectOid( first_branch + i, index ), types[ i ].type );
+            description.setReadOnly( true );
+            list << qMakePair( description, sample_value( types[ i ].type, index ) );
+        }
+    }
+    if ( not subagent->registerSnmpObjects( list )
+         || ( QtSnmpTestSupport::startSubagent( subagent, master, startup_timeout ) < 0 ) )
+    {
+        return 1;
+    }
+
+    QJsonObject results;
+    for ( int i = 0; i < static_cast< int >( sizeof( types ) / sizeof( types[ 0 ] ) ); ++i ) {
+        results.insert( types[ i ].name, measure( master, first_branch + i, object_count, varbind_count, request_count ) );
+    }
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QJsonObject parameters;
+    parameters.insert( "objects_per_type", object_count );
+    parameters.insert( "varbinds", varbind_count );
+    parameters.insert( "requests", request_count );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "types", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QMetaObject>
+#include <QDebug>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
+#include <stdlib.h>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpBenchmark.h"
+
+// Throughput of producers publishing values from threads of their own: setValue(), typed
+// handles, setValues() batches and the queued setValue slot, which posts a metacall event
+// per update to the agent thread.
+
+namespace {
+    std::atomic< quint64 > allocations( 0 );
+}
+
+void* operator new( std::size_t size ) {
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    if ( void*const pointer = malloc( size ? size : 1 ) ) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete( void* pointer ) noexcept {
+    free( pointer );
+}
+
+void operator delete( void* pointer, std::size_t ) noexcept {
+    free( pointer );
+}
+
+namespace {
+    const int branch = 2;
+    const int batch_size = 64;
+
+    struct Options {
+        int objects = 0;
+        int updates = 0;
+    };
+
+    typedef std::function< void( int producer, int producers ) > Producer;
+
+    // the producers interleave over the objects
+    Producer create_producer( QtSnmpSubagent*const subagent,
+                              const QString& mode,
+                              const QStringList& oids,
+                              const Options& options )
+    {
+        if ( "direct" == mode ) {
+            return [ = ]( const int producer, const int producers ) {
+                for ( int i = 0; i < options.updates; ++i ) {
+                    subagent->setValue( oids.at( ( i * producers + producer ) % oids.size() ), static_cast< uint >( i ) );
+                }
+            };
+        }
+        if ( "queued" == mode ) {
+            return [ = ]( const int producer, const int producers ) {
+                for ( int i = 0; i < options.updates; ++i ) {
+                    QMetaObject::invokeMethod( subagent, "setValue", Qt::QueuedConnection,
+                                               Q_ARG( QString, oids.at( ( i * producers + producer ) % oids.size() ) ),
+                                               Q_ARG( QVariant, QVariant( static_cast< uint >( i ) ) ) );
+                }
+            };
+        }
+        if ( "handle" == mode ) {
+            QVector< QtSnmpHandle< quint32 > > handles;
+            for ( const auto& oid : oids ) {
+                handles << subagent->handle< quint32 >( oid );
+            }
+            return [ = ]( const int producer, const int producers ) mutable {
+                for ( int i = 0; i < options.updates; ++i ) {
+                    handles[ ( i * producers + producer ) % handles.size() ].set( static_cast< quint32 >( i ) );
+                }
+            };
+        }
+        if ( "batch" == mode ) {
+            return [ = ]( const int producer, const int producers ) {
+                QtSnmpSubagent::ValueList values;
+                for ( int i = 0; i < options.updates; ++i ) {
+                    values << qMakePair( oids.at( ( i * producers + producer ) % oids.size() ),
+                                         QVariant( static_cast< uint >( i ) ) );
+                    if ( ( batch_size == values.size() ) || ( options.updates - 1 == i ) ) {
+                        subagent->setValues( values );
+                        values.clear();
+                    }
+                }
+            };
+        }
+        return Producer();
+    }
+
+    QJsonObject measure( QtSnmpSubagent*const subagent,
+                         const QString& mode,
+                         const QStringList& oids,
+                         const int producers,
+                         const Options& options )
+    {
+        QJsonObject result;
+        result.insert( "mode", mode );
+        result.insert( "producers", producers );
+        const Producer producer = create_producer( subagent, mode, oids, options );
+        if ( not producer ) {
+            result.insert( "error", QString( "unknown mode %1" ).arg( mode ) );
+            return result;
+        }
+
+        std::vector< std::unique_ptr< QtSnmpTestSupport::Worker > > workers;
+        for ( int i = 0; i < producers; ++i ) {
+            workers.emplace_back( new QtSnmpTestSupport::Worker( [ producer, i, producers ]() { producer( i, producers ); } ) );
+        }
+        const quint64 allocations_before = allocations.load();
+        QElapsedTimer timer;
+        timer.start();
+        for ( const auto& worker : workers ) {
+            worker->start();
+        }
+        for ( const auto& worker : workers ) {
+            worker->wait();
+        }
+        // the events posted before are delivered first, so every update has been applied
+        QMetaObject::invokeMethod( subagent, "setValue", Qt::BlockingQueuedConnection,
+                                   Q_ARG( QString, oids.first() ), Q_ARG( QVariant, QVariant( 0u ) ) );
+        const qint64 elapsed = timer.nsecsElapsed();
+        const quint64 updates = static_cast< quint64 >( producers ) * options.updates;
+
+        result.insert( "updates", static_cast< double >( updates ) );
+        result.insert( "ms", elapsed / 1e6 );
+        result.insert( "updates_per_second", updates * 1e9 / elapsed );
+        result.insert( "allocations_per_update", static_cast< double >( allocations.load() - allocations_before ) / updates );
+        return result;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Throughput of values published by several producer threads." );
+    parser.addHelpOption();
+    QCommandLineOption output( "output", "File of the JSON report, - for stdout.", "file" );
+    output.setDefaultValue( "-" );
+    parser.addOption( output );
+    QCommandLineOption producers( "producers", "Numbers of producer threads, comma separated.", "list" );
+    producers.setDefaultValue( "1,2,4,8" );
+    parser.addOption( producers );
+    QCommandLineOption modes( "modes", "Publishing paths, comma separated: direct, handle, batch, queued.", "list" );
+    modes.setDefaultValue( "direct,handle,batch,queued" );
+    parser.addOption( modes );
+    QCommandLineOption objects( "objects", "Gauges the producers update.", "count" );
+    objects.setDefaultValue( "1000" );
+    parser.addOption( objects );
+    QCommandLineOption updates( "updates", "Updates made by every producer.", "count" );
+    updates.setDefaultValue( "200000" );
+    parser.addOption( updates );
+    parser.process( application );
+
+    Options options;
+    options.objects = qMax( 1, parser.value( objects ).toInt() );
+    options.updates = qMax( 1, parser.value( updates ).toInt() );
+
+    // the agent thread runs without a session, publishing does not depend on the master
+    QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", "qtsnmp-values" );
+    QtSnmpSubagent::ObjectList list;
+    QStringList oids;
+    for ( int index = 1; index <= options.objects; ++index ) {
+        oids << QtSnmpTestSupport::objectOid( branch, index );
+        list << qMakePair( QtSnmpObjectDescription( oids.last(), QtSnmpObjectDescription::TypeGauge ), QVariant( 0u ) );
+    }
+    if ( not subagent->registerSnmpObjects( list ) ) {
+        return 1;
+    }
+
+    QJsonArray results;
+    QJsonArray producer_list;
+    const QVector< int > producer_counts = QtSnmpBenchmark::parseList( parser.value( producers ) );
+    for ( const int count : producer_counts ) {
+        producer_list.append( count );
+    }
+    for ( const auto& mode : parser.value( modes ).split( ',' ) ) {
+        for ( const int count : producer_counts ) {
+            results.append( measure( subagent, mode.trimmed(), oids, count, options ) );
+        }
+    }
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QJsonObject parameters;
+    parameters.insert( "objects", options.objects );
+    parameters.insert( "updates_per_producer", options.updates );
+    parameters.insert( "producers", producer_list );
+    parameters.insert( "batch_size", batch_size );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "values", parameters, results ),
+                                         parser.value( output ) ) ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QLoggingCategory>
+#include <QElapsedTimer>
+#include <QDebug>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpBenchmark.h"
+
+// Startup and full walks of N objects registered one by one, as ranges or below one subtree,
+// one child per scale and registration mode.
+
+namespace {
+    const char*const enterprise_oid = ".1.3.6.1.4.1.99999";
+    const int branch = 1;
+    // ms
+    const int startup_timeout = 300000;
+    const int walk_timeout = 300000;
+
+    QtSnmpSubagent::ObjectList create_objects( const int objects ) {
+        QtSnmpSubagent::ObjectList result;
+        result.reserve( objects );
+        for ( int index = 1; index <= objects; ++index ) {
+            result << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( branch, index ),
+                                                          QtSnmpObjectDescription::TypeInterger ),
+                                 QVariant( index ) );
+        }
+        return result;
+    }
+
+    bool register_objects( QtSnmpSubagent*const subagent, const QString& mode, const int objects ) {
+        const QtSnmpSubagent::ObjectList list = create_objects( objects );
+        if ( "objects" == mode ) {
+            for ( const auto& object : list ) {
+                if ( not subagent->registerSnmpObject( object.first, object.second ) ) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if ( ( "subtree" == mode ) && not subagent->registerSnmpSubtree( enterprise_oid ) ) {
+            return false;
+        }
+        if ( ( "subtree" != mode ) && ( "ranges" != mode ) ) {
+            qWarning() << "Unknown registration mode " << mode;
+            return false;
+        }
+        return subagent->registerSnmpObjects( list );
+    }
+
+    // GETNEXT, or GETBULK for positive repetitions, from the enterprise OID to the end of the view
+    QJsonObject walk( QtSnmpFakeMaster& master, const int objects, const int repetitions ) {
+        QJsonObject result;
+        QtSnmpOid current = QtSnmpOid::fromString( enterprise_oid );
+        int varbinds = 0;
+        int pdus = 0;
+        bool is_end = false;
+        QElapsedTimer timer;
+        timer.start();
+        while ( not is_end ) {
+            const QtSnmpFakeMaster::Response response = ( repetitions > 0 )
+                                                        ? master.getBulk( { current }, 0, quint16( repetitions ) )
+                                                        : master.getNext( { current } );
+            ++pdus;
+            if ( not response.is_valid || ( QtSnmpFakeMaster::NoError != response.error )
+                 || response.varbinds.isEmpty() || ( timer.elapsed() > walk_timeout ) )
+            {
+                result.insert( "error", QString( "PDU %1 of the walk has failed" ).arg( pdus ) );
+                return result;
+            }
+            for ( const auto& varbind : response.varbinds ) {
+                if ( QtSnmpFakeMaster::TypeEndOfMibView == varbind.type ) {
+                    is_end = true;
+                    break;
+                }
+                current = varbind.oid;
+                ++varbinds;
+            }
+        }
+        const qint64 elapsed = timer.nsecsElapsed();
+        if ( objects != varbinds ) {
+            result.insert( "error", QString( "%1 of %2 objects have been walked" ).arg( varbinds ).arg( objects ) );
+            return result;
+        }
+        result.insert( "pdus", pdus );
+        result.insert( "varbinds", varbinds );
+        result.insert( "ms", elapsed / 1e6 );
+        result.insert( "varbinds_per_second", varbinds * 1e9 / elapsed );
+        if ( repetitions > 0 ) {
+            result.insert( "max_repetitions", repetitions );
+        }
+        return result;
+    }
+
+    int run_child( const QCommandLineParser& parser, const QString& mode, const int objects, const int repetitions ) {
+        // a message per object would be measured too
+        QLoggingCategory::setFilterRules( "default.debug=false" );
+        QtSnmpFakeMaster master;
+        if ( not master.listen( QtSnmpTestSupport::masterAddress( parser.value( "transport" ), "qtsnmp-walk" ) ) ) {
+            return 1;
+        }
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( parser.value( "backend" ), "qtsnmp-walk" );
+        QElapsedTimer timer;
+        timer.start();
+        if ( not register_objects( subagent, mode, objects ) ) {
+            qWarning() << "Could not register the objects";
+            return 1;
+        }
+        const qint64 registry_time = timer.nsecsElapsed();
+        const qint64 startup_time = QtSnmpTestSupport::startSubagent( subagent, master, startup_timeout );
+        if ( startup_time < 0 ) {
+            return 1;
+        }
+
+        QJsonObject startup;
+        startup.insert( "registry_ms", registry_time / 1e6 );
+        startup.insert( "startup_ms", startup_time );
+        startup.insert( "pdus", master.registrationPdus() );
+        startup.insert( "master_registrations", master.registrations().size() );
+
+        QJsonObject result;
+        result.insert( "objects", objects );
+        result.insert( "mode", mode );
+        result.insert( "startup", startup );
+        result.insert( "getnext_walk", walk( master, objects, 0 ) );
+        result.insert( "getbulk_walk", walk( master, objects, repetitions ) );
+        QtSnmpBenchmark::writeChildResult( result );
+
+        QtSnmpTestSupport::destroySubagent( subagent );
+        return 0;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    QCoreApplication application( argc, argv );
+    QCommandLineParser parser;
+    parser.setApplicationDescription( "Startup and full walks by registration mode." );
+    QtSnmpBenchmark::addCommonOptions( parser );
+    QCommandLineOption scales( "scales", "Numbers of registered objects, comma separated.", "list" );
+    scales.setDefaultValue( "50000" );
+    parser.addOption( scales );
+    QCommandLineOption modes( "modes", "Registration modes, comma separated: objects, ranges, subtree.", "list" );
+    modes.setDefaultValue( "objects,ranges,subtree" );
+    parser.addOption( modes );
+    QCommandLineOption repetitions( "repetitions", "max-repetitions of the GETBULK walk.", "count" );
+    repetitions.setDefaultValue( "20" );
+    parser.addOption( repetitions );
+    QCommandLineOption objects( "objects", "Objects of the configuration measured by a child.", "count" );
+    parser.addOption( objects );
+    QCommandLineOption mode( "mode", "Registration mode of the configuration measured by a child.", "mode" );
+    parser.addOption( mode );
+    parser.process( application );
+
+    const int repetition_count = qBound( 1, parser.value( repetitions ).toInt(), 0xFFFF );
+    if ( QtSnmpBenchmark::isChild( parser ) ) {
+        return run_child( parser, parser.value( mode ), qMax( 1, parser.value( objects ).toInt() ), repetition_count );
+    }
+
+    QList< QStringList > configurations;
+    QJsonArray scale_list;
+    QJsonArray mode_list;
+    const QStringList mode_names = parser.value( modes ).split( ',' );
+    for ( const auto& name : mode_names ) {
+        mode_list.append( name );
+    }
+    for ( const int scale : QtSnmpBenchmark::parseList( parser.value( scales ) ) ) {
+        for ( const auto& name : mode_names ) {
+            configurations << ( QStringList() << "--objects" << QString::number( scale )
+                                              << "--mode" << name
+                                              << "--repetitions" << QString::number( repetition_count )
+                                              << "--backend" << parser.value( "backend" )
+                                              << "--transport" << parser.value( "transport" ) );
+        }
+        scale_list.append( scale );
+    }
+
+    QJsonObject parameters;
+    parameters.insert( "scales", scale_list );
+    parameters.insert( "modes", mode_list );
+    parameters.insert( "repetitions", repetition_count );
+    parameters.insert( "backend", parser.value( "backend" ) );
+    parameters.insert( "transport", parser.value( "transport" ) );
+    const QJsonArray results = QtSnmpBenchmark::runChildren( configurations );
+    return QtSnmpBenchmark::writeReport( QtSnmpBenchmark::report( "walk", parameters, results ),
+                                         parser.value( "output" ) ) ? 0 : 1;
+}
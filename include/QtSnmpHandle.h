@@ -0,0 +1 @@
+#include "../src/QtSnmpHandle.h"
@@ -0,0 +1 @@
+#include "../src/QtSnmpOid.h"
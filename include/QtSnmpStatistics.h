@@ -0,0 +1 @@
+#include "../src/QtSnmpStatistics.h"
@@ -0,0 +1 @@
+#include "../src/QtSnmpTable.h"
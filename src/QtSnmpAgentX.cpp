@@ -0,0 +1,1334 @@
+#include "QtSnmpAgentX.h"
+#include <QLocalSocket>
+#include <QTcpSocket>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QStringList>
+#include <QtEndian>
+#include <QTimer>
+#include <QDebug>
+#include <string.h>
+
+#ifndef QT_SNMP_SUBAGENT_DEBUG
+    #undef qDebug
+    #define qDebug QNoDebug
+#endif
+
+namespace {
+    enum PduType : quint8 {
+        PduOpen = 1,
+        PduClose = 2,
+        PduRegister = 3,
+        PduUnregister = 4,
+        PduGet = 5,
+        PduGetNext = 6,
+        PduGetBulk = 7,
+        PduTestSet = 8,
+        PduCommitSet = 9,
+        PduUndoSet = 10,
+        PduCleanupSet = 11,
+        PduNotify = 12,
+        PduPing = 13,
+        PduResponse = 18
+    };
+
+    enum Flag : quint8 {
+        FlagInstanceRegistration = 0x01,
+        FlagNonDefaultContext = 0x08,
+        FlagNetworkByteOrder = 0x10
+    };
+
+    enum VarbindType : quint16 {
+        TypeInteger = 2,
+        TypeOctetString = 4,
+        TypeNull = 5,
+        TypeObjectIdentifier = 6,
+        TypeIpAddress = 64,
+        TypeCounter32 = 65,
+        TypeGauge32 = 66,
+        TypeTimeTicks = 67,
+        TypeOpaque = 68,
+        TypeCounter64 = 70,
+        TypeNoSuchObject = 128,
+        TypeNoSuchInstance = 129,
+        TypeEndOfMibView = 130
+    };
+
+    enum Error : quint16 {
+        NoError = 0,
+        GenErr = 5,
+        WrongType = 7,
+        WrongValue = 10,
+        NoCreation = 11,
+        CommitFailed = 14,
+        UndoFailed = 15,
+        NotWritable = 17,
+        ParseError = 266,
+        ProcessingError = 268
+    };
+
+    enum CloseReason : quint8 {
+        ReasonOther = 1,
+        ReasonParseError = 2,
+        ReasonProtocolError = 3,
+        ReasonShutdown = 5
+    };
+
+    const quint8 agentx_version = 1;
+    const int header_size = 20;
+    const quint32 max_payload_size = 1024 * 1024;
+    const quint16 default_port = 705;
+    const quint8 default_priority = 127;
+    // GetBulk responses are cut at this number of varbinds
+    const int max_bulk_varbinds = 1024;
+    // ms, the master is pinged while the session is idle
+    const int ping_interval = 15000;
+    const int default_timeout = 5000;
+    const int default_retries = 2;
+    const int min_reconnect_delay = 250;
+    const int max_reconnect_delay = 30000;
+    // bytes, a larger GET PDU is served as a walk
+    const int small_get_size = 1024;
+    // ms the queues are served before the socket is read again
+    const int scheduling_slice = 20;
+    // the first two varbinds of a notification
+    const quint32 sys_up_time_oid[] = { 1, 3, 6, 1, 2, 1, 1, 3, 0 };
+    const quint32 snmp_trap_oid[] = { 1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
+}
+
+// Reads AgentX fields in place, a malformed field invalidates the reader
+class QtSnmpAgentXReader {
+public:
+    QtSnmpAgentXReader( const char*const data, const int size, const bool is_big_endian )
+        : m_data( reinterpret_cast< const uchar* >( data ) )
+        , m_size( size )
+        , m_is_big_endian( is_big_endian )
+    {
+    }
+
+    bool isValid() const {
+        return m_is_valid;
+    }
+
+    bool atEnd() const {
+        return m_offset >= m_size;
+    }
+
+    quint8 readByte() {
+        if ( not require( 1 ) ) {
+            return 0;
+        }
+        return m_data[ m_offset++ ];
+    }
+
+    quint16 readShort() {
+        if ( not require( 2 ) ) {
+            return 0;
+        }
+        const uchar*const data = m_data + m_offset;
+        m_offset += 2;
+        return m_is_big_endian ? qFromBigEndian< quint16 >( data ) : qFromLittleEndian< quint16 >( data );
+    }
+
+    quint32 readInt() {
+        if ( not require( 4 ) ) {
+            return 0;
+        }
+        const uchar*const data = m_data + m_offset;
+        m_offset += 4;
+        return m_is_big_endian ? qFromBigEndian< quint32 >( data ) : qFromLittleEndian< quint32 >( data );
+    }
+
+    quint64 readLong() {
+        if ( not require( 8 ) ) {
+            return 0;
+        }
+        const uchar*const data = m_data + m_offset;
+        m_offset += 8;
+        return m_is_big_endian ? qFromBigEndian< quint64 >( data ) : qFromLittleEndian< quint64 >( data );
+    }
+
+    // n_subid, prefix, include and a reserved byte followed by the sub-identifiers
+    QtSnmpOid readOid( bool*const include = nullptr ) {
+        const quint8 size = readByte();
+        const quint8 prefix = readByte();
+        const quint8 is_included = readByte();
+        readByte();
+        if ( include ) {
+            *include = ( 0 != is_included );
+        }
+
+        QtSnmpOid result;
+        if ( prefix ) {
+            static const quint32 internet[] = { 1, 3, 6, 1 };
+            result = QtSnmpOid( internet, 4 );
+            result.append( prefix );
+        }
+        if ( size + result.size() > QtSnmpOid::MaxLength ) {
+            m_is_valid = false;
+            m_offset = m_size;
+            return {};
+        }
+        for ( int i = 0; i < size; ++i ) {
+            result.append( readInt() );
+        }
+        return result;
+    }
+
+    // the octets refer to the input buffer
+    QByteArray readOctets() {
+        const quint32 length = readInt();
+        const quint32 padded_length = ( length + 3 ) & ~3u;
+        if ( ( padded_length < length ) || not require( static_cast< int >( padded_length ) ) ) {
+            m_is_valid = false;
+            return {};
+        }
+        const QByteArray result = QByteArray::fromRawData( reinterpret_cast< const char* >( m_data + m_offset ),
+                                                           static_cast< int >( length ) );
+        m_offset += static_cast< int >( padded_length );
+        return result;
+    }
+
+private:
+    bool require( const int size ) {
+        if ( ( size < 0 ) || ( m_size - m_offset < size ) ) {
+            m_is_valid = false;
+            m_offset = m_size;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    const uchar*const m_data;
+    const int m_size;
+    const bool m_is_big_endian;
+    int m_offset = 0;
+    bool m_is_valid = true;
+};
+
+namespace {
+    struct SearchRange {
+        QtSnmpOid start;
+        QtSnmpOid end;
+        bool include;
+    };
+
+    // the value of a varbind before it is matched with the object
+    struct RawValue {
+        quint64 number = 0;
+        QByteArray octets;
+    };
+
+    RawValue readValue( QtSnmpAgentXReader& reader, const quint16 type ) {
+        RawValue result;
+        switch ( type ) {
+        case TypeInteger:
+        case TypeCounter32:
+        case TypeGauge32:
+        case TypeTimeTicks:
+            result.number = reader.readInt();
+            break;
+        case TypeCounter64:
+            result.number = reader.readLong();
+            break;
+        case TypeOctetString:
+        case TypeIpAddress:
+        case TypeOpaque:
+            result.octets = reader.readOctets();
+            break;
+        case TypeObjectIdentifier:
+            reader.readOid();
+            break;
+        default:
+            break;
+        }
+        return result;
+    }
+
+    // an Opaque carries a float or a double as the BER encoding of the net-snmp
+    // extension: the tag 0x9f, the type 0x78 (float) or 0x79 (double), the length and the bits
+    const quint8 opaque_extension_tag = 0x9f;
+    const quint8 opaque_float_type = 0x78;
+    const quint8 opaque_double_type = 0x79;
+
+    QByteArray toOpaque( const QtSnmpValue& value ) {
+        QByteArray result;
+        if ( QtSnmpObjectDescription::TypeFloat == value.type() ) {
+            const float float_value = static_cast< float >( value.real() );
+            quint32 bits;
+            memcpy( &bits, &float_value, sizeof( bits ) );
+            result.resize( 3 + sizeof( bits ) );
+            result[ 1 ] = static_cast< char >( opaque_float_type );
+            result[ 2 ] = static_cast< char >( sizeof( bits ) );
+            qToBigEndian< quint32 >( bits, reinterpret_cast< uchar* >( result.data() ) + 3 );
+        } else {
+            const double double_value = value.real();
+            quint64 bits;
+            memcpy( &bits, &double_value, sizeof( bits ) );
+            result.resize( 3 + sizeof( bits ) );
+            result[ 1 ] = static_cast< char >( opaque_double_type );
+            result[ 2 ] = static_cast< char >( sizeof( bits ) );
+            qToBigEndian< quint64 >( bits, reinterpret_cast< uchar* >( result.data() ) + 3 );
+        }
+        result[ 0 ] = static_cast< char >( opaque_extension_tag );
+        return result;
+    }
+
+    QVariant fromOpaque( const QtSnmpObjectDescription::Type type, const QByteArray& octets ) {
+        const uchar*const data = reinterpret_cast< const uchar* >( octets.constData() );
+        if ( ( octets.size() < 3 ) || ( opaque_extension_tag != data[ 0 ] ) ) {
+            return {};
+        }
+        if ( QtSnmpObjectDescription::TypeFloat == type ) {
+            if ( ( opaque_float_type != data[ 1 ] ) || ( 4 != data[ 2 ] ) || ( 7 != octets.size() ) ) {
+                return {};
+            }
+            const quint32 bits = qFromBigEndian< quint32 >( data + 3 );
+            float value;
+            memcpy( &value, &bits, sizeof( value ) );
+            return QVariant::fromValue( static_cast< double >( value ) );
+        }
+        if ( ( opaque_double_type != data[ 1 ] ) || ( 8 != data[ 2 ] ) || ( 11 != octets.size() ) ) {
+            return {};
+        }
+        const quint64 bits = qFromBigEndian< quint64 >( data + 3 );
+        double value;
+        memcpy( &value, &bits, sizeof( value ) );
+        return QVariant::fromValue( value );
+    }
+
+    // the same values as the application receives from the net-snmp backend
+    QVariant toVariant( const QtSnmpObjectDescription::Type type, const RawValue& raw ) {
+        switch ( type ) {
+        case QtSnmpObjectDescription::TypeEnum:
+        case QtSnmpObjectDescription::TypeInterger:
+        case QtSnmpObjectDescription::TypeTimeTicks:
+            return QVariant::fromValue( static_cast< int >( static_cast< qint32 >( raw.number ) ) );
+        case QtSnmpObjectDescription::TypeUnsigned:
+        case QtSnmpObjectDescription::TypeCounter:
+        case QtSnmpObjectDescription::TypeGauge:
+            return QVariant::fromValue( static_cast< unsigned >( raw.number ) );
+        case QtSnmpObjectDescription::TypeCounter64:
+            return QVariant::fromValue( static_cast< qulonglong >( raw.number ) );
+        case QtSnmpObjectDescription::TypeFloat:
+        case QtSnmpObjectDescription::TypeDouble:
+            return fromOpaque( type, raw.octets );
+        case QtSnmpObjectDescription::TypeReal:
+            {
+                bool ok;
+                const double value = raw.octets.toDouble( &ok );
+                return ok ? QVariant::fromValue( value ) : QVariant();
+            }
+        case QtSnmpObjectDescription::TypeIpAddress:
+            if ( 4 != raw.octets.size() ) {
+                return {};
+            }
+            return QVariant::fromValue( static_cast< unsigned >(
+                       qFromBigEndian< quint32 >( reinterpret_cast< const uchar* >( raw.octets.constData() ) ) ) );
+        case QtSnmpObjectDescription::TypeString:
+            // the codec of QtSnmpValue
+            return QVariant::fromValue( QString::fromLocal8Bit( raw.octets.constData(), raw.octets.size() ) );
+        default:
+            break;
+        }
+        return {};
+    }
+}
+
+QtSnmpAgentX::QtSnmpAgentX( QtSnmpSubagent*const subagent )
+    : QObject( subagent )
+    , m_subagent( subagent )
+    , m_ping_timer( new QTimer( this ) )
+    , m_reconnect_timer( new QTimer( this ) )
+{
+    m_uptime.start();
+    m_ping_timer->setSingleShot( true );
+    connect( m_ping_timer, SIGNAL( timeout() ),
+             this, SLOT( checkMaster() ) );
+    m_reconnect_timer->setSingleShot( true );
+    connect( m_reconnect_timer, SIGNAL( timeout() ),
+             this, SLOT( reconnect() ) );
+}
+
+void QtSnmpAgentX::connectToMaster( const QString& address,
+                                    const QString& description,
+                                    const int timeout,
+                                    const int retries )
+{
+    // the new settings apply to a new session
+    close();
+
+    m_address = address;
+    m_description = description;
+    m_timeout = timeout;
+    m_retries = retries;
+    m_reconnect_delay = min_reconnect_delay;
+    openSocket();
+}
+
+void QtSnmpAgentX::openSocket() {
+    if ( m_address.startsWith( "unix:" ) || m_address.startsWith( "/" ) ) {
+        const QString path = m_address.startsWith( "unix:" ) ? m_address.mid( 5 ) : m_address;
+        auto socket = new QLocalSocket( this );
+        m_socket = socket;
+        connectSocket();
+        socket->connectToServer( path );
+        return;
+    }
+
+    const QString host_and_port = m_address.startsWith( "tcp:" ) ? m_address.mid( 4 ) : m_address;
+    const QStringList parts = host_and_port.split( ':' );
+    QString host = parts.value( 0 );
+    quint16 port = default_port;
+    if ( parts.size() > 1 ) {
+        bool ok;
+        port = parts.at( 1 ).toUShort( &ok );
+        if ( not ok ) {
+            qWarning() << "Could not parse the port of the master address " << m_address;
+            port = default_port;
+        }
+    }
+    if ( host.isEmpty() ) {
+        host = "localhost";
+    }
+
+    auto socket = new QTcpSocket( this );
+    m_socket = socket;
+    connectSocket();
+    socket->setSocketOption( QAbstractSocket::LowDelayOption, 1 );
+    socket->connectToHost( host, port );
+}
+
+void QtSnmpAgentX::connectSocket() {
+    connect( m_socket, SIGNAL( connected() ),
+             this, SLOT( onConnected() ) );
+    connect( m_socket, SIGNAL( disconnected() ),
+             this, SLOT( onDisconnected() ) );
+    connect( m_socket, SIGNAL( readyRead() ),
+             this, SLOT( readPackets() ) );
+    if ( qobject_cast< QTcpSocket* >( m_socket ) ) {
+        connect( m_socket, SIGNAL( error( QAbstractSocket::SocketError ) ),
+                 this, SLOT( onError() ) );
+    } else {
+        connect( m_socket, SIGNAL( error( QLocalSocket::LocalSocketError ) ),
+                 this, SLOT( onError() ) );
+    }
+}
+
+void QtSnmpAgentX::close() {
+    m_reconnect_timer->stop();
+    if ( not m_socket ) {
+        return;
+    }
+    if ( m_is_open ) {
+        beginPacket( PduClose, 0, 0, ++m_last_packet_id );
+        writeByte( ReasonShutdown );
+        writeByte( 0 );
+        writeShort( 0 );
+        sendPacket();
+        // the socket is deleted before the event loop would write the PDU
+        if ( auto socket = qobject_cast< QTcpSocket* >( m_socket ) ) {
+            socket->flush();
+        } else if ( auto socket = qobject_cast< QLocalSocket* >( m_socket ) ) {
+            socket->flush();
+        }
+    }
+    dropSocket();
+}
+
+void QtSnmpAgentX::dropSocket() {
+    m_socket->disconnect( this );
+    m_socket->close();
+    m_socket->deleteLater();
+    m_socket = nullptr;
+    resetSession();
+}
+
+void QtSnmpAgentX::connectionLost() {
+    dropSocket();
+    m_subagent->setConnectionState( QtSnmpSubagent::StateDisconnected );
+    qDebug() << "Reconnecting to the AgentX master in " << m_reconnect_delay << " ms";
+    m_reconnect_timer->start( m_reconnect_delay );
+    m_reconnect_delay = qMin( m_reconnect_delay * 2, max_reconnect_delay );
+}
+
+void QtSnmpAgentX::reconnect() {
+    m_subagent->setConnectionState( QtSnmpSubagent::StateConnecting );
+    openSocket();
+}
+
+void QtSnmpAgentX::checkMaster() {
+    if ( not m_is_open ) {
+        return;
+    }
+
+    const int timeout = ( m_timeout < 0 ) ? default_timeout : m_timeout;
+    const int retries = ( m_retries < 0 ) ? default_retries : m_retries;
+    if ( m_ping_packet_id ) {
+        m_commands.remove( m_ping_packet_id );
+        if ( ++m_missed_pings > retries ) {
+            qWarning() << "AgentX master has not answered " << m_missed_pings << " pings, reconnecting";
+            connectionLost();
+            return;
+        }
+    }
+
+    m_ping_packet_id = ++m_last_packet_id;
+    beginPacket( PduPing, 0, 0, m_ping_packet_id );
+    sendPacket();
+    m_commands.insert( m_ping_packet_id, qMakePair( quint8( PduPing ), QtSnmpOid() ) );
+    m_ping_timer->start( timeout );
+}
+
+bool QtSnmpAgentX::isOpen() const {
+    return m_is_open;
+}
+
+void QtSnmpAgentX::registerSubtree( const QtSnmpOid& root,
+                                    const int range_index,
+                                    const quint32 range_upper,
+                                    const bool is_instance )
+{
+    const Registration registration = { root, range_index, range_upper, is_instance, true };
+    QMutexLocker locker( &m_registrations_mutex );
+    m_registrations << registration;
+    if ( 1 == m_registrations.size() ) {
+        QMetaObject::invokeMethod( this, "flushRegistrations", Qt::QueuedConnection );
+    }
+}
+
+void QtSnmpAgentX::unregisterSubtree( const QtSnmpOid& root,
+                                      const int range_index,
+                                      const quint32 range_upper )
+{
+    const Registration registration = { root, range_index, range_upper, false, false };
+    QMutexLocker locker( &m_registrations_mutex );
+    m_registrations << registration;
+    if ( 1 == m_registrations.size() ) {
+        QMetaObject::invokeMethod( this, "flushRegistrations", Qt::QueuedConnection );
+    }
+}
+
+void QtSnmpAgentX::flushRegistrations() {
+    QVector< Registration > registrations;
+    {
+        QMutexLocker locker( &m_registrations_mutex );
+        registrations.swap( m_registrations );
+    }
+
+    // before the session is open the changes are part of the registry registered on open
+    if ( not m_is_open ) {
+        return;
+    }
+    for ( const auto& registration : registrations ) {
+        sendRegistration( registration );
+    }
+}
+
+void QtSnmpAgentX::onConnected() {
+    qDebug() << "Connected to the AgentX master";
+    m_input.resize( 0 );
+    sendOpen();
+}
+
+void QtSnmpAgentX::onDisconnected() {
+    if ( m_is_open ) {
+        qWarning() << "AgentX session " << m_session_id << " has been closed";
+    }
+    connectionLost();
+}
+
+void QtSnmpAgentX::onError() {
+    // a connection which has been established reports the loss through disconnected()
+    if ( m_is_open ) {
+        return;
+    }
+    qWarning() << "Could not connect to the AgentX master: " << m_socket->errorString();
+    connectionLost();
+}
+
+void QtSnmpAgentX::resetSession() {
+    m_is_open = false;
+    m_session_id = 0;
+    m_input.resize( 0 );
+    m_commands.clear();
+    m_responses.clear();
+    m_delegated.clear();
+    m_sets.clear();
+    clearQueues();
+    m_ping_timer->stop();
+    m_ping_packet_id = 0;
+    m_missed_pings = 0;
+    m_pending_registrations = 0;
+}
+
+void QtSnmpAgentX::readPackets() {
+    m_priority_subtrees = m_subagent->prioritySubtrees();
+    m_pdu_time_limit = m_subagent->pduTimeLimit();
+    QElapsedTimer slice;
+    slice.start();
+    const qint64 available = m_socket->bytesAvailable();
+    if ( available > 0 ) {
+        const int offset = m_input.size();
+        m_input.resize( offset + static_cast< int >( available ) );
+        const qint64 count = m_socket->read( m_input.data() + offset, available );
+        m_input.resize( offset + static_cast< int >( qMax( count, qint64( 0 ) ) ) );
+    }
+
+    int consumed = 0;
+    while ( m_input.size() - consumed >= header_size ) {
+        const char*const data = m_input.constData() + consumed;
+        const quint8 flags = static_cast< quint8 >( data[ 2 ] );
+        QtSnmpAgentXReader header_reader( data, header_size, 0 != ( flags & FlagNetworkByteOrder ) );
+        const quint8 version = header_reader.readByte();
+        Header header;
+        header.type = header_reader.readByte();
+        header.flags = header_reader.readByte();
+        header_reader.readByte();
+        header.session_id = header_reader.readInt();
+        header.transaction_id = header_reader.readInt();
+        header.packet_id = header_reader.readInt();
+        const quint32 payload_size = header_reader.readInt();
+
+        if ( ( agentx_version != version ) || ( payload_size > max_payload_size ) ) {
+            qWarning() << "Malformed AgentX packet, the session will be closed";
+            if ( m_is_open ) {
+                beginPacket( PduClose, 0, 0, ++m_last_packet_id );
+                writeByte( ReasonParseError );
+                writeByte( 0 );
+                writeShort( 0 );
+                sendPacket();
+            }
+            m_input.resize( 0 );
+            m_socket->close();
+            return;
+        }
+        if ( static_cast< quint32 >( m_input.size() - consumed - header_size ) < payload_size ) {
+            break;
+        }
+
+        const char*const payload = data + header_size;
+        const int request_class = classify( header, payload, static_cast< int >( payload_size ) );
+        // nothing waits before the PDU, it is served from the input buffer without a copy
+        const bool is_immediate = ( request_class < 0 )
+                                  || ( not hasQueuedPdus() && ( slice.elapsed() < scheduling_slice ) );
+        if ( is_immediate ) {
+            QtSnmpAgentXReader reader( payload,
+                                       static_cast< int >( payload_size ),
+                                       0 != ( header.flags & FlagNetworkByteOrder ) );
+            if ( request_class >= 0 ) {
+                countPdu( request_class, 0, false );
+                m_request_class = request_class;
+            }
+            dispatchPacket( header, reader );
+        } else {
+            QueuedPdu pdu;
+            pdu.header = header;
+            pdu.payload = QByteArray( payload, static_cast< int >( payload_size ) );
+            pdu.arrived.start();
+            enqueue( request_class, pdu );
+        }
+        consumed += header_size + static_cast< int >( payload_size );
+    }
+
+    // keeps the capacity of the buffer for the next packets
+    if ( consumed > 0 ) {
+        m_input.remove( 0, consumed );
+    }
+    processQueues();
+}
+
+int QtSnmpAgentX::classify( const Header& header, const char*const payload, const int size ) const {
+    switch ( header.type ) {
+    case PduTestSet:
+    case PduCommitSet:
+    case PduUndoSet:
+    case PduCleanupSet:
+        return QtSnmpSubagent::RequestSet;
+    case PduGet:
+        return ( size <= small_get_size ) ? QtSnmpSubagent::RequestGet : QtSnmpSubagent::RequestWalk;
+    case PduGetNext:
+    case PduGetBulk:
+        break;
+    default:
+        return -1;
+    }
+
+    if ( not m_priority_subtrees.isEmpty() ) {
+        QtSnmpAgentXReader reader( payload, size, 0 != ( header.flags & FlagNetworkByteOrder ) );
+        if ( header.flags & FlagNonDefaultContext ) {
+            reader.readOctets();
+        }
+        if ( PduGetBulk == header.type ) {
+            reader.readInt();
+        }
+        const QtSnmpOid start = reader.readOid();
+        for ( const auto& subtree : m_priority_subtrees ) {
+            if ( reader.isValid() && start.startsWith( subtree ) ) {
+                return QtSnmpSubagent::RequestGet;
+            }
+        }
+    }
+    return QtSnmpSubagent::RequestWalk;
+}
+
+void QtSnmpAgentX::enqueue( const int request_class, const QueuedPdu& pdu ) {
+    m_queues[ request_class ].enqueue( pdu );
+    QtSnmpSubagent::RequestCounters& counters = m_subagent->m_request_counters[ request_class ];
+    const quint64 depth = static_cast< quint64 >( m_queues[ request_class ].size() );
+    counters.queue_depth.set( depth );
+    counters.max_queue_depth.raise( depth );
+}
+
+bool QtSnmpAgentX::hasQueuedPdus() const {
+    for ( int i = 0; i < QtSnmpSubagent::LimitOfRequestClasses; ++i ) {
+        if ( not m_queues[ i ].isEmpty() ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void QtSnmpAgentX::clearQueues() {
+    for ( int i = 0; i < QtSnmpSubagent::LimitOfRequestClasses; ++i ) {
+        m_queues[ i ].clear();
+        m_subagent->m_request_counters[ i ].queue_depth.set( 0 );
+    }
+}
+
+void QtSnmpAgentX::countPdu( const int request_class, const qint64 wait, const bool is_expired ) {
+    QtSnmpSubagent::RequestCounters& counters = m_subagent->m_request_counters[ request_class ];
+    counters.queue_depth.set( static_cast< quint64 >( m_queues[ request_class ].size() ) );
+    counters.pdus.add();
+    counters.total_wait.add( static_cast< quint64 >( wait ) );
+    counters.max_wait.raise( static_cast< quint64 >( wait ) );
+    if ( is_expired ) {
+        counters.expired.add();
+    }
+}
+
+void QtSnmpAgentX::processQueues() {
+    m_is_processing_scheduled = false;
+    m_pdu_time_limit = m_subagent->pduTimeLimit();
+    const qint64 timeout = ( m_timeout < 0 ) ? default_timeout : m_timeout;
+
+    QElapsedTimer slice;
+    slice.start();
+    while ( m_is_open ) {
+        int request_class = 0;
+        while ( ( request_class < QtSnmpSubagent::LimitOfRequestClasses ) && m_queues[ request_class ].isEmpty() ) {
+            ++request_class;
+        }
+        if ( QtSnmpSubagent::LimitOfRequestClasses == request_class ) {
+            return;
+        }
+        // PDUs which have arrived meanwhile are classified before the rest is served
+        if ( slice.elapsed() >= scheduling_slice ) {
+            if ( not m_is_processing_scheduled ) {
+                m_is_processing_scheduled = true;
+                QMetaObject::invokeMethod( this, "processQueues", Qt::QueuedConnection );
+            }
+            return;
+        }
+
+        const QueuedPdu pdu = m_queues[ request_class ].dequeue();
+        const qint64 wait = pdu.arrived.nsecsElapsed() / 1000;
+        // the master has given up on the request, a SET is finished anyway to keep its transaction consistent
+        const bool is_expired = ( QtSnmpSubagent::RequestSet != request_class ) && ( wait > timeout * 1000 );
+        countPdu( request_class, wait, is_expired );
+
+        if ( is_expired ) {
+            sendError( pdu.header, GenErr, 0 );
+            continue;
+        }
+        QtSnmpAgentXReader reader( pdu.payload.constData(),
+                                   pdu.payload.size(),
+                                   0 != ( pdu.header.flags & FlagNetworkByteOrder ) );
+        m_request_class = request_class;
+        dispatchPacket( pdu.header, reader );
+    }
+}
+
+void QtSnmpAgentX::dispatchPacket( const Header& header, QtSnmpAgentXReader& reader ) {
+    if ( m_subagent->m_is_instrumented.load() ) {
+        QElapsedTimer timer;
+        timer.start();
+        processPacket( header, reader );
+        m_subagent->m_statistics.countPdu( timer.nsecsElapsed() );
+    } else {
+        processPacket( header, reader );
+    }
+}
+
+void QtSnmpAgentX::processPacket( const Header& header, QtSnmpAgentXReader& reader ) {
+    // providers are refreshed at most once per PDU
+    ++m_subagent->m_agent_cycle;
+
+    switch ( header.type ) {
+    case PduResponse:
+        processResponse( header, reader );
+        break;
+    case PduGet:
+    case PduGetNext:
+    case PduGetBulk:
+        if ( header.flags & FlagNonDefaultContext ) {
+            reader.readOctets();
+        }
+        processGet( header, reader );
+        break;
+    case PduTestSet:
+        if ( header.flags & FlagNonDefaultContext ) {
+            reader.readOctets();
+        }
+        processTestSet( header, reader );
+        break;
+    case PduCommitSet:
+        processCommitSet( header );
+        break;
+    case PduUndoSet:
+        processUndoSet( header );
+        break;
+    case PduCleanupSet:
+        processCleanupSet( header );
+        break;
+    case PduClose:
+        qWarning() << "AgentX master has closed the session, reason " << reader.readByte();
+        m_is_open = false;
+        m_socket->close();
+        break;
+    default:
+        qWarning() << Q_FUNC_INFO << "unsupported PDU type:" << header.type;
+        sendError( header, ProcessingError, 0 );
+        break;
+    }
+}
+
+void QtSnmpAgentX::processResponse( const Header& header, QtSnmpAgentXReader& reader ) {
+    reader.readInt();
+    const quint16 error = reader.readShort();
+    const auto command = m_commands.take( header.packet_id );
+    switch ( command.first ) {
+    case PduOpen:
+        if ( NoError != error ) {
+            qWarning() << "AgentX master has refused to open the session, error " << error;
+            m_socket->close();
+            return;
+        }
+        m_session_id = header.session_id;
+        m_is_open = true;
+        m_reconnect_delay = min_reconnect_delay;
+        qDebug() << "AgentX session " << m_session_id << " has been opened";
+        registerAll();
+        m_subagent->setConnectionState( QtSnmpSubagent::StateConnected );
+        m_ping_timer->start( ping_interval );
+        break;
+    case PduRegister:
+        if ( NoError != error ) {
+            qWarning() << "unable to register OID " << command.second << ", error " << error;
+        }
+        if ( ( header.packet_id <= m_registration_packet_id )
+             && ( m_pending_registrations > 0 )
+             && ( 0 == --m_pending_registrations ) )
+        {
+            QMutexLocker locker( &m_subagent->m_statistics_mutex );
+            m_subagent->m_session_statistics.registration_time = m_registration_started.elapsed();
+        }
+        break;
+    case PduPing:
+        if ( header.packet_id == m_ping_packet_id ) {
+            m_ping_packet_id = 0;
+            m_missed_pings = 0;
+            m_ping_timer->start( ping_interval );
+        }
+        break;
+    case PduUnregister:
+        if ( NoError != error ) {
+            qWarning() << "Could not unregister OID: " << command.second << ", error " << error;
+        }
+        break;
+    case PduNotify:
+        if ( NoError != error ) {
+            qWarning() << "AgentX master has refused the notification " << command.second << ", error " << error;
+        }
+        break;
+    default:
+        if ( NoError != error ) {
+            qWarning() << "AgentX request " << header.packet_id << " has failed, error " << error;
+        }
+        break;
+    }
+}
+
+void QtSnmpAgentX::processGet( const Header& header, QtSnmpAgentXReader& reader ) {
+    int non_repeaters = 0;
+    int max_repetitions = 0;
+    if ( PduGetBulk == header.type ) {
+        non_repeaters = reader.readShort();
+        max_repetitions = reader.readShort();
+    }
+
+    QVector< SearchRange > ranges;
+    while ( not reader.atEnd() ) {
+        SearchRange range;
+        range.start = reader.readOid( &range.include );
+        range.end = reader.readOid();
+        ranges << range;
+    }
+    if ( not reader.isValid() ) {
+        sendError( header, ParseError, 0 );
+        return;
+    }
+
+    QElapsedTimer started;
+    started.start();
+    const bool is_limited = ( m_pdu_time_limit > 0 );
+    Response response;
+    response.header = header;
+    response.varbinds.reserve( ranges.size() );
+    m_delegated_to_emit.resize( 0 );
+    if ( PduGetBulk != header.type ) {
+        const bool is_next = ( PduGetNext == header.type );
+        for ( int i = 0; i < ranges.size(); ++i ) {
+            if ( is_limited && ( started.elapsed() >= m_pdu_time_limit ) ) {
+                qWarning() << "AgentX request " << header.packet_id << " has run over the time limit";
+                m_subagent->m_request_counters[ m_request_class ].expired.add();
+                // the values delegated for the response are not waited for
+                for ( const auto& delegated : m_delegated_to_emit ) {
+                    m_delegated.remove( delegated.first );
+                    m_subagent->m_delegated.remove( delegated.first );
+                }
+                m_delegated_to_emit.resize( 0 );
+                m_responses.remove( header.packet_id );
+                sendError( header, GenErr, static_cast< quint16 >( i + 1 ) );
+                return;
+            }
+            resolve( response, ranges.at( i ).start, is_next, ranges.at( i ).include, ranges.at( i ).end );
+        }
+    } else {
+        non_repeaters = qMin( non_repeaters, ranges.size() );
+        for ( int i = 0; i < non_repeaters; ++i ) {
+            resolve( response, ranges.at( i ).start, true, ranges.at( i ).include, ranges.at( i ).end );
+        }
+
+        const int repeaters = ranges.size() - non_repeaters;
+        for ( int repetition = 0; ( repetition < max_repetitions ) && ( repeaters > 0 ); ++repetition ) {
+            // a shorter response is valid for GETBULK, the manager continues from its last varbind
+            if ( ( response.varbinds.size() + repeaters > max_bulk_varbinds )
+                 || ( is_limited && ( started.elapsed() >= m_pdu_time_limit ) ) )
+            {
+                break;
+            }
+            bool is_end_of_view = true;
+            for ( int i = non_repeaters; i < ranges.size(); ++i ) {
+                SearchRange& range = ranges[ i ];
+                resolve( response, range.start, true, range.include, range.end );
+                const Varbind& varbind = response.varbinds.last();
+                if ( TypeEndOfMibView != varbind.exception ) {
+                    is_end_of_view = false;
+                    range.start = varbind.oid;
+                    range.include = false;
+                }
+            }
+            if ( is_end_of_view ) {
+                break;
+            }
+        }
+    }
+
+    if ( response.outstanding > 0 ) {
+        m_responses.insert( header.packet_id, response );
+        const auto delegated_to_emit = m_delegated_to_emit;
+        for ( const auto& delegated : delegated_to_emit ) {
+            emit m_subagent->snmpGetRequest( delegated.second.toString(), delegated.first );
+        }
+        return;
+    }
+    sendResponse( response );
+}
+
+void QtSnmpAgentX::resolve( Response& response,
+                            const QtSnmpOid& start,
+                            const bool is_next,
+                            const bool include,
+                            const QtSnmpOid& end )
+{
+    Varbind varbind;
+    varbind.exception = 0;
+    bool is_async = false;
+    if ( not m_subagent->findObject( start, is_next, include, end, true, &varbind.oid, &varbind.value, &varbind.cell, &is_async ) ) {
+        varbind.oid = start;
+        varbind.exception = is_next ? TypeEndOfMibView : TypeNoSuchInstance;
+    } else if ( is_async ) {
+        const quint64 request_id = m_subagent->startDelegatedRequest( nullptr, varbind.oid );
+        m_delegated.insert( request_id, qMakePair( response.header.packet_id, response.varbinds.size() ) );
+        m_delegated_to_emit << qMakePair( request_id, varbind.oid );
+        ++response.outstanding;
+    }
+    response.varbinds << varbind;
+}
+
+void QtSnmpAgentX::finishDelegatedRequest( const quint64 request_id, const bool is_set ) {
+    const auto delegated_iter = m_delegated.find( request_id );
+    if ( m_delegated.end() == delegated_iter ) {
+        return;
+    }
+    const quint32 packet_id = delegated_iter->first;
+    const int index = delegated_iter->second;
+    m_delegated.erase( delegated_iter );
+
+    const auto response_iter = m_responses.find( packet_id );
+    if ( m_responses.end() == response_iter ) {
+        return;
+    }
+    if ( not is_set && ( NoError == response_iter->error ) ) {
+        response_iter->error = GenErr;
+        response_iter->error_index = static_cast< quint16 >( index + 1 );
+    }
+    if ( --response_iter->outstanding > 0 ) {
+        return;
+    }
+
+    const Response response = *response_iter;
+    m_responses.erase( response_iter );
+    sendResponse( response );
+}
+
+void QtSnmpAgentX::processTestSet( const Header& header, QtSnmpAgentXReader& reader ) {
+    SetState state;
+    quint16 error = NoError;
+    quint16 error_index = 0;
+    {
+        QReadLocker locker( &m_subagent->m_lock );
+        const auto& parameters = m_subagent->m_parameters;
+        while ( not reader.atEnd() ) {
+            const quint16 type = reader.readShort();
+            reader.readShort();
+            const QtSnmpOid oid = reader.readOid();
+            const RawValue raw = readValue( reader, type );
+            if ( not reader.isValid() ) {
+                error = ParseError;
+                break;
+            }
+            if ( NoError != error ) {
+                continue;
+            }
+
+            const auto iter = parameters.constFind( oid );
+            quint16 item_error = NoError;
+            QtSnmpSubagent::SetTransaction::Item item;
+            item.oid = oid;
+            item.is_finished = false;
+            if ( parameters.constEnd() == iter ) {
+                // table cells are written by the application only
+                item_error = m_subagent->isTableCell( oid ) ? NotWritable : NoCreation;
+            } else if ( iter->is_read_only ) {
+                item_error = NotWritable;
+            } else if ( type != iter->value->asnType() ) {
+                item_error = WrongType;
+            } else {
+                item.value = toVariant( iter->type(), raw );
+                item.old_value = iter->value->value();
+                if ( not item.value.isValid() || not iter->validator->check( item.value ) ) {
+                    item_error = WrongValue;
+                    m_subagent->countRejectedSet( *iter );
+                }
+            }
+
+            state.items << item;
+            if ( NoError != item_error ) {
+                error = item_error;
+                error_index = static_cast< quint16 >( state.items.size() );
+            }
+        }
+    }
+
+    if ( NoError == error ) {
+        m_sets.insert( header.transaction_id, state );
+    }
+    sendError( header, error, error_index );
+}
+
+void QtSnmpAgentX::processCommitSet( const Header& header ) {
+    const auto iter = m_sets.find( header.transaction_id );
+    if ( m_sets.end() == iter ) {
+        sendError( header, CommitFailed, 0 );
+        return;
+    }
+
+    // the response is sent once the application accepts or rejects the transaction
+    iter->commit_header = header;
+    iter->transaction_id = m_subagent->beginSetTransaction( nullptr, iter->items );
+    m_subagent->emitSetTransactions();
+}
+
+void QtSnmpAgentX::finishSetTransaction( const quint64 transaction_id, const bool accepted ) {
+    for ( auto iter = m_sets.constBegin(); m_sets.constEnd() != iter; ++iter ) {
+        if ( transaction_id == iter->transaction_id ) {
+            sendError( iter->commit_header, accepted ? NoError : CommitFailed, accepted ? 0 : 1 );
+            return;
+        }
+    }
+}
+
+void QtSnmpAgentX::processUndoSet( const Header& header ) {
+    const auto iter = m_sets.find( header.transaction_id );
+    if ( m_sets.end() == iter ) {
+        sendError( header, UndoFailed, 0 );
+        return;
+    }
+    m_subagent->closeSetTransaction( iter->transaction_id, true );
+    m_sets.erase( iter );
+    sendError( header, NoError, 0 );
+}
+
+void QtSnmpAgentX::processCleanupSet( const Header& header ) {
+    const auto iter = m_sets.find( header.transaction_id );
+    if ( m_sets.end() == iter ) {
+        return;
+    }
+    if ( iter->transaction_id ) {
+        m_subagent->closeSetTransaction( iter->transaction_id, false );
+    }
+    m_sets.erase( iter );
+}
+
+void QtSnmpAgentX::registerAll() {
+    QReadLocker locker( &m_subagent->m_lock );
+    {
+        QMutexLocker registrations_locker( &m_registrations_mutex );
+        m_registrations.clear();
+    }
+
+    // the PDUs are written with one call and the responses are not waited for
+    m_registration_started.start();
+    const quint32 first_packet_id = m_last_packet_id + 1;
+    m_is_batching = true;
+    m_output.resize( 0 );
+    for ( const auto& subtree : m_subagent->m_subtrees ) {
+        sendRegistration( { subtree, -1, 0, false, true } );
+    }
+    for ( const auto& range : m_subagent->m_ranges ) {
+        sendRegistration( { range.root, range.index, range.upper, false, true } );
+    }
+    const auto& tables = m_subagent->m_tables;
+    for ( auto iter = tables.constBegin(); tables.constEnd() != iter; ++iter ) {
+        sendRegistration( { iter.key(), -1, 0, false, true } );
+    }
+    const auto& parameters = m_subagent->m_parameters;
+    for ( auto iter = parameters.constBegin(); parameters.constEnd() != iter; ++iter ) {
+        if ( not m_subagent->isCovered( iter.key() ) ) {
+            sendRegistration( { iter.key(), -1, 0, true, true } );
+        }
+    }
+    m_is_batching = false;
+    m_socket->write( m_output.constData(), m_output.size() );
+    m_output.resize( 0 );
+
+    m_registration_packet_id = m_last_packet_id;
+    m_pending_registrations = static_cast< int >( m_last_packet_id + 1 - first_packet_id );
+    QMutexLocker statistics_locker( &m_subagent->m_statistics_mutex );
+    m_subagent->m_session_statistics.registrations = m_pending_registrations;
+    m_subagent->m_session_statistics.registration_time = m_pending_registrations ? -1 : 0;
+}
+
+void QtSnmpAgentX::sendOpen() {
+    const quint32 packet_id = ++m_last_packet_id;
+    beginPacket( PduOpen, 0, 0, packet_id );
+    // seconds, 0 for the default timeout of the master
+    writeByte( ( m_timeout < 0 ) ? 0 : static_cast< quint8 >( qBound( 1, ( m_timeout + 999 ) / 1000, 255 ) ) );
+    writeByte( 0 );
+    writeShort( 0 );
+    writeOid( QtSnmpOid(), false );
+    const QByteArray description = m_description.toUtf8();
+    writeOctets( description.constData(), description.size() );
+    sendPacket();
+    m_commands.insert( packet_id, qMakePair( quint8( PduOpen ), QtSnmpOid() ) );
+}
+
+void QtSnmpAgentX::sendRegistration( const Registration& registration ) {
+    const quint32 packet_id = ++m_last_packet_id;
+    const quint8 type = registration.is_register ? PduRegister : PduUnregister;
+    const quint8 flags = registration.is_instance ? FlagInstanceRegistration : 0;
+    const quint8 range_subid = ( registration.range_index >= 0 )
+                               ? static_cast< quint8 >( registration.range_index + 1 ) : 0;
+    beginPacket( type, flags, 0, packet_id );
+    writeByte( 0 );
+    writeByte( default_priority );
+    writeByte( range_subid );
+    writeByte( 0 );
+    writeOid( registration.root, false );
+    if ( range_subid ) {
+        writeInt( registration.range_upper );
+    }
+    sendPacket();
+    m_commands.insert( packet_id, qMakePair( type, registration.root ) );
+}
+
+bool QtSnmpAgentX::sendNotification( const QtSnmpOid& notification, const QtSnmpSubagent::VarbindList& varbinds ) {
+    if ( not m_is_open ) {
+        return false;
+    }
+    const quint32 packet_id = ++m_last_packet_id;
+    beginPacket( PduNotify, 0, 0, packet_id );
+    writeShort( TypeTimeTicks );
+    writeShort( 0 );
+    writeOid( QtSnmpOid( sys_up_time_oid, sizeof( sys_up_time_oid ) / sizeof( quint32 ) ), false );
+    writeInt( static_cast< quint32 >( m_uptime.elapsed() / 10 ) );
+    writeShort( TypeObjectIdentifier );
+    writeShort( 0 );
+    writeOid( QtSnmpOid( snmp_trap_oid, sizeof( snmp_trap_oid ) / sizeof( quint32 ) ), false );
+    writeOid( notification, false );
+    for ( const auto& varbind : varbinds ) {
+        writeVarbind( varbind.first, *varbind.second );
+    }
+    sendPacket();
+    m_commands.insert( packet_id, qMakePair( quint8( PduNotify ), notification ) );
+    return true;
+}
+
+void QtSnmpAgentX::sendResponse( const Response& response ) {
+    if ( not m_is_open ) {
+        return;
+    }
+    beginPacket( PduResponse, 0, response.header.transaction_id, response.header.packet_id );
+    writeInt( static_cast< quint32 >( m_uptime.elapsed() / 10 ) );
+    writeShort( response.error );
+    writeShort( response.error_index );
+    for ( const auto& varbind : response.varbinds ) {
+        writeVarbind( varbind );
+    }
+    sendPacket();
+}
+
+void QtSnmpAgentX::sendError( const Header& header, const quint16 error, const quint16 index ) {
+    Response response;
+    response.header = header;
+    response.error = error;
+    response.error_index = index;
+    sendResponse( response );
+}
+
+void QtSnmpAgentX::beginPacket( const quint8 type,
+                                const quint8 flags,
+                                const quint32 transaction_id,
+                                const quint32 packet_id )
+{
+    if ( not m_is_batching ) {
+        m_output.resize( 0 );
+    }
+    m_packet_offset = m_output.size();
+    writeByte( agentx_version );
+    writeByte( type );
+    writeByte( flags | FlagNetworkByteOrder );
+    writeByte( 0 );
+    writeInt( m_session_id );
+    writeInt( transaction_id );
+    writeInt( packet_id );
+    // the payload length is set by sendPacket()
+    writeInt( 0 );
+}
+
+void QtSnmpAgentX::sendPacket() {
+    const quint32 payload_size = static_cast< quint32 >( m_output.size() - m_packet_offset - header_size );
+    qToBigEndian< quint32 >( payload_size,
+                             reinterpret_cast< uchar* >( m_output.data() + m_packet_offset + header_size - 4 ) );
+    if ( not m_is_batching ) {
+        m_socket->write( m_output.constData(), m_output.size() );
+    }
+}
+
+void QtSnmpAgentX::writeByte( const quint8 value ) {
+    m_output.append( static_cast< char >( value ) );
+}
+
+void QtSnmpAgentX::writeShort( const quint16 value ) {
+    uchar buffer[ 2 ];
+    qToBigEndian< quint16 >( value, buffer );
+    m_output.append( reinterpret_cast< const char* >( buffer ), 2 );
+}
+
+void QtSnmpAgentX::writeInt( const quint32 value ) {
+    uchar buffer[ 4 ];
+    qToBigEndian< quint32 >( value, buffer );
+    m_output.append( reinterpret_cast< const char* >( buffer ), 4 );
+}
+
+void QtSnmpAgentX::writeLong( const quint64 value ) {
+    uchar buffer[ 8 ];
+    qToBigEndian< quint64 >( value, buffer );
+    m_output.append( reinterpret_cast< const char* >( buffer ), 8 );
+}
+
+void QtSnmpAgentX::writeOid( const QtSnmpOid& oid, const bool include ) {
+    writeByte( static_cast< quint8 >( oid.size() ) );
+    writeByte( 0 );
+    writeByte( include ? 1 : 0 );
+    writeByte( 0 );
+    for ( int i = 0; i < oid.size(); ++i ) {
+        writeInt( oid.at( i ) );
+    }
+}
+
+void QtSnmpAgentX::writeOctets( const char*const data, const int size ) {
+    static const char padding[ 3 ] = { 0, 0, 0 };
+    writeInt( static_cast< quint32 >( size ) );
+    m_output.append( data, size );
+    m_output.append( padding, ( 4 - ( size % 4 ) ) % 4 );
+}
+
+void QtSnmpAgentX::writeVarbind( const Varbind& varbind ) {
+    if ( varbind.exception ) {
+        writeShort( varbind.exception );
+        writeShort( 0 );
+        writeOid( varbind.oid, false );
+        return;
+    }
+    if ( varbind.value ) {
+        writeVarbind( varbind.oid, *varbind.value );
+        return;
+    }
+
+    // the cell is encoded straight from the stored form
+    QtSnmpValue value( varbind.cell.type );
+    varbind.cell.copyTo( &value );
+    writeVarbind( varbind.oid, value );
+}
+
+void QtSnmpAgentX::writeVarbind( const QtSnmpOid& oid, const QtSnmpValue& value ) {
+    writeShort( value.asnType() );
+    writeShort( 0 );
+    writeOid( oid, false );
+    switch ( value.asnType() ) {
+    case QtSnmpValue::AsnInteger:
+        writeInt( static_cast< quint32 >( static_cast< qint32 >( static_cast< qint64 >( value.scalar() ) ) ) );
+        break;
+    case QtSnmpValue::AsnCounter:
+    case QtSnmpValue::AsnGauge:
+    case QtSnmpValue::AsnTimeTicks:
+        writeInt( static_cast< quint32 >( value.scalar() ) );
+        break;
+    case QtSnmpValue::AsnCounter64:
+        writeLong( value.scalar() );
+        break;
+    case QtSnmpValue::AsnOpaque:
+        {
+            const QByteArray data = toOpaque( value );
+            writeOctets( data.constData(), data.size() );
+        }
+        break;
+    case QtSnmpValue::AsnIpAddress:
+        {
+            // the address is kept in network order
+            const quint32 address = static_cast< quint32 >( value.scalar() );
+            writeOctets( reinterpret_cast< const char* >( &address ), sizeof( address ) );
+        }
+        break;
+    case QtSnmpValue::AsnOctetString:
+        {
+            const QByteArray data = value.data();
+            writeOctets( data.constData(), data.size() );
+        }
+        break;
+    }
+}
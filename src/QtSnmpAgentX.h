@@ -0,0 +1,206 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QVector>
+#include "QtSnmpOid.h"
+#include "QtSnmpValue.h"
+#include "QtSnmpSubagent.h"
+
+class QIODevice;
+class QTimer;
+class QtSnmpAgentXReader;
+
+// AgentX (RFC 2741) session with the master agent served by the Qt event loop.
+// PDUs are decoded in place from the input buffer, responses are encoded into
+// a reused output buffer and requests are dispatched straight into the registry.
+class QtSnmpAgentX : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( QtSnmpAgentX )
+
+public:
+    explicit QtSnmpAgentX( QtSnmpSubagent*const subagent );
+
+    // "unix:/path", "tcp:host:port" or "host:port", an open session is closed first;
+    // timeout (ms) and retries are negative for the defaults. The master is pinged
+    // and a lost session is reopened with backoff, the registry is registered again
+    void connectToMaster( const QString& address,
+                          const QString& description,
+                          const int timeout,
+                          const int retries );
+    bool isOpen() const;
+    // closes the session and the connection
+    void close();
+
+    // thread safe, sent by the session thread; the whole registry is registered when the session opens
+    void registerSubtree( const QtSnmpOid& root,
+                          const int range_index,
+                          const quint32 range_upper,
+                          const bool is_instance );
+    void unregisterSubtree( const QtSnmpOid& root, const int range_index, const quint32 range_upper );
+
+    void finishDelegatedRequest( const quint64 request_id, const bool is_set );
+    // a Notify PDU with sysUpTime.0 and snmpTrapOID.0 in front of the varbinds, false while the session is closed
+    bool sendNotification( const QtSnmpOid& notification, const QtSnmpSubagent::VarbindList& varbinds );
+    void finishSetTransaction( const quint64 transaction_id, const bool accepted );
+
+private:
+    struct Header {
+        quint8 type;
+        quint8 flags;
+        quint32 session_id;
+        quint32 transaction_id;
+        quint32 packet_id;
+    };
+
+    // a varbind of a response, encoded once the values of all varbinds are available
+    struct Varbind {
+        QtSnmpOid oid;
+        quint16 exception;
+        QSharedPointer< QtSnmpValue > value;
+        // a table cell when value is null
+        QtSnmpTable::Cell cell;
+    };
+
+    struct Response {
+        Header header;
+        QVector< Varbind > varbinds;
+        int outstanding = 0;
+        quint16 error = 0;
+        quint16 error_index = 0;
+    };
+
+    // values checked by TestSet and applied by CommitSet
+    struct SetState {
+        QVector< QtSnmpSubagent::SetTransaction::Item > items;
+        quint64 transaction_id = 0;
+        Header commit_header;
+    };
+
+    // a request PDU waiting for its class to be served
+    struct QueuedPdu {
+        Header header;
+        QByteArray payload;
+        QElapsedTimer arrived;
+    };
+
+    struct Registration {
+        QtSnmpOid root;
+        int range_index;
+        quint32 range_upper;
+        bool is_instance;
+        bool is_register;
+    };
+
+    Q_SLOT void onConnected();
+    Q_SLOT void onDisconnected();
+    Q_SLOT void onError();
+    Q_SLOT void reconnect();
+    // pings the master, the session is lost after retries pings without a response
+    Q_SLOT void checkMaster();
+    Q_SLOT void readPackets();
+    Q_SLOT void flushRegistrations();
+    // serves the queued requests by class for a slice of time
+    Q_SLOT void processQueues();
+    void openSocket();
+    void connectSocket();
+    void dropSocket();
+    void connectionLost();
+    void resetSession();
+
+    // the RequestClass of a request PDU, -1 for the PDUs processed at once
+    int classify( const Header&, const char*const payload, const int size ) const;
+    void enqueue( const int request_class, const QueuedPdu& );
+    bool hasQueuedPdus() const;
+    void clearQueues();
+    // µs the PDU has waited in its queue
+    void countPdu( const int request_class, const qint64 wait, const bool is_expired );
+    void dispatchPacket( const Header&, QtSnmpAgentXReader& );
+    void processPacket( const Header&, QtSnmpAgentXReader& );
+    void processResponse( const Header&, QtSnmpAgentXReader& );
+    void processGet( const Header&, QtSnmpAgentXReader& );
+    void processTestSet( const Header&, QtSnmpAgentXReader& );
+    void processCommitSet( const Header& );
+    void processUndoSet( const Header& );
+    void processCleanupSet( const Header& );
+
+    void resolve( Response&,
+                  const QtSnmpOid& start,
+                  const bool is_next,
+                  const bool include,
+                  const QtSnmpOid& end );
+    void registerAll();
+    void sendOpen();
+    void sendRegistration( const Registration& );
+    void sendResponse( const Response& );
+    void sendError( const Header&, const quint16 error, const quint16 index );
+
+    void beginPacket( const quint8 type,
+                      const quint8 flags,
+                      const quint32 transaction_id,
+                      const quint32 packet_id );
+    void sendPacket();
+    void writeByte( const quint8 );
+    void writeShort( const quint16 );
+    void writeInt( const quint32 );
+    void writeLong( const quint64 );
+    void writeOid( const QtSnmpOid&, const bool include );
+    void writeOctets( const char*const data, const int size );
+    void writeVarbind( const Varbind& );
+    void writeVarbind( const QtSnmpOid&, const QtSnmpValue& );
+
+private:
+    QtSnmpSubagent*const m_subagent;
+    QIODevice* m_socket = nullptr;
+    QString m_address;
+    QString m_description;
+    int m_timeout = -1;
+    int m_retries = -1;
+    QByteArray m_input;
+    QByteArray m_output;
+    // PDUs are appended to the output until the batch is written
+    bool m_is_batching = false;
+    int m_packet_offset = 0;
+    bool m_is_open = false;
+    quint32 m_session_id = 0;
+    quint32 m_last_packet_id = 0;
+    QElapsedTimer m_uptime;
+
+    QTimer*const m_ping_timer;
+    quint32 m_ping_packet_id = 0;
+    int m_missed_pings = 0;
+    QTimer*const m_reconnect_timer;
+    int m_reconnect_delay = 0;
+
+    // registrations of the registry sent when the session opened
+    QElapsedTimer m_registration_started;
+    quint32 m_registration_packet_id = 0;
+    int m_pending_registrations = 0;
+
+    // requests sent to the master by packet id
+    QHash< quint32, QPair< quint8, QtSnmpOid > > m_commands;
+    // responses waiting for delegated values by packet id
+    QHash< quint32, Response > m_responses;
+    // delegated request to the packet id and the index of the varbind
+    QHash< quint64, QPair< quint32, int > > m_delegated;
+    QVector< QPair< quint64, QtSnmpOid > > m_delegated_to_emit;
+    // by AgentX transaction id
+    QHash< quint32, SetState > m_sets;
+
+    QQueue< QueuedPdu > m_queues[ QtSnmpSubagent::LimitOfRequestClasses ];
+    bool m_is_processing_scheduled = false;
+    // settings read once per slice and per read of the socket
+    int m_pdu_time_limit = -1;
+    // the class of the request being processed
+    int m_request_class = QtSnmpSubagent::RequestWalk;
+    QVector< QtSnmpOid > m_priority_subtrees;
+
+    QMutex m_registrations_mutex;
+    QVector< Registration > m_registrations;
+};
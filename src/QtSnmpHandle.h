@@ -0,0 +1,151 @@
+#pragma once
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+#include <QVariant>
+#include "QtSnmpObjectDescription.h"
+#include "QtSnmpValue.h"
+#include "QtSnmpValidator.h"
+
+// Maps a native type to the object types it can carry; unsupported types
+// fail to compile since the primary template is never defined.
+template< class T >
+struct QtSnmpValueTraits;
+
+template<>
+struct QtSnmpValueTraits< qint32 > {
+    static bool isCompatible( const QtSnmpObjectDescription::Type type ) {
+        return ( QtSnmpObjectDescription::TypeInterger == type )
+               || ( QtSnmpObjectDescription::TypeEnum == type );
+    }
+    static bool check( const QtSnmpValidator& validator, const qint32 value ) {
+        return validator.checkInteger( value );
+    }
+    static void set( QtSnmpValue& target, const qint32 value ) {
+        target.setInteger( value );
+    }
+    static qint32 get( const QtSnmpValue& source ) {
+        return static_cast< qint32 >( source.integer() );
+    }
+    static QVariant toVariant( const qint32 value ) {
+        return value;
+    }
+};
+
+template<>
+struct QtSnmpValueTraits< quint32 > {
+    static bool isCompatible( const QtSnmpObjectDescription::Type type ) {
+        return ( QtSnmpObjectDescription::TypeUnsigned == type )
+               || ( QtSnmpObjectDescription::TypeCounter == type )
+               || ( QtSnmpObjectDescription::TypeGauge == type )
+               || ( QtSnmpObjectDescription::TypeTimeTicks == type )
+               || ( QtSnmpObjectDescription::TypeIpAddress == type );
+    }
+    static bool check( const QtSnmpValidator& validator, const quint32 value ) {
+        return validator.checkUnsigned( value );
+    }
+    static void set( QtSnmpValue& target, const quint32 value ) {
+        target.setUnsigned( value );
+    }
+    static quint32 get( const QtSnmpValue& source ) {
+        return static_cast< quint32 >( source.unsignedInteger() );
+    }
+    static QVariant toVariant( const quint32 value ) {
+        return value;
+    }
+};
+
+template<>
+struct QtSnmpValueTraits< quint64 > {
+    static bool isCompatible( const QtSnmpObjectDescription::Type type ) {
+        return QtSnmpObjectDescription::TypeCounter64 == type;
+    }
+    static bool check( const QtSnmpValidator& validator, const quint64 value ) {
+        return validator.checkUnsigned( value );
+    }
+    static void set( QtSnmpValue& target, const quint64 value ) {
+        target.setUnsigned( value );
+    }
+    static quint64 get( const QtSnmpValue& source ) {
+        return source.unsignedInteger();
+    }
+    static QVariant toVariant( const quint64 value ) {
+        return static_cast< qulonglong >( value );
+    }
+};
+
+template<>
+struct QtSnmpValueTraits< double > {
+    static bool isCompatible( const QtSnmpObjectDescription::Type type ) {
+        return ( QtSnmpObjectDescription::TypeReal == type )
+               || ( QtSnmpObjectDescription::TypeFloat == type )
+               || ( QtSnmpObjectDescription::TypeDouble == type );
+    }
+    static bool check( const QtSnmpValidator& validator, const double value ) {
+        return validator.checkReal( value );
+    }
+    static void set( QtSnmpValue& target, const double value ) {
+        target.setReal( value );
+    }
+    static double get( const QtSnmpValue& source ) {
+        return source.real();
+    }
+    static QVariant toVariant( const double value ) {
+        return value;
+    }
+};
+
+template<>
+struct QtSnmpValueTraits< QByteArray > {
+    static bool isCompatible( const QtSnmpObjectDescription::Type type ) {
+        return QtSnmpObjectDescription::TypeString == type;
+    }
+    static bool check( const QtSnmpValidator&, const QByteArray& ) {
+        return true;
+    }
+    static void set( QtSnmpValue& target, const QByteArray& value ) {
+        target.setString( value );
+    }
+    static QByteArray get( const QtSnmpValue& source ) {
+        return source.string();
+    }
+    static QVariant toVariant( const QByteArray& value ) {
+        return QString::fromLocal8Bit( value );
+    }
+};
+
+// Typed access to one registered object. set() and get() touch the value
+// directly: no registry lookup, no QVariant and no locks for scalar types,
+// so a handle may be used from any thread.
+template< class T >
+class QtSnmpHandle {
+public:
+    QtSnmpHandle() = default;
+    QtSnmpHandle( const QSharedPointer< QtSnmpValue >& value,
+                  const QSharedPointer< const QtSnmpValidator >& validator )
+        : m_value( value )
+        , m_validator( validator )
+    {
+    }
+
+    bool isNull() const {
+        return m_value.isNull();
+    }
+
+    bool set( const T& value ) {
+        if ( isNull() || not QtSnmpValueTraits< T >::check( *m_validator, value ) ) {
+            return false;
+        }
+        QtSnmpValueTraits< T >::set( *m_value, value );
+        return true;
+    }
+
+    T get() const {
+        return isNull() ? T() : QtSnmpValueTraits< T >::get( *m_value );
+    }
+
+private:
+    QSharedPointer< QtSnmpValue > m_value;
+    QSharedPointer< const QtSnmpValidator > m_validator;
+};
@@ -1,8 +1,7 @@
 #include "QtSnmpObjectDescription.h"
+#include "QtSnmpValidator.h"
 #include <QRegExp>
 #include <QDebug>
-#include <QHostAddress>
-#include <math.h>
 
 QtSnmpObjectDescription::QtSnmpObjectDescription( const QString& oid, const Type type )
     : m_oid( oid )
@@ -24,9 +23,12 @@ bool QtSnmpObjectDescription::isValid() const {
     case TypeUnsigned:
     case TypeCounter:
     case TypeGauge:
+    case TypeCounter64:
         res = res && !hasAvailableValues();
         break;
     case TypeReal:
+    case TypeFloat:
+    case TypeDouble:
         res = res && !hasAvailableValues();
         break;
     case TypeIpAddress:
@@ -87,6 +89,15 @@ static QDebug operator<<( QDebug stream, const QtSnmpObjectDescription::Type typ
     case QtSnmpObjectDescription::TypeString:
         stream << "TypeString";
         break;
+    case QtSnmpObjectDescription::TypeCounter64:
+        stream << "TypeCounter64";
+        break;
+    case QtSnmpObjectDescription::TypeFloat:
+        stream << "TypeFloat";
+        break;
+    case QtSnmpObjectDescription::TypeDouble:
+        stream << "TypeDouble";
+        break;
     default:
         stream << "unsupported: " << static_cast< int >( type );
         break;
@@ -95,127 +106,7 @@ static QDebug operator<<( QDebug stream, const QtSnmpObjectDescription::Type typ
 }
 
 bool QtSnmpObjectDescription::checkValue( const QVariant& value ) const {
-    bool res = false;
-    switch ( m_type ) {
-    case TypeInterger:
-        res = value.canConvert( QVariant::Int );
-        if ( res && hasLimits() ) {
-            const int val = value.toInt();
-            const int min = mininum().toInt( &res );
-            res = res && ( val >= min );
-            if ( not res ) {
-                return false;
-            }
-
-            const int max = maximum().toInt( &res );
-            res = res && ( val <= max );
-            if ( not res ) {
-                return false;
-            }
-
-            if ( hasStep() ) {
-                const int diff = abs(val - min);
-                const int step = m_step.toInt( &res );
-                res = res && ( 0 == ( diff % step ) );
-                if ( not res ) {
-                    return false;
-                }
-            }
-        }
-        break;
-    case TypeEnum:
-        res = value.canConvert( QVariant::Int );
-        res = res && hasAvailableValues();
-        if ( res ){
-            const int val = value.toInt();
-            foreach( const QVariant& available_value, m_available_values ) {
-                const int available_value_int = available_value.toInt( & res );
-                if ( not res ) {
-                    return false;
-                }
-                if ( val == available_value_int ) {
-                    return true;
-                }
-            }
-            res = false;
-        }
-        break;
-    case TypeUnsigned:
-    case TypeCounter:
-    case TypeGauge:
-        res = value.canConvert( QVariant::UInt );
-        if ( res && hasLimits() ) {
-            const unsigned val = value.toUInt();
-            const unsigned min = mininum().toUInt( &res );
-            res = res && ( val >= min );
-            if ( not res ) {
-                return false;
-            }
-
-            const unsigned max = maximum().toUInt( &res );
-            res = res && ( val <= max );
-            if ( not res ) {
-                return false;
-            }
-
-            if ( hasStep() ) {
-                const unsigned diff = val - min;
-                const unsigned step = m_step.toUInt( &res );
-                res = res && ( 0 == ( diff % step ) );
-                if ( not res ) {
-                    return false;
-                }
-            }
-        }
-        break;
-    case TypeReal:
-        res = value.canConvert( QVariant::Double );
-        if ( res && hasLimits() ) {
-            const double val = value.toDouble();
-            const double min = mininum().toDouble( &res );
-            res = res && ( val >= min );
-            if ( not res ) {
-                return false;
-            }
-
-            const double max = maximum().toDouble( &res );
-            res = res && ( val <= max );
-            if ( not res ) {
-                return false;
-            }
-
-            if ( hasStep() ) {
-                const double step = m_step.toDouble( &res );
-                if ( res ) {
-                    const double double_coef = fabs(val - min) / step;
-                    const int int_coef = static_cast< int >( double_coef );
-                    const double diff = double_coef - int_coef;
-                    const double maximum_diff = 0.0000000001;
-                    res = diff < maximum_diff;
-                }
-            }
-        }
-        break;
-    case TypeIpAddress:
-        res = value.canConvert( QVariant::UInt );
-        if ( res ) {
-            const unsigned val = value.toUInt();
-            const QString text = QHostAddress( val ).toString();
-            const QRegExp ip_regex( "^(([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])\\.){3}([0-9]|[1-9][0-9]|1[0-9]{2}|2[0-4][0-9]|25[0-5])$" );
-            res = ip_regex.exactMatch( text );
-        }
-        break;
-    case TypeTimeTicks:
-        res = value.canConvert( QVariant::UInt );
-        break;
-    case TypeString:
-        res = value.canConvert( QVariant::String );
-        break;
-    default:
-        qWarning() << Q_FUNC_INFO << "unsupported type(" << type() << ")";
-        break;
-    }
-    return res;
+    return QtSnmpValidator( *this ).check( value );
 }
 
 void QtSnmpObjectDescription::setLimits( const QVariant& minimum, const QVariant& maximum ) {
@@ -19,6 +19,10 @@ public:
         TypeString,
         TypeCounter,
         TypeGauge,
+        TypeCounter64,
+        // binary values wrapped into Opaque
+        TypeFloat,
+        TypeDouble,
 
         LimitOfTypes
     };
@@ -0,0 +1,113 @@
+#include "QtSnmpOid.h"
+#include <string.h>
+
+QtSnmpOid::QtSnmpOid( const quint32*const parts, const int size ) {
+    m_parts.append( parts, size );
+}
+
+QtSnmpOid QtSnmpOid::fromString( const QString& text, bool*const ok ) {
+    QtSnmpOid result;
+    bool res = not text.isEmpty();
+    const QChar* data = text.constData();
+    const int size = text.size();
+    int pos = ( size > 0 ) && ( '.' == data[ 0 ] ) ? 1 : 0;
+    while ( res && ( pos < size ) ) {
+        quint64 part = 0;
+        const int start = pos;
+        while ( ( pos < size ) && data[ pos ].isDigit() ) {
+            part = part * 10 + static_cast< quint64 >( data[ pos ].toLatin1() - '0' );
+            res = res && ( part <= 0xFFFFFFFFu );
+            ++pos;
+        }
+        res = res && ( pos > start );
+        res = res && ( result.size() < MaxLength );
+        if ( res ) {
+            result.append( static_cast< quint32 >( part ) );
+        }
+        if ( pos < size ) {
+            res = res && ( '.' == data[ pos ] ) && ( pos + 1 < size );
+            ++pos;
+        }
+    }
+
+    if ( ok ) {
+        *ok = res;
+    }
+    return res ? result : QtSnmpOid();
+}
+
+QString QtSnmpOid::toString() const {
+    QString result;
+    result.reserve( m_parts.size() * 4 );
+    for ( const quint32 part : m_parts ) {
+        result += QChar( '.' );
+        result += QString::number( part );
+    }
+    return result;
+}
+
+bool QtSnmpOid::isEmpty() const {
+    return m_parts.isEmpty();
+}
+
+int QtSnmpOid::size() const {
+    return m_parts.size();
+}
+
+quint32 QtSnmpOid::at( const int index ) const {
+    return m_parts.at( index );
+}
+
+const quint32* QtSnmpOid::constData() const {
+    return m_parts.constData();
+}
+
+void QtSnmpOid::append( const quint32 part ) {
+    m_parts.append( part );
+}
+
+void QtSnmpOid::replace( const int index, const quint32 part ) {
+    m_parts[ index ] = part;
+}
+
+bool QtSnmpOid::startsWith( const QtSnmpOid& prefix ) const {
+    if ( prefix.size() > size() ) {
+        return false;
+    }
+    return 0 == memcmp( constData(), prefix.constData(),
+                        static_cast< size_t >( prefix.size() ) * sizeof( quint32 ) );
+}
+
+QtSnmpOid QtSnmpOid::mid( const int position ) const {
+    if ( position >= size() ) {
+        return QtSnmpOid();
+    }
+    return QtSnmpOid( constData() + position, size() - position );
+}
+
+bool operator==( const QtSnmpOid& left, const QtSnmpOid& right ) {
+    return ( left.size() == right.size() ) && left.startsWith( right );
+}
+
+bool operator!=( const QtSnmpOid& left, const QtSnmpOid& right ) {
+    return not ( left == right );
+}
+
+bool operator<( const QtSnmpOid& left, const QtSnmpOid& right ) {
+    const int size = qMin( left.size(), right.size() );
+    for ( int i = 0; i < size; ++i ) {
+        if ( left.at( i ) != right.at( i ) ) {
+            return left.at( i ) < right.at( i );
+        }
+    }
+    return left.size() < right.size();
+}
+
+uint qHash( const QtSnmpOid& oid, uint seed ) {
+    return qHashBits( oid.constData(), static_cast< size_t >( oid.size() ) * sizeof( quint32 ), seed );
+}
+
+QDebug operator<<( QDebug stream, const QtSnmpOid& oid ) {
+    stream << oid.toString();
+    return stream;
+}
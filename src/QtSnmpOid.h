@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QString>
+#include <QVarLengthArray>
+#include <QDebug>
+#include "win_export.h"
+
+class WIN_EXPORT QtSnmpOid {
+public:
+    enum {
+        MaxLength = 128,
+        InlineLength = 16
+    };
+
+public:
+    QtSnmpOid() = default;
+    QtSnmpOid( const quint32*const parts, const int size );
+
+    static QtSnmpOid fromString( const QString& text, bool*const ok = nullptr );
+    QString toString() const;
+
+    bool isEmpty() const;
+    int size() const;
+    quint32 at( const int index ) const;
+    const quint32* constData() const;
+
+    void append( const quint32 part );
+    void replace( const int index, const quint32 part );
+    bool startsWith( const QtSnmpOid& prefix ) const;
+    // the sub-identifiers from the position to the end
+    QtSnmpOid mid( const int position ) const;
+
+private:
+    QVarLengthArray< quint32, InlineLength > m_parts;
+};
+
+WIN_EXPORT bool operator==( const QtSnmpOid&, const QtSnmpOid& );
+WIN_EXPORT bool operator!=( const QtSnmpOid&, const QtSnmpOid& );
+WIN_EXPORT bool operator<( const QtSnmpOid&, const QtSnmpOid& );
+WIN_EXPORT uint qHash( const QtSnmpOid&, uint seed = 0 );
+WIN_EXPORT QDebug operator<<( QDebug, const QtSnmpOid& );
@@ -0,0 +1,79 @@
+#include "QtSnmpStatistics.h"
+
+namespace {
+    const quint32 latency_bounds[ QtSnmpStatistics::LatencyBuckets - 1 ] = {
+        10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 100000
+    };
+}
+
+quint32 QtSnmpStatistics::latencyBound( const int bucket ) {
+    if ( ( bucket < 0 ) || ( bucket >= LatencyBuckets - 1 ) ) {
+        return 0;
+    }
+    return latency_bounds[ bucket ];
+}
+
+void QtSnmpStatistics::countGet() {
+    m_get_requests.add();
+}
+
+void QtSnmpStatistics::countSet() {
+    m_set_requests.add();
+}
+
+void QtSnmpStatistics::countRejectedSet() {
+    m_rejected_sets.add();
+}
+
+void QtSnmpStatistics::countPdu( const qint64 nsecs ) {
+    m_pdus.add();
+    const qint64 usecs = nsecs / 1000;
+    int bucket = 0;
+    while ( ( bucket < LatencyBuckets - 1 ) && ( usecs > latency_bounds[ bucket ] ) ) {
+        ++bucket;
+    }
+    m_latency[ bucket ].add();
+}
+
+void QtSnmpStatistics::enqueue() {
+    const int depth = m_queue_depth.fetchAndAddRelaxed( 1 ) + 1;
+    int max_depth = m_max_queue_depth.load();
+    while ( ( depth > max_depth ) && not m_max_queue_depth.testAndSetRelaxed( max_depth, depth ) ) {
+        max_depth = m_max_queue_depth.load();
+    }
+}
+
+void QtSnmpStatistics::dequeue() {
+    m_queue_depth.fetchAndAddRelaxed( -1 );
+}
+
+quint64 QtSnmpStatistics::getRequests() const {
+    return m_get_requests.value();
+}
+
+quint64 QtSnmpStatistics::setRequests() const {
+    return m_set_requests.value();
+}
+
+quint64 QtSnmpStatistics::rejectedSets() const {
+    return m_rejected_sets.value();
+}
+
+quint64 QtSnmpStatistics::pdus() const {
+    return m_pdus.value();
+}
+
+quint64 QtSnmpStatistics::latency( const int bucket ) const {
+    if ( ( bucket < 0 ) || ( bucket >= LatencyBuckets ) ) {
+        return 0;
+    }
+    return m_latency[ bucket ].value();
+}
+
+int QtSnmpStatistics::queueDepth() const {
+    return m_queue_depth.load();
+}
+
+int QtSnmpStatistics::maxQueueDepth() const {
+    return m_max_queue_depth.load();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QAtomicInteger>
+#include "win_export.h"
+
+// A counter written by the agent thread only: an update is a load and a store of
+// an atomic word without a locked instruction, any thread may read the value.
+class WIN_EXPORT QtSnmpCounter {
+    Q_DISABLE_COPY( QtSnmpCounter )
+
+public:
+    QtSnmpCounter() = default;
+
+    void add( const quint64 count = 1 ) {
+        m_value.store( m_value.load() + count );
+    }
+
+    // for a level such as the depth of a queue
+    void set( const quint64 value ) {
+        m_value.store( value );
+    }
+
+    void raise( const quint64 value ) {
+        if ( value > m_value.load() ) {
+            m_value.store( value );
+        }
+    }
+
+    quint64 value() const {
+        return m_value.load();
+    }
+
+private:
+    QAtomicInteger< quint64 > m_value;
+};
+
+// Requests served by one subagent and the time its agent thread has spent on them.
+class WIN_EXPORT QtSnmpStatistics {
+    Q_DISABLE_COPY( QtSnmpStatistics )
+
+public:
+    enum { LatencyBuckets = 12 };
+
+    // µs, the upper bound of the latency bucket, 0 for the last one which is unbounded
+    static quint32 latencyBound( const int bucket );
+
+public:
+    QtSnmpStatistics() = default;
+
+    // agent thread only
+    void countGet();
+    void countSet();
+    void countRejectedSet();
+    void countPdu( const qint64 nsecs );
+    void dequeue();
+
+    // any thread, an event has been posted to the agent thread
+    void enqueue();
+
+    // varbinds answered by GET, GETNEXT or GETBULK
+    quint64 getRequests() const;
+    // varbinds committed by SET
+    quint64 setRequests() const;
+    // varbinds refused by the validator of the object
+    quint64 rejectedSets() const;
+    // PDUs (AgentX) or passes of the agent (net-snmp)
+    quint64 pdus() const;
+    quint64 latency( const int bucket ) const;
+    // events posted to the agent thread and not handled yet
+    int queueDepth() const;
+    int maxQueueDepth() const;
+
+private:
+    QtSnmpCounter m_get_requests;
+    QtSnmpCounter m_set_requests;
+    QtSnmpCounter m_rejected_sets;
+    QtSnmpCounter m_pdus;
+    QtSnmpCounter m_latency[ LatencyBuckets ];
+    QAtomicInt m_queue_depth;
+    QAtomicInt m_max_queue_depth;
+};
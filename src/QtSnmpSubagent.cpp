@@ -1,15 +1,18 @@
 #include "QtSnmpSubagent.h"
+#include "QtSnmpAgentX.h"
 #include <QCoreApplication>
 #include <QThread>
+#include <QTimer>
+#include <QSocketNotifier>
 #include <QRegExp>
 #include <QDebug>
 #include <QStringList>
-#include <QHostAddress>
-#include <QDataStream>
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 #include <signal.h>
+#include <limits.h>
+#include <algorithm>
 
 #ifndef QT_SNMP_SUBAGENT_DEBUG
     #undef qDebug
@@ -17,330 +20,2072 @@
 #endif
 
 namespace {
-    QString getOidText( netsnmp_request_info*const request ) {
-        QString result;
-        const netsnmp_variable_list*const current_parameter = request->requestvb;
-        for ( size_t i = 0; i < current_parameter->name_length; ++i ) {
-            const oid part = current_parameter->name_loc[ i ];
-            result += QString( ".%1" ).arg( part );
+    QtSnmpOid getOid( const oid*const parts, const size_t size ) {
+        QtSnmpOid result;
+        for ( size_t i = 0; i < size; ++i ) {
+            result.append( static_cast< quint32 >( parts[ i ] ) );
         }
         return result;
     }
 
-    int delayed_instance_handler(
-            netsnmp_mib_handler* handler,
-            netsnmp_handler_registration* reginfo,
-            netsnmp_agent_request_info* reqinfo,
-            netsnmp_request_info* requests)
+    // the destination holds MAX_OID_LEN sub-identifiers, 0 for a longer source
+    size_t toNetSnmpOid( const QtSnmpOid& source, oid*const destination ) {
+        const auto size = static_cast< size_t >( source.size() );
+        if ( size > MAX_OID_LEN ) {
+            qWarning() << "OID " << source << " is longer than " << MAX_OID_LEN << " sub-identifiers";
+            return 0;
+        }
+        for ( size_t i = 0; i < size; ++i ) {
+            destination[ i ] = source.at( static_cast< int >( i ) );
+        }
+        return size;
+    }
+
+    // index of the only sub-identifier which is incremented from the previous OID, -1 if none
+    int adjacentIndex( const QtSnmpOid& previous, const QtSnmpOid& next ) {
+        if ( previous.size() != next.size() ) {
+            return -1;
+        }
+        int index = -1;
+        for ( int i = 0; i < next.size(); ++i ) {
+            if ( previous.at( i ) == next.at( i ) ) {
+                continue;
+            }
+            if ( ( index >= 0 ) || ( previous.at( i ) + 1 != next.at( i ) ) ) {
+                return -1;
+            }
+            index = i;
+        }
+        return index;
+    }
+
+    // hands the request over to the application, the agent keeps serving other PDUs meanwhile
+    void delegate_request( QtSnmpSubagent*const subagent,
+                           netsnmp_mib_handler* handler,
+                           netsnmp_handler_registration* reginfo,
+                           netsnmp_agent_request_info* reqinfo,
+                           netsnmp_request_info* request )
+    {
+        const QtSnmpOid key = getOid( request->requestvb->name, request->requestvb->name_length );
+        request->delegated = 1;
+        netsnmp_delegated_cache*const cache = netsnmp_create_delegated_cache( handler,
+                                                                              reginfo,
+                                                                              reqinfo,
+                                                                              request,
+                                                                              nullptr );
+        if ( MODE_SET_ACTION == reqinfo->mode ) {
+            subagent->agentDelegateSetRequest( cache, key );
+        } else {
+            subagent->agentDelegateGetRequest( cache, key );
+        }
+    }
+
+    quint64 counter64_value( const struct counter64*const value ) {
+        return ( static_cast< quint64 >( value->high & 0xffffffffUL ) << 32 )
+               | static_cast< quint64 >( value->low & 0xffffffffUL );
+    }
+
+    QVariant request_value( const netsnmp_request_info*const request,
+                            const QtSnmpObjectDescription::Type type )
+    {
+        switch ( type ) {
+        case QtSnmpObjectDescription::TypeEnum:
+        case QtSnmpObjectDescription::TypeInterger:
+            {
+                long value = 0;
+                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
+                return QVariant::fromValue( static_cast< int >( value ) );
+            }
+        case QtSnmpObjectDescription::TypeUnsigned:
+        case QtSnmpObjectDescription::TypeCounter:
+        case QtSnmpObjectDescription::TypeGauge:
+            {
+                long value = 0;
+                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
+                return QVariant::fromValue( static_cast< unsigned >( value ) );
+            }
+        case QtSnmpObjectDescription::TypeCounter64:
+            return QVariant::fromValue( static_cast< qulonglong >( counter64_value( request->requestvb->val.counter64 ) ) );
+        case QtSnmpObjectDescription::TypeReal:
+            {
+                const QByteArray text_value = QByteArray::fromRawData(
+                                                  reinterpret_cast< const char* >( request->requestvb->val.string ),
+                                                  static_cast< int >( request->requestvb->val_len ) );
+                bool ok;
+                const double value = text_value.toDouble( &ok );
+                Q_ASSERT( ok );
+                return QVariant::fromValue( value );
+            }
+        case QtSnmpObjectDescription::TypeFloat:
+            return QVariant::fromValue( static_cast< double >( *request->requestvb->val.floatVal ) );
+        case QtSnmpObjectDescription::TypeDouble:
+            return QVariant::fromValue( *request->requestvb->val.doubleVal );
+        case QtSnmpObjectDescription::TypeIpAddress:
+            {
+                quint32 raw_value = 0;
+                memcpy( &raw_value, request->requestvb->val.integer, request->requestvb->val_len );
+                quint32 value = 0;
+                const int size = sizeof( value );
+                quint8* src = reinterpret_cast< quint8* >( &raw_value ) + ( size-1 );
+                quint8* dst = reinterpret_cast< quint8* >( &value );
+                for ( int i = 0; i < size; ++i ) {
+                    *dst++ = *src--;
+                }
+                return QVariant::fromValue( static_cast< unsigned >( value ) );
+            }
+        case QtSnmpObjectDescription::TypeTimeTicks:
+            {
+                long value = 0;
+                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
+                return QVariant::fromValue( static_cast< int >( value ) );
+            }
+        case QtSnmpObjectDescription::TypeString:
+            {
+                // the codec of QtSnmpValue
+                const QString value = QString::fromLocal8Bit(
+                                          reinterpret_cast< const char* >( request->requestvb->val.string ),
+                                          static_cast< int >( request->requestvb->val_len ) );
+                return QVariant::fromValue( value );
+            }
+        default:
+            qWarning() << Q_FUNC_INFO << "unsupported type:"
+                       << static_cast< int >( type );
+            Q_ASSERT( false );
+            break;
+        }
+        return {};
+    }
+
+    void set_variable_value( netsnmp_variable_list*const variable, const QtSnmpValue& value ) {
+        switch ( value.asnType() ) {
+        case QtSnmpValue::AsnInteger:
+            {
+                const long int_value = static_cast< long >( static_cast< qint64 >( value.scalar() ) );
+                snmp_set_var_typed_value( variable,
+                                          ASN_INTEGER,
+                                          &int_value,
+                                          sizeof( int_value ) );
+            }
+            break;
+        case QtSnmpValue::AsnCounter:
+        case QtSnmpValue::AsnGauge:
+        case QtSnmpValue::AsnTimeTicks:
+            {
+                const unsigned long int_value = static_cast< unsigned long >( value.scalar() );
+                snmp_set_var_typed_value( variable,
+                                          value.asnType(),
+                                          &int_value,
+                                          sizeof( int_value ) );
+            }
+            break;
+        case QtSnmpValue::AsnCounter64:
+            {
+                const quint64 scalar = value.scalar();
+                struct counter64 counter_value;
+                counter_value.high = static_cast< u_long >( scalar >> 32 );
+                counter_value.low = static_cast< u_long >( scalar & 0xffffffffU );
+                snmp_set_var_typed_value( variable,
+                                          ASN_COUNTER64,
+                                          &counter_value,
+                                          sizeof( counter_value ) );
+            }
+            break;
+        case QtSnmpValue::AsnOpaque:
+            // net-snmp wraps the binary value into an Opaque by itself
+            if ( QtSnmpObjectDescription::TypeFloat == value.type() ) {
+                const float float_value = static_cast< float >( value.real() );
+                snmp_set_var_typed_value( variable,
+                                          ASN_OPAQUE_FLOAT,
+                                          &float_value,
+                                          sizeof( float_value ) );
+            } else {
+                const double double_value = value.real();
+                snmp_set_var_typed_value( variable,
+                                          ASN_OPAQUE_DOUBLE,
+                                          &double_value,
+                                          sizeof( double_value ) );
+            }
+            break;
+        case QtSnmpValue::AsnIpAddress:
+            {
+                const quint32 address = static_cast< quint32 >( value.scalar() );
+                snmp_set_var_typed_value( variable,
+                                          ASN_IPADDRESS,
+                                          &address,
+                                          sizeof( address ) );
+            }
+            break;
+        case QtSnmpValue::AsnOctetString:
+            {
+                const QByteArray data = value.data();
+                snmp_set_var_typed_value( variable,
+                                          ASN_OCTET_STR,
+                                          data.constData(),
+                                          static_cast< size_t >( data.size() ) );
+            }
+            break;
+        default:
+            qWarning() << Q_FUNC_INFO << "unsupported type:" << static_cast< int >( value.type() );
+            break;
+        }
+    }
+
+    int process_request( QtSnmpSubagent*const subagent,
+                         netsnmp_mib_handler* handler,
+                         netsnmp_handler_registration* reginfo,
+                         netsnmp_agent_request_info* reqinfo,
+                         netsnmp_request_info*const request )
     {
         int res = SNMP_ERR_NOERROR;
-        const QString oid_text = getOidText( requests );
+        const QtSnmpOid key = getOid( request->requestvb->name, request->requestvb->name_length );
         switch ( reqinfo->mode ) {
         case MODE_GET:
-            qDebug() << "MODE_GET: " << oid_text;
-            res = QtSnmpSubagent::instance()->agentCallbackGetValue( requests, oid_text );
+            qDebug() << "MODE_GET: " << key;
+            res = subagent->agentCallbackGetValue( request, key );
+            if ( QtSnmpSubagent::AgentRequestDelegated == res ) {
+                delegate_request( subagent, handler, reginfo, reqinfo, request );
+                res = SNMP_ERR_NOERROR;
+            }
             break;
         case MODE_SET_RESERVE1:
             qDebug() << "MODE_SET_RESERVE1: check type and size";
-            res = QtSnmpSubagent::instance()->agentCallbackCheckTypeAndLen( requests, oid_text );
+            res = subagent->agentCallbackCheckTypeAndLen( request, key );
             break;
         case MODE_SET_RESERVE2:
             qDebug() << "MODE_SET_RESERVE2: check value";
-            res = QtSnmpSubagent::instance()->agentCallbackCheckValue( requests, oid_text );
+            res = subagent->agentCallbackCheckValue( request, key );
             break;
         case MODE_SET_ACTION:
             qDebug() << "MODE_SET_ACTION: apply changes( if error, undo will be called )";
-            res = QtSnmpSubagent::instance()->agentCallbackApplyChange( requests, oid_text );
+            res = subagent->agentCallbackApplyChange( request, key );
+            if ( QtSnmpSubagent::AgentRequestDelegated == res ) {
+                delegate_request( subagent, handler, reginfo, reqinfo, request );
+                res = SNMP_ERR_NOERROR;
+            }
             break;
         case MODE_SET_COMMIT:
             qDebug() << "MODE_SET_COMMIT: complete action - final node";
+            res = subagent->agentCallbackCommitChange( request, key );
             break;
         case MODE_SET_FREE:
             qDebug() << "MODE_SET_FREE: if reserve2 or reserve2 failed";
+            res = subagent->agentCallbackFreeChange( request, key );
             break;
         case MODE_SET_UNDO:
             qDebug() << "MODE_SET_UNDO: if action failed";
+            res = subagent->agentCallbackUndoChange( request, key );
             break;
         default:
-            qDebug() << Q_FUNC_INFO << "unsupported mode:" << reqinfo->mode;
-            res = netsnmp_call_next_handler(handler, reginfo, reqinfo, requests);
             break;
         }
         return res;
     }
+
+    int delayed_instance_handler(
+            netsnmp_mib_handler* handler,
+            netsnmp_handler_registration* reginfo,
+            netsnmp_agent_request_info* reqinfo,
+            netsnmp_request_info* requests)
+    {
+        switch ( reqinfo->mode ) {
+        case MODE_GET:
+        case MODE_SET_RESERVE1:
+        case MODE_SET_RESERVE2:
+        case MODE_SET_ACTION:
+        case MODE_SET_COMMIT:
+        case MODE_SET_FREE:
+        case MODE_SET_UNDO:
+            break;
+        default:
+            qDebug() << Q_FUNC_INFO << "unsupported mode:" << reqinfo->mode;
+            return netsnmp_call_next_handler(handler, reginfo, reqinfo, requests);
+        }
+
+        // the master may batch several varbinds of the PDU into one call
+        QtSnmpSubagent*const subagent = QtSnmpSubagent::instance();
+        for ( netsnmp_request_info* request = requests; request; request = request->next ) {
+            if ( request->processed ) {
+                continue;
+            }
+            const int res = process_request( subagent, handler, reginfo, reqinfo, request );
+            if ( SNMP_ERR_NOERROR != res ) {
+                netsnmp_set_request_error( reqinfo, request, res );
+            }
+        }
+        return SNMP_ERR_NOERROR;
+    }
+
+    int subtree_handler(
+            netsnmp_mib_handler* handler,
+            netsnmp_handler_registration* reginfo,
+            netsnmp_agent_request_info* reqinfo,
+            netsnmp_request_info* requests)
+    {
+        if ( ( MODE_GET != reqinfo->mode ) && ( MODE_GETNEXT != reqinfo->mode ) ) {
+            return delayed_instance_handler( handler, reginfo, reqinfo, requests );
+        }
+
+        QtSnmpSubagent*const subagent = QtSnmpSubagent::instance();
+        const QtSnmpOid root = getOid( reginfo->rootoid, reginfo->rootoid_len );
+        const int range_index = reginfo->range_subid - 1;
+        const quint32 range_upper = static_cast< quint32 >( reginfo->range_ubound );
+        for ( netsnmp_request_info* request = requests; request; request = request->next ) {
+            if ( request->processed ) {
+                continue;
+            }
+
+            const QtSnmpOid key = getOid( request->requestvb->name, request->requestvb->name_length );
+            if ( MODE_GET == reqinfo->mode ) {
+                qDebug() << "MODE_GET: " << key;
+                const int res = subagent->agentCallbackGetValue( request, key );
+                if ( SNMP_ERR_NOSUCHNAME == res ) {
+                    netsnmp_set_request_error( reqinfo, request, SNMP_NOSUCHINSTANCE );
+                } else if ( QtSnmpSubagent::AgentRequestDelegated == res ) {
+                    delegate_request( subagent, handler, reginfo, reqinfo, request );
+                }
+            } else {
+                qDebug() << "MODE_GETNEXT: " << key;
+                const int res = subagent->agentCallbackGetNextValue( request, key, root, range_index, range_upper );
+                if ( QtSnmpSubagent::AgentRequestDelegated == res ) {
+                    delegate_request( subagent, handler, reginfo, reqinfo, request );
+                }
+            }
+        }
+        return SNMP_ERR_NOERROR;
+    }
+
+    // the net-snmp agent reports the master session through the index callbacks
+    int master_session_callback( int, int minor_id, void*, void* client_arg ) {
+        auto subagent = static_cast< QtSnmpSubagent* >( client_arg );
+        subagent->agentCallbackSessionChanged( SNMPD_CALLBACK_INDEX_START == minor_id );
+        return SNMP_ERR_NOERROR;
+    }
+
+    class SetValuesEvent : public QEvent {
+    public:
+        explicit SetValuesEvent( const QtSnmpSubagent::ValueList& _values )
+            : QEvent( type() )
+            , values( _values )
+        {
+        }
+
+        static QEvent::Type type() {
+            static const auto event_type = static_cast< QEvent::Type >( QEvent::registerEventType() );
+            return event_type;
+        }
+
+        const QtSnmpSubagent::ValueList values;
+    };
+
+    class CompleteGetEvent : public QEvent {
+    public:
+        CompleteGetEvent( const quint64 _request_id, const QVariant& _value )
+            : QEvent( type() )
+            , request_id( _request_id )
+            , value( _value )
+        {
+        }
+
+        static QEvent::Type type() {
+            static const auto event_type = static_cast< QEvent::Type >( QEvent::registerEventType() );
+            return event_type;
+        }
+
+        const quint64 request_id;
+        const QVariant value;
+    };
+
+    class CompleteSetEvent : public QEvent {
+    public:
+        CompleteSetEvent( const quint64 _transaction_id, const bool _accepted )
+            : QEvent( type() )
+            , transaction_id( _transaction_id )
+            , accepted( _accepted )
+        {
+        }
+
+        static QEvent::Type type() {
+            static const auto event_type = static_cast< QEvent::Type >( QEvent::registerEventType() );
+            return event_type;
+        }
+
+        const quint64 transaction_id;
+        const bool accepted;
+    };
+
+    // net-snmp is not thread safe, registrations made by other threads are passed to the agent thread
+    class MasterRegistrationEvent : public QEvent {
+    public:
+        MasterRegistrationEvent( const QtSnmpOid& _root,
+                                 const int _range_index,
+                                 const quint32 _range_upper,
+                                 const bool _is_instance,
+                                 const bool _is_registration )
+            : QEvent( type() )
+            , root( _root )
+            , range_index( _range_index )
+            , range_upper( _range_upper )
+            , is_instance( _is_instance )
+            , is_registration( _is_registration )
+        {
+        }
+
+        static QEvent::Type type() {
+            static const auto event_type = static_cast< QEvent::Type >( QEvent::registerEventType() );
+            return event_type;
+        }
+
+        const QtSnmpOid root;
+        const int range_index;
+        const quint32 range_upper;
+        const bool is_instance;
+        const bool is_registration;
+    };
+
+    // ms between pings of the master by net-snmp
+    const int ping_interval = 15000;
+    // ms, the statistics served by registerSnmpStatistics() are read this often at most
+    const int statistics_ttl = 1000;
+    // notifications kept while the session is down or the window is open
+    const int notification_queue_limit = 1000;
+    // snmpTrapOID.0, the type of a notification
+    const oid snmp_trap_oid[] = { 1, 3, 6, 1, 6, 3, 1, 1, 4, 1, 0 };
 }
 
 QtSnmpSubagent* QtSnmpSubagent::instance() {
     static QtSnmpSubagent* subagent = nullptr;
     if ( not subagent ) {
-        Q_ASSERT( qApp );
-        QThread*const thread = new QThread;
-        thread->setObjectName( "snmp_subagent" );
-        subagent = new QtSnmpSubagent;
-        subagent->moveToThread( thread );
-        connect( qApp, SIGNAL( destroyed() ),
-                 subagent, SLOT( deleteLater() ) );
-        connect( subagent, SIGNAL( destroyed() ),
-                 thread, SLOT( quit() ) );
-        connect( thread, SIGNAL( finished() ),
-                 thread, SLOT( deleteLater() ) );
-        connect( thread, SIGNAL( started() ),
+        subagent = createOnThread( "snmp_subagent" );
+        subagent->m_is_default = true;
+        connect( subagent->thread(), SIGNAL( started() ),
                  subagent, SLOT( start() ) );
-        thread->start();
-        for ( int i = 0; !subagent->m_initialized && (i < 1000); ++i ) {
-            qApp->processEvents();
-        }
+        subagent->thread()->start();
     }
     return subagent;
 }
 
+QtSnmpSubagent* QtSnmpSubagent::createInstance( const QString& application_name ) {
+    QtSnmpSubagent*const subagent = createOnThread( "snmp_subagent_" + application_name );
+    // the net-snmp agent is global to the process
+    subagent->m_backend = BackendAgentX;
+    subagent->m_application_name = application_name;
+    subagent->thread()->start();
+    return subagent;
+}
+
+QtSnmpSubagent* QtSnmpSubagent::createOnThread( const QString& thread_name ) {
+    Q_ASSERT( qApp );
+    qRegisterMetaType< QtSnmpSubagent::ConnectionState >( "QtSnmpSubagent::ConnectionState" );
+    QThread*const thread = new QThread;
+    thread->setObjectName( thread_name );
+    QtSnmpSubagent*const subagent = new QtSnmpSubagent;
+    subagent->moveToThread( thread );
+    connect( qApp, SIGNAL( aboutToQuit() ),
+             subagent, SLOT( stop() ) );
+    connect( qApp, SIGNAL( destroyed() ),
+             subagent, SLOT( deleteLater() ) );
+    connect( subagent, SIGNAL( destroyed() ),
+             thread, SLOT( quit() ) );
+    connect( thread, SIGNAL( finished() ),
+             thread, SLOT( deleteLater() ) );
+    return subagent;
+}
+
+QtSnmpSubagent::~QtSnmpSubagent() {
+    QThread*const agent_thread = thread();
+    if ( agent_thread && ( QThread::currentThread() != agent_thread ) && agent_thread->isRunning() ) {
+        // a queued stop() would reach a deleted object, the session is closed before the memory is freed
+        QMetaObject::invokeMethod( this, "stop", Qt::BlockingQueuedConnection );
+    } else {
+        // nothing else runs on the agent thread
+        shutdown();
+    }
+}
+
 bool QtSnmpSubagent::registerSnmpObject( const QtSnmpObjectDescription& description,
                                          const QVariant& value )
+{
+    return insertObject( description, value, -1 );
+}
+
+bool QtSnmpSubagent::insertObject( const QtSnmpObjectDescription& description,
+                                   const QVariant& value,
+                                   const int async_timeout )
 {
     if ( not description.isValid() ) {
         qWarning() << "Could not register object with an incorrect description:" << description;
         return false;
     }
 
-    if ( m_parameters.contains( description.oid() ) ) {
+    bool ok;
+    const QtSnmpOid key = QtSnmpOid::fromString( description.oid(), &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse OID " << description.oid();
+        return false;
+    }
+
+    QWriteLocker locker( &m_lock );
+    if ( m_parameters.contains( key ) ) {
         qWarning() << "OID " << description.oid() << " has been already registered";
-        return true;
+        // an existing object is never turned asynchronous
+        return async_timeout < 0;
+    }
+    if ( findTable( key ) ) {
+        qWarning() << "OID " << description.oid() << " belongs to a registered table";
+        return false;
     }
 
-    bool ok;
-    QList< oid > oid_list;
-    for ( const auto& part : description.oid().split( ".", QString::SkipEmptyParts ) ) {
-        oid_list << part.toULong( &ok );
+    if ( not isCovered( key ) && not registerWithMaster( key, -1, 0, true ) ) {
+        qWarning() << "unable to register OID " << description.oid();
+        return false;
+    }
+
+    // asynchronous from its first request on
+    Parameter parameter = createParameter( description, value );
+    parameter.async_timeout = async_timeout;
+    m_parameters.insert( key, parameter );
+    qDebug() << "OID " << description.oid() << " has been successfully registered [" << value << "]";
+
+    return true;
+}
+
+bool QtSnmpSubagent::unregisterSnmpObject( const QString& oid_text ) {
+    const QtSnmpOid key = QtSnmpOid::fromString( oid_text );
+    QWriteLocker locker( &m_lock );
+    auto iter = m_parameters.find( key );
+    if ( m_parameters.end() == iter ) {
+        qWarning() << "OID " << oid_text << " is not registered";
+        return false;
+    }
+
+    if ( not isCovered( key ) && not unregisterWithMaster( key, -1, 0 ) ) {
+        qWarning() << "Could not unregister OID: " << oid_text;
+        return false;
+    }
+
+    m_parameters.erase( iter );
+    qDebug() << "OID " << oid_text << " has been successfuly unregistred";
+    return true;
+}
+
+bool QtSnmpSubagent::registerSnmpObjects( const ObjectList& objects ) {
+    return insertObjects( objects, QSharedPointer< ProviderGroup >() );
+}
+
+bool QtSnmpSubagent::insertObjects( const ObjectList& objects, const QSharedPointer< ProviderGroup >& group ) {
+    QVector< QPair< QtSnmpOid, int > > items;
+    items.reserve( objects.size() );
+    for ( int i = 0; i < objects.size(); ++i ) {
+        const QtSnmpObjectDescription& description = objects.at( i ).first;
+        if ( not description.isValid() ) {
+            qWarning() << "Could not register object with an incorrect description:" << description;
+            return false;
+        }
+
+        bool ok;
+        items << qMakePair( QtSnmpOid::fromString( description.oid(), &ok ), i );
         if ( not ok ) {
             qWarning() << "Could not parse OID " << description.oid();
             return false;
         }
     }
+    std::sort( items.begin(), items.end() );
+
+    QWriteLocker locker( &m_lock );
+    // only the objects inserted by this call are served by the provider
+    const auto insert = [ this, &objects, &group ]( const QPair< QtSnmpOid, int >& item ) {
+        const auto& object = objects.at( item.second );
+        const auto iter = m_parameters.insert( item.first, createParameter( object.first, object.second ) );
+        if ( not group.isNull() ) {
+            iter->provider = group;
+            group->values << qMakePair( object.first.oid(), QVariant() );
+            group->targets << iter->value;
+            group->validators << iter->validator;
+        }
+    };
 
-    auto oid_array = new oid[ static_cast< size_t >( oid_list.size() ) ];
-    for ( int i = 0; i < oid_list.count(); ++i ) {
-        oid_array[i] = oid_list.at( i );
+    QVector< QPair< QtSnmpOid, int > > pending;
+    pending.reserve( items.size() );
+    for ( int i = 0; i < items.size(); ++i ) {
+        const auto& item = items.at( i );
+        if ( ( ( i > 0 ) && ( items.at( i - 1 ).first == item.first ) )
+             || m_parameters.contains( item.first ) )
+        {
+            qWarning() << "OID " << item.first << " has been already registered";
+            continue;
+        }
+        if ( isCovered( item.first ) ) {
+            insert( item );
+        } else {
+            pending << item;
+        }
     }
 
-    auto ads_b_handler = netsnmp_create_handler_registration(
-                             qPrintable( description.oid() ),
-                             delayed_instance_handler,
-                             oid_array,
-                             static_cast< size_t >(oid_list.count()),
-                             HANDLER_CAN_RWRITE);
-    const int res = netsnmp_register_instance( ads_b_handler );
-    delete[] oid_array;
+    bool res = true;
+    int begin = 0;
+    while ( begin < pending.size() ) {
+        int end = begin + 1;
+        int range_index = -1;
+        while ( end < pending.size() ) {
+            const int index = adjacentIndex( pending.at( end - 1 ).first, pending.at( end ).first );
+            if ( ( index < 0 ) || ( ( range_index >= 0 ) && ( index != range_index ) ) ) {
+                break;
+            }
+            range_index = index;
+            ++end;
+        }
+
+        const QtSnmpOid& root = pending.at( begin ).first;
+        const QString name = objects.at( pending.at( begin ).second ).first.oid();
+        bool is_registered;
+        if ( range_index < 0 ) {
+            is_registered = registerWithMaster( root, -1, 0, true );
+        } else {
+            const Range range = { root, range_index, pending.at( end - 1 ).first.at( range_index ) };
+            is_registered = registerWithMaster( root, range.index, range.upper, false );
+            if ( is_registered ) {
+                m_ranges.insert( rangePattern( root, range.index ), range );
+            }
+        }
 
-    if ( MIB_REGISTERED_OK != res ) {
-        qWarning() << "unable to register OID " << description.oid();
+        if ( is_registered ) {
+            for ( int i = begin; i < end; ++i ) {
+                insert( pending.at( i ) );
+            }
+        } else {
+            qWarning() << "unable to register OID " << name << " and " << ( end - begin - 1 ) << " adjacent objects";
+            res = false;
+        }
+        begin = end;
+    }
+
+    qDebug() << objects.size() << " objects have been registered";
+    return res;
+}
+
+bool QtSnmpSubagent::registerSnmpProvider( const ObjectList& objects,
+                                           const Provider& provider,
+                                           const int ttl )
+{
+    QSharedPointer< ProviderGroup > group( new ProviderGroup );
+    group->provider = provider;
+    group->ttl = ttl;
+    // objects registered before keep their values, objects which failed are not served
+    return insertObjects( objects, group );
+}
+
+bool QtSnmpSubagent::registerSnmpAsyncObject( const QtSnmpObjectDescription& description,
+                                              const int timeout )
+{
+    return insertObject( description, QVariant(), qMax( timeout, 0 ) );
+}
+
+bool QtSnmpSubagent::isStale( const QSharedPointer< ProviderGroup >& group ) const {
+    if ( group.isNull() ) {
         return false;
     }
+    if ( not group->updated.isValid() ) {
+        return true;
+    }
+    return ( group->cycle != m_agent_cycle ) && ( group->updated.elapsed() >= group->ttl );
+}
 
-    m_parameters.insert( description.oid(), Parameter( description, value ) );
-    qDebug() << "OID " << description.oid() << " has been successfully registered [" << value << "]";
+void QtSnmpSubagent::refreshProvider( const QSharedPointer< ProviderGroup >& group ) {
+    ValueList& values = group->values;
+    for ( auto& item : values ) {
+        item.second = QVariant();
+    }
+    group->provider( values );
+
+    Q_ASSERT( values.size() == group->targets.size() );
+    const int size = qMin( values.size(), group->targets.size() );
+    for ( int i = 0; i < size; ++i ) {
+        const QVariant& value = values.at( i ).second;
+        if ( not value.isValid() ) {
+            continue;
+        }
+        if ( group->validators.at( i )->check( value ) ) {
+            group->targets.at( i )->setValue( value );
+        } else {
+            qWarning() << "Inappropriate value " << value
+                       << " for OID " << values.at( i ).first << " will be ignored.";
+        }
+    }
+
+    group->cycle = m_agent_cycle;
+    group->updated.start();
+}
+
+QSharedPointer< QtSnmpTable > QtSnmpSubagent::registerSnmpTable( const QList< QtSnmpObjectDescription >& columns ) {
+    QSharedPointer< QtSnmpTable > table( new QtSnmpTable( columns ) );
+    if ( not table->isValid() ) {
+        return {};
+    }
+
+    const QtSnmpOid entry = table->entry();
+    QWriteLocker locker( &m_lock );
+    const auto iter = m_parameters.lowerBound( entry );
+    if ( ( m_parameters.constEnd() != iter ) && iter.key().startsWith( entry ) ) {
+        qWarning() << "Table " << entry << " overlaps registered OID " << iter.key();
+        return {};
+    }
+    for ( const auto& subtree : m_subtrees ) {
+        if ( entry.startsWith( subtree ) || subtree.startsWith( entry ) ) {
+            qWarning() << "Table " << entry << " overlaps registered subtree " << subtree;
+            return {};
+        }
+    }
+    for ( auto table_iter = m_tables.constBegin(); m_tables.constEnd() != table_iter; ++table_iter ) {
+        if ( entry.startsWith( table_iter.key() ) || table_iter.key().startsWith( entry ) ) {
+            qWarning() << "Table " << entry << " overlaps registered table " << table_iter.key();
+            return {};
+        }
+    }
+
+    if ( not registerWithMaster( entry, -1, 0, false ) ) {
+        qWarning() << "unable to register table " << entry;
+        return {};
+    }
+    m_tables.insert( entry, table );
+    qDebug() << "Table " << entry << " has been successfully registered";
+    return table;
+}
+
+bool QtSnmpSubagent::unregisterSnmpTable( const QString& oid_text ) {
+    const QtSnmpOid entry = QtSnmpOid::fromString( oid_text );
+    QWriteLocker locker( &m_lock );
+    const auto iter = m_tables.find( entry );
+    if ( m_tables.end() == iter ) {
+        qWarning() << "Table " << oid_text << " is not registered";
+        return false;
+    }
+    if ( not unregisterWithMaster( entry, -1, 0 ) ) {
+        qWarning() << "Could not unregister table: " << oid_text;
+        return false;
+    }
+    m_tables.erase( iter );
+    return true;
+}
+
+QSharedPointer< QtSnmpTable > QtSnmpSubagent::findTable( const QtSnmpOid& key ) const {
+    // tables do not overlap, only the last entry before the key may contain it
+    auto iter = m_tables.upperBound( key );
+    if ( m_tables.constBegin() == iter ) {
+        return {};
+    }
+    --iter;
+    return key.startsWith( iter.key() ) ? iter.value() : QSharedPointer< QtSnmpTable >();
+}
+
+bool QtSnmpSubagent::findTableCell( const QtSnmpOid& start,
+                                    const bool is_next,
+                                    const bool include,
+                                    const QtSnmpOid& end,
+                                    QtSnmpOid*const key,
+                                    QtSnmpTable::Cell*const cell ) const
+{
+    if ( m_tables.isEmpty() ) {
+        return false;
+    }
+    if ( not is_next ) {
+        const QSharedPointer< QtSnmpTable > table = findTable( start );
+        return table && table->findCell( start, false, include, end, key, cell );
+    }
+
+    // the cells of a table are ordered before the entries of the following tables
+    auto iter = m_tables.upperBound( start );
+    if ( m_tables.constBegin() != iter ) {
+        auto previous = iter;
+        --previous;
+        if ( start.startsWith( previous.key() ) ) {
+            iter = previous;
+        }
+    }
+    for ( ; m_tables.constEnd() != iter; ++iter ) {
+        if ( not end.isEmpty() && not ( iter.key() < end ) ) {
+            return false;
+        }
+        if ( iter.value()->findCell( start, true, include, end, key, cell ) ) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QtSnmpSubagent::isTableCell( const QtSnmpOid& key ) const {
+    QtSnmpOid cell_key;
+    QtSnmpTable::Cell cell;
+    return findTableCell( key, false, true, QtSnmpOid(), &cell_key, &cell );
+}
+
+bool QtSnmpSubagent::registerSnmpSubtree( const QString& oid_text ) {
+    bool ok;
+    const QtSnmpOid subtree = QtSnmpOid::fromString( oid_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse OID " << oid_text;
+        return false;
+    }
+
+    QWriteLocker locker( &m_lock );
+    for ( const auto& registered : m_subtrees ) {
+        if ( registered.startsWith( subtree ) || subtree.startsWith( registered ) ) {
+            qWarning() << "Subtree " << oid_text << " overlaps registered subtree " << registered;
+            return false;
+        }
+    }
+    for ( auto iter = m_tables.constBegin(); m_tables.constEnd() != iter; ++iter ) {
+        if ( iter.key().startsWith( subtree ) || subtree.startsWith( iter.key() ) ) {
+            qWarning() << "Subtree " << oid_text << " overlaps registered table " << iter.key();
+            return false;
+        }
+    }
+
+    if ( not registerWithMaster( subtree, -1, 0, false ) ) {
+        qWarning() << "unable to register subtree " << oid_text;
+        return false;
+    }
+
+    // objects registered before are served by the subtree handler from now on
+    for ( auto iter = m_parameters.lowerBound( subtree );
+          ( m_parameters.end() != iter ) && iter.key().startsWith( subtree );
+          ++iter )
+    {
+        if ( not isCovered( iter.key() ) ) {
+            unregisterWithMaster( iter.key(), -1, 0 );
+        }
+    }
+    auto range_iter = m_ranges.begin();
+    while ( m_ranges.end() != range_iter ) {
+        const Range& range = range_iter.value();
+        if ( ( range.index < subtree.size() ) || not range.root.startsWith( subtree ) ) {
+            ++range_iter;
+            continue;
+        }
+        unregisterWithMaster( range.root, range.index, range.upper );
+        range_iter = m_ranges.erase( range_iter );
+    }
+
+    m_subtrees.append( subtree );
+    qDebug() << "Subtree " << oid_text << " has been successfully registered";
+    return true;
+}
+
+bool QtSnmpSubagent::unregisterSnmpSubtree( const QString& oid_text ) {
+    bool ok;
+    const QtSnmpOid subtree = QtSnmpOid::fromString( oid_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse OID " << oid_text;
+        return false;
+    }
+
+    QWriteLocker locker( &m_lock );
+    const bool is_subtree = m_subtrees.contains( subtree );
+    if ( is_subtree ) {
+        if ( not unregisterWithMaster( subtree, -1, 0 ) ) {
+            qWarning() << "Could not unregister subtree: " << oid_text;
+            return false;
+        }
+        m_subtrees.removeAll( subtree );
+    }
+
+    // objects served by ranges are unregistered together with the ranges
+    int objects_count = 0;
+    auto iter = m_parameters.lowerBound( subtree );
+    while ( ( m_parameters.end() != iter ) && iter.key().startsWith( subtree ) ) {
+        if ( not is_subtree && not isCovered( iter.key() ) ) {
+            unregisterWithMaster( iter.key(), -1, 0 );
+        }
+        iter = m_parameters.erase( iter );
+        ++objects_count;
+    }
+
+    int ranges_count = 0;
+    auto range_iter = m_ranges.begin();
+    while ( m_ranges.end() != range_iter ) {
+        const Range& range = range_iter.value();
+        if ( ( range.index < subtree.size() ) || not range.root.startsWith( subtree ) ) {
+            ++range_iter;
+            continue;
+        }
+        unregisterWithMaster( range.root, range.index, range.upper );
+        range_iter = m_ranges.erase( range_iter );
+        ++ranges_count;
+    }
+
+    auto table_iter = m_tables.lowerBound( subtree );
+    while ( ( m_tables.end() != table_iter ) && table_iter.key().startsWith( subtree ) ) {
+        unregisterWithMaster( table_iter.key(), -1, 0 );
+        table_iter = m_tables.erase( table_iter );
+        ++objects_count;
+    }
+
+    if ( not is_subtree && ( 0 == ranges_count ) && ( 0 == objects_count ) ) {
+        qWarning() << "Nothing is registered below " << oid_text;
+        return false;
+    }
+
+    qDebug() << "Subtree " << oid_text << " has been successfuly unregistred";
+    return true;
+}
+
+bool QtSnmpSubagent::isCovered( const QtSnmpOid& key ) const {
+    for ( const auto& subtree : m_subtrees ) {
+        if ( key.startsWith( subtree ) ) {
+            return true;
+        }
+    }
+
+    if ( not m_ranges.isEmpty() ) {
+        for ( int index = 0; index < key.size(); ++index ) {
+            const auto iter = m_ranges.constFind( rangePattern( key, index ) );
+            if ( ( m_ranges.constEnd() != iter )
+                 && ( iter->root.at( index ) <= key.at( index ) )
+                 && ( key.at( index ) <= iter->upper ) )
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool QtSnmpSubagent::findObject( const QtSnmpOid& start,
+                                 const bool is_next,
+                                 const bool include,
+                                 const QtSnmpOid& end,
+                                 const bool is_request,
+                                 QtSnmpOid*const key,
+                                 QSharedPointer< QtSnmpValue >*const value,
+                                 QtSnmpTable::Cell*const cell,
+                                 bool*const is_async )
+{
+    QReadLocker locker( &m_lock );
+    auto iter = m_parameters.constFind( start );
+    if ( is_next ) {
+        iter = include ? m_parameters.lowerBound( start ) : m_parameters.upperBound( start );
+    }
+    const bool has_parameter = ( m_parameters.constEnd() != iter )
+                               && not ( is_next && not end.isEmpty() && not ( iter.key() < end ) );
+
+    QtSnmpOid cell_key;
+    if ( findTableCell( start, is_next, include, end, &cell_key, cell )
+         && ( not has_parameter || ( cell_key < iter.key() ) ) )
+    {
+        if ( is_request && m_is_instrumented.load() ) {
+            m_statistics.countGet();
+        }
+        *key = cell_key;
+        value->clear();
+        *is_async = false;
+        return true;
+    }
+    if ( not has_parameter ) {
+        return false;
+    }
+
+    // the provider is called without the lock, it may use the subagent itself
+    if ( isStale( iter->provider ) ) {
+        const QSharedPointer< ProviderGroup > provider = iter->provider;
+        locker.unlock();
+        refreshProvider( provider );
+        return findObject( start, is_next, include, end, is_request, key, value, cell, is_async );
+    }
+
+    if ( is_request ) {
+        countGet( *iter );
+    }
+    *key = iter.key();
+    *value = iter->value;
+    *is_async = ( iter->async_timeout >= 0 );
+    return true;
+}
+
+bool QtSnmpSubagent::registerWithMaster( const QtSnmpOid& root,
+                                         const int range_index,
+                                         const quint32 range_upper,
+                                         const bool is_instance )
+{
+    if ( not m_initialized ) {
+        // the registry is registered as a whole by start()
+        return true;
+    }
+    if ( BackendAgentX == m_backend ) {
+        // the registry is registered as a whole once the session is open
+        if ( m_agentx ) {
+            m_agentx->registerSubtree( root, range_index, range_upper, is_instance );
+        }
+        return true;
+    }
+    if ( QThread::currentThread() != thread() ) {
+        // a failure is reported by the agent thread
+        m_statistics.enqueue();
+        QCoreApplication::postEvent( this, new MasterRegistrationEvent( root, range_index, range_upper, is_instance, true ) );
+        return true;
+    }
+
+    oid oid_array[ MAX_OID_LEN ];
+    const size_t oid_size = toNetSnmpOid( root, oid_array );
+    if ( 0 == oid_size ) {
+        return false;
+    }
+    auto handler = netsnmp_create_handler_registration(
+                       qPrintable( root.toString() ),
+                       is_instance ? delayed_instance_handler : subtree_handler,
+                       oid_array,
+                       oid_size,
+                       HANDLER_CAN_RWRITE );
+    if ( is_instance ) {
+        return ( MIB_REGISTERED_OK == netsnmp_register_instance( handler ) );
+    }
+    if ( range_index >= 0 ) {
+        handler->range_subid = range_index + 1;
+        handler->range_ubound = range_upper;
+    }
+    return ( MIB_REGISTERED_OK == netsnmp_register_handler( handler ) );
+}
+
+bool QtSnmpSubagent::unregisterWithMaster( const QtSnmpOid& root,
+                                           const int range_index,
+                                           const quint32 range_upper )
+{
+    if ( not m_initialized ) {
+        return true;
+    }
+    if ( BackendAgentX == m_backend ) {
+        if ( m_agentx ) {
+            m_agentx->unregisterSubtree( root, range_index, range_upper );
+        }
+        return true;
+    }
+    if ( QThread::currentThread() != thread() ) {
+        m_statistics.enqueue();
+        QCoreApplication::postEvent( this, new MasterRegistrationEvent( root, range_index, range_upper, false, false ) );
+        return true;
+    }
+
+    oid oid_array[ MAX_OID_LEN ];
+    const size_t oid_size = toNetSnmpOid( root, oid_array );
+    if ( 0 == oid_size ) {
+        return false;
+    }
+    if ( range_index >= 0 ) {
+        return ( MIB_UNREGISTERED_OK == unregister_mib_range( oid_array, oid_size, 0, range_index + 1, range_upper ) );
+    }
+    return ( MIB_UNREGISTERED_OK == unregister_mib( oid_array, oid_size ) );
+}
+
+QtSnmpOid QtSnmpSubagent::rangePattern( const QtSnmpOid& key, const int index ) {
+    QtSnmpOid result = key;
+    result.replace( index, 0 );
+    result.append( static_cast< quint32 >( index ) );
+    return result;
+}
+
+QVariant QtSnmpSubagent::value( const QString& oid ) const {
+    const QtSnmpOid key = QtSnmpOid::fromString( oid );
+    QReadLocker locker( &m_lock );
+    const auto iter = m_parameters.constFind( key );
+    if ( m_parameters.constEnd() == iter ) {
+        return {};
+    }
+
+    return iter->value->value();
+}
+
+void QtSnmpSubagent::setValue( const QString& oid_text, const QVariant& value ) {
+    const QtSnmpOid key = QtSnmpOid::fromString( oid_text );
+    QReadLocker locker( &m_lock );
+    const auto iter = m_parameters.constFind( key );
+    if ( m_parameters.constEnd() == iter ) {
+        qWarning() << "OID" << oid_text << " has not been registred";
+        Q_ASSERT( false );
+        return;
+    }
+
+    if ( not iter->validator->check( value ) ) {
+        qWarning() << "Inappropriate value " << value
+                   << " for OID " << oid_text << " will be ignored.";
+        Q_ASSERT( false );
+        return;
+
+    }
+
+    iter->value->setValue( value );
+}
+
+bool QtSnmpSubagent::findValue( const QString& oid,
+                                QSharedPointer< QtSnmpValue >*const value,
+                                QSharedPointer< const QtSnmpValidator >*const validator ) const
+{
+    const QtSnmpOid key = QtSnmpOid::fromString( oid );
+    QReadLocker locker( &m_lock );
+    const auto iter = m_parameters.constFind( key );
+    if ( m_parameters.constEnd() == iter ) {
+        qWarning() << "OID" << oid << " has not been registred";
+        return false;
+    }
+
+    *value = iter->value;
+    *validator = iter->validator;
+    return true;
+}
+
+void QtSnmpSubagent::setValues( const ValueList& values ) {
+    if ( QThread::currentThread() == thread() ) {
+        applyValues( values );
+    } else {
+        m_statistics.enqueue();
+        QCoreApplication::postEvent( this, new SetValuesEvent( values ) );
+    }
+}
+
+void QtSnmpSubagent::customEvent( QEvent* event ) {
+    if ( ( SetValuesEvent::type() == event->type() )
+         || ( CompleteGetEvent::type() == event->type() )
+         || ( CompleteSetEvent::type() == event->type() )
+         || ( MasterRegistrationEvent::type() == event->type() ) )
+    {
+        m_statistics.dequeue();
+    }
+
+    if ( SetValuesEvent::type() == event->type() ) {
+        applyValues( static_cast< SetValuesEvent* >( event )->values );
+    } else if ( CompleteGetEvent::type() == event->type() ) {
+        const auto complete_event = static_cast< CompleteGetEvent* >( event );
+        finishDelegatedRequest( complete_event->request_id, complete_event->value );
+    } else if ( CompleteSetEvent::type() == event->type() ) {
+        const auto complete_event = static_cast< CompleteSetEvent* >( event );
+        finishSetTransaction( complete_event->transaction_id, complete_event->accepted );
+    } else if ( MasterRegistrationEvent::type() == event->type() ) {
+        const auto registration_event = static_cast< MasterRegistrationEvent* >( event );
+        if ( registration_event->is_registration ) {
+            if ( not registerWithMaster( registration_event->root,
+                                         registration_event->range_index,
+                                         registration_event->range_upper,
+                                         registration_event->is_instance ) )
+            {
+                qWarning() << "unable to register OID " << registration_event->root;
+            }
+        } else if ( not unregisterWithMaster( registration_event->root,
+                                              registration_event->range_index,
+                                              registration_event->range_upper ) )
+        {
+            qWarning() << "Could not unregister OID: " << registration_event->root;
+        }
+    }
+}
+
+void QtSnmpSubagent::applyValues( const ValueList& values ) {
+    QVector< QtSnmpValue* > targets;
+    targets.reserve( values.size() );
+
+    QReadLocker locker( &m_lock );
+    for ( const auto& item : values ) {
+        const auto iter = m_parameters.constFind( QtSnmpOid::fromString( item.first ) );
+        if ( m_parameters.constEnd() == iter ) {
+            qWarning() << "OID" << item.first << " has not been registred, the batch will be ignored";
+            Q_ASSERT( false );
+            return;
+        }
+
+        if ( not iter->validator->check( item.second ) ) {
+            qWarning() << "Inappropriate value " << item.second
+                       << " for OID " << item.first << ", the batch will be ignored";
+            Q_ASSERT( false );
+            return;
+        }
+        targets << iter->value.data();
+    }
+
+    for ( int i = 0; i < values.size(); ++i ) {
+        targets.at( i )->setValue( values.at( i ).second );
+    }
+}
+
+void QtSnmpSubagent::setBackend( const Backend backend ) {
+    if ( m_initialized ) {
+        qWarning() << "The backend could not be changed after start";
+        return;
+    }
+    if ( ( BackendNetSnmp == backend ) && not m_is_default ) {
+        qWarning() << "Only the default subagent could use the net-snmp backend";
+        return;
+    }
+    m_backend = backend;
+}
+
+QtSnmpSubagent::Backend QtSnmpSubagent::backend() const {
+    return m_backend;
+}
+
+void QtSnmpSubagent::setMasterAddress( const QString& address ) {
+    {
+        QMutexLocker locker( &m_settings_mutex );
+        m_master_address = address;
+    }
+    QMetaObject::invokeMethod( this, "applySettings", Qt::QueuedConnection );
+}
+
+QString QtSnmpSubagent::masterAddress() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_master_address;
+}
+
+void QtSnmpSubagent::setApplicationName( const QString& name ) {
+    {
+        QMutexLocker locker( &m_settings_mutex );
+        m_application_name = name;
+    }
+    QMetaObject::invokeMethod( this, "applySettings", Qt::QueuedConnection );
+}
+
+QString QtSnmpSubagent::applicationName() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_application_name;
+}
+
+void QtSnmpSubagent::setTimeout( const int timeout ) {
+    {
+        QMutexLocker locker( &m_settings_mutex );
+        m_timeout = timeout;
+    }
+    QMetaObject::invokeMethod( this, "applySettings", Qt::QueuedConnection );
+}
+
+int QtSnmpSubagent::timeout() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_timeout;
+}
+
+void QtSnmpSubagent::setRetries( const int retries ) {
+    {
+        QMutexLocker locker( &m_settings_mutex );
+        m_retries = retries;
+    }
+    QMetaObject::invokeMethod( this, "applySettings", Qt::QueuedConnection );
+}
+
+int QtSnmpSubagent::retries() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_retries;
+}
+
+void QtSnmpSubagent::setPduTimeLimit( const int limit ) {
+    QMutexLocker locker( &m_settings_mutex );
+    m_pdu_time_limit = limit;
+}
+
+int QtSnmpSubagent::pduTimeLimit() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_pdu_time_limit;
+}
+
+void QtSnmpSubagent::setTransactionTimeout( const int timeout ) {
+    QMutexLocker locker( &m_settings_mutex );
+    m_transaction_timeout = timeout;
+}
+
+int QtSnmpSubagent::transactionTimeout() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_transaction_timeout;
+}
+
+void QtSnmpSubagent::setPrioritySubtrees( const QStringList& oids ) {
+    QVector< QtSnmpOid > subtrees;
+    for ( const auto& oid_text : oids ) {
+        bool ok;
+        const QtSnmpOid subtree = QtSnmpOid::fromString( oid_text, &ok );
+        if ( not ok ) {
+            qWarning() << "Could not parse OID " << oid_text;
+            continue;
+        }
+        subtrees << subtree;
+    }
+    QMutexLocker locker( &m_settings_mutex );
+    m_priority_subtrees = subtrees;
+}
+
+QVector< QtSnmpOid > QtSnmpSubagent::prioritySubtrees() const {
+    QMutexLocker locker( &m_settings_mutex );
+    return m_priority_subtrees;
+}
+
+QVector< QtSnmpSubagent::RequestStatistics > QtSnmpSubagent::requestStatistics() const {
+    QVector< RequestStatistics > result;
+    for ( int i = 0; i < LimitOfRequestClasses; ++i ) {
+        const RequestCounters& counters = m_request_counters[ i ];
+        RequestStatistics statistics;
+        statistics.queue_depth = static_cast< int >( counters.queue_depth.value() );
+        statistics.max_queue_depth = static_cast< int >( counters.max_queue_depth.value() );
+        statistics.pdus = counters.pdus.value();
+        statistics.total_wait = static_cast< qint64 >( counters.total_wait.value() );
+        statistics.max_wait = static_cast< qint64 >( counters.max_wait.value() );
+        statistics.expired = counters.expired.value();
+        result << statistics;
+    }
+    return result;
+}
+
+void QtSnmpSubagent::applySettings() {
+    if ( not m_initialized ) {
+        return;
+    }
+    if ( not m_agentx ) {
+        qWarning() << "The net-snmp backend applies new settings on the next start only";
+        return;
+    }
+
+    QMutexLocker locker( &m_settings_mutex );
+    // the session is reopened, ready() is emitted again once it is registered
+    setConnectionState( StateConnecting );
+    m_agentx->connectToMaster( m_master_address, m_application_name, m_timeout, m_retries );
+}
+
+void QtSnmpSubagent::start() {
+    if ( QThread::currentThread() != thread() ) {
+        QMetaObject::invokeMethod( this, "start", Qt::QueuedConnection );
+        return;
+    }
+    if ( m_initialized ) {
+        return;
+    }
+    if ( not m_delegated_timer ) {
+        m_delegated_timer = new QTimer( this );
+        m_delegated_timer->setSingleShot( true );
+        connect( m_delegated_timer, SIGNAL( timeout() ),
+                 this, SLOT( expireDelegatedRequests() ) );
+    }
+
+    QMutexLocker settings_locker( &m_settings_mutex );
+    if ( BackendAgentX == m_backend ) {
+        {
+            QWriteLocker locker( &m_lock );
+            m_agentx = new QtSnmpAgentX( this );
+            m_initialized = true;
+        }
+        setConnectionState( StateConnecting );
+        m_agentx->connectToMaster( m_master_address, m_application_name, m_timeout, m_retries );
+        return;
+    }
+
+    const QByteArray master_address = m_master_address.toUtf8();
+    const QByteArray application_name = m_application_name.toUtf8();
+    snmp_enable_stderrlog();
+    netsnmp_ds_set_boolean( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_ROLE, 1 );
+    // alarms (AgentX pings, reconnects) are reported through snmp_select_info() instead of SIGALRM
+    netsnmp_ds_set_boolean( NETSNMP_DS_LIBRARY_ID, NETSNMP_DS_LIB_ALARM_DONT_USE_SIG, 1 );
+    netsnmp_ds_set_string( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_X_SOCKET, master_address.constData() );
+    if ( m_timeout >= 0 ) {
+        // microseconds
+        netsnmp_ds_set_int( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_AGENTX_TIMEOUT, m_timeout * 1000 );
+    }
+    if ( m_retries >= 0 ) {
+        netsnmp_ds_set_int( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_AGENTX_RETRIES, m_retries );
+    }
+    // seconds, net-snmp reopens a lost session and registers the registry again
+    netsnmp_ds_set_int( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_AGENTX_PING_INTERVAL, ping_interval / 1000 );
+    settings_locker.unlock();
+    setConnectionState( StateConnecting );
+    snmp_register_callback( SNMP_CALLBACK_APPLICATION, SNMPD_CALLBACK_INDEX_START, master_session_callback, this );
+    snmp_register_callback( SNMP_CALLBACK_APPLICATION, SNMPD_CALLBACK_INDEX_STOP, master_session_callback, this );
+    SOCK_STARTUP;
+    init_agent( application_name.constData() );
+    {
+        // registered before init_snmp() opens the session, net-snmp sends them once it is open
+        QWriteLocker locker( &m_lock );
+        m_initialized = true;
+        registerRegistry();
+    }
+    init_snmp( application_name.constData() );
+    snmp_log( LOG_INFO, "%s is up and running.\n", application_name.constData() );
+
+    if ( not m_alarm_timer ) {
+        m_alarm_timer = new QTimer( this );
+        m_alarm_timer->setSingleShot( true );
+        connect( m_alarm_timer, SIGNAL( timeout() ),
+                 this, SLOT( processAgentEvents() ) );
+    }
+
+    processAgentEvents();
+}
+
+void QtSnmpSubagent::stop() {
+    if ( QThread::currentThread() != thread() ) {
+        QMetaObject::invokeMethod( this, "stop", Qt::QueuedConnection );
+        return;
+    }
+    shutdown();
+}
+
+void QtSnmpSubagent::shutdown() {
+    if ( not m_initialized ) {
+        return;
+    }
+
+    // the application will not answer after the session is closed
+    for ( const quint64 request_id : m_delegated.keys() ) {
+        finishDelegatedRequest( request_id, QVariant() );
+    }
+    m_delegated_to_emit.resize( 0 );
+    QList< quint64 > pending_transactions;
+    for ( auto iter = m_transactions.constBegin(); m_transactions.constEnd() != iter; ++iter ) {
+        if ( iter->is_pending ) {
+            pending_transactions << iter.key();
+        }
+    }
+    for ( const quint64 transaction_id : pending_transactions ) {
+        finishSetTransaction( transaction_id, false );
+    }
+    m_transactions.clear();
+    m_delegated_timer->stop();
+
+    if ( m_agentx ) {
+        m_agentx->close();
+        QWriteLocker locker( &m_lock );
+        delete m_agentx;
+        m_agentx = nullptr;
+        m_initialized = false;
+    } else {
+        for ( auto notifier : m_notifiers ) {
+            notifier->setEnabled( false );
+            notifier->deleteLater();
+        }
+        m_notifiers.clear();
+        m_alarm_timer->stop();
+
+        QWriteLocker locker( &m_lock );
+        snmp_unregister_callback( SNMP_CALLBACK_APPLICATION, SNMPD_CALLBACK_INDEX_START, master_session_callback, this, 1 );
+        snmp_unregister_callback( SNMP_CALLBACK_APPLICATION, SNMPD_CALLBACK_INDEX_STOP, master_session_callback, this, 1 );
+        shutdown_agent();
+        snmp_shutdown( qPrintable( applicationName() ) );
+        SOCK_CLEANUP;
+        m_initialized = false;
+    }
+    setConnectionState( StateStopped );
+}
+
+QtSnmpSubagent::ConnectionState QtSnmpSubagent::connectionState() const {
+    return static_cast< ConnectionState >( m_connection_state.load() );
+}
+
+void QtSnmpSubagent::setInstrumentation( const bool enabled ) {
+    QWriteLocker locker( &m_lock );
+    if ( enabled ) {
+        for ( auto& parameter : m_parameters ) {
+            if ( parameter.counters.isNull() ) {
+                parameter.counters = QSharedPointer< ObjectCounters >::create();
+            }
+        }
+    }
+    m_is_instrumented.store( enabled ? 1 : 0 );
+}
+
+bool QtSnmpSubagent::isInstrumented() const {
+    return m_is_instrumented.load();
+}
+
+const QtSnmpStatistics& QtSnmpSubagent::statistics() const {
+    return m_statistics;
+}
+
+QMap< QString, QtSnmpSubagent::ObjectStatistics > QtSnmpSubagent::objectStatistics() const {
+    QMap< QString, ObjectStatistics > result;
+    QReadLocker locker( &m_lock );
+    for ( auto iter = m_parameters.constBegin(); m_parameters.constEnd() != iter; ++iter ) {
+        if ( iter->counters.isNull() ) {
+            continue;
+        }
+        const ObjectCounters& counters = *iter->counters;
+        ObjectStatistics statistics;
+        statistics.get_requests = counters.get_requests.value();
+        statistics.set_requests = counters.set_requests.value();
+        statistics.rejected_sets = counters.rejected_sets.value();
+        if ( statistics.get_requests || statistics.set_requests || statistics.rejected_sets ) {
+            result.insert( iter.key().toString(), statistics );
+        }
+    }
+    return result;
+}
+
+bool QtSnmpSubagent::registerSnmpStatistics( const QString& oid_text ) {
+    bool ok;
+    QtSnmpOid::fromString( oid_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse OID " << oid_text;
+        return false;
+    }
+
+    const QVariant zero = QVariant::fromValue( 0u );
+    ObjectList objects;
+    for ( int index = 1; index <= 6; ++index ) {
+        const auto type = ( index < 5 ) ? QtSnmpObjectDescription::TypeCounter64
+                                        : QtSnmpObjectDescription::TypeGauge;
+        QtSnmpObjectDescription description( QString( "%1.%2.0" ).arg( oid_text ).arg( index ), type );
+        description.setReadOnly( true );
+        objects << qMakePair( description, zero );
+    }
+    for ( int bucket = 0; bucket < QtSnmpStatistics::LatencyBuckets; ++bucket ) {
+        QtSnmpObjectDescription description( QString( "%1.7.%2.0" ).arg( oid_text ).arg( bucket + 1 ),
+                                             QtSnmpObjectDescription::TypeCounter64 );
+        description.setReadOnly( true );
+        objects << qMakePair( description, zero );
+    }
+
+    const auto provider = [ this ]( ValueList& values ) {
+        const QtSnmpStatistics& statistics = m_statistics;
+        QVector< quint64 > counters;
+        counters << statistics.getRequests()
+                 << statistics.setRequests()
+                 << statistics.rejectedSets()
+                 << statistics.pdus()
+                 << static_cast< quint64 >( statistics.queueDepth() )
+                 << static_cast< quint64 >( statistics.maxQueueDepth() );
+        for ( int bucket = 0; bucket < QtSnmpStatistics::LatencyBuckets; ++bucket ) {
+            counters << statistics.latency( bucket );
+        }
+        for ( int i = 0; ( i < values.size() ) && ( i < counters.size() ); ++i ) {
+            values[ i ].second = QVariant::fromValue( static_cast< qulonglong >( counters.at( i ) ) );
+        }
+    };
+    if ( not registerSnmpProvider( objects, provider, statistics_ttl ) ) {
+        return false;
+    }
+    setInstrumentation( true );
+    return true;
+}
+
+QtSnmpSubagent::SessionStatistics QtSnmpSubagent::sessionStatistics() const {
+    QMutexLocker locker( &m_statistics_mutex );
+    return m_session_statistics;
+}
+
+bool QtSnmpSubagent::sendNotification( const QString& oid_text, const QStringList& objects ) {
+    bool ok;
+    Notification notification;
+    notification.oid = QtSnmpOid::fromString( oid_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse OID " << oid_text;
+        return false;
+    }
+    notification.objects.reserve( objects.size() );
+    for ( const auto& object : objects ) {
+        notification.objects << QtSnmpOid::fromString( object, &ok );
+        if ( not ok ) {
+            qWarning() << "Could not parse OID " << object;
+            return false;
+        }
+    }
+
+    QMutexLocker locker( &m_notifications_mutex );
+    for ( const auto& queued : m_notifications ) {
+        if ( ( queued.oid == notification.oid ) && ( queued.objects == notification.objects ) ) {
+            ++m_notification_statistics.coalesced;
+            return true;
+        }
+    }
+    if ( m_notifications.size() >= notification_queue_limit ) {
+        ++m_notification_statistics.dropped;
+        qWarning() << "Notification " << oid_text << " has been dropped, the queue is full";
+        return false;
+    }
+
+    m_notifications << notification;
+    m_notification_statistics.queue_depth = m_notifications.size();
+    m_notification_statistics.max_queue_depth = qMax( m_notification_statistics.max_queue_depth,
+                                                      m_notification_statistics.queue_depth );
+    if ( 1 == m_notifications.size() ) {
+        QMetaObject::invokeMethod( this, "scheduleNotifications", Qt::QueuedConnection );
+    }
+    return true;
+}
+
+void QtSnmpSubagent::setNotificationWindow( const int window ) {
+    QMutexLocker locker( &m_notifications_mutex );
+    m_notification_window = qMax( window, 0 );
+}
+
+int QtSnmpSubagent::notificationWindow() const {
+    QMutexLocker locker( &m_notifications_mutex );
+    return m_notification_window;
+}
+
+void QtSnmpSubagent::setNotificationRateLimit( const double rate, const int burst ) {
+    QMutexLocker locker( &m_notifications_mutex );
+    m_notification_rate = rate;
+    m_notification_burst = qMax( burst, 1 );
+}
+
+QtSnmpSubagent::NotificationStatistics QtSnmpSubagent::notificationStatistics() const {
+    QMutexLocker locker( &m_notifications_mutex );
+    return m_notification_statistics;
+}
+
+void QtSnmpSubagent::scheduleNotifications() {
+    if ( not m_notification_timer ) {
+        m_notification_timer = new QTimer( this );
+        m_notification_timer->setSingleShot( true );
+        connect( m_notification_timer, SIGNAL( timeout() ),
+                 this, SLOT( flushNotifications() ) );
+    }
+    if ( not m_notification_timer->isActive() ) {
+        m_notification_timer->start( notificationWindow() );
+    }
+}
+
+void QtSnmpSubagent::flushNotifications() {
+    // the queue is kept until the session opens
+    if ( StateConnected != connectionState() ) {
+        return;
+    }
+
+    QVector< Notification > notifications;
+    double rate;
+    double burst;
+    {
+        QMutexLocker locker( &m_notifications_mutex );
+        notifications.swap( m_notifications );
+        m_notification_statistics.queue_depth = 0;
+        rate = m_notification_rate;
+        burst = m_notification_burst;
+    }
+
+    quint64 sent = 0;
+    quint64 rate_limited = 0;
+    QVector< Notification > unsent;
+    for ( int i = 0; i < notifications.size(); ++i ) {
+        const Notification& notification = notifications.at( i );
+        if ( rate > 0 ) {
+            TokenBucket& bucket = m_token_buckets[ notification.oid ];
+            if ( bucket.refilled.isValid() ) {
+                bucket.tokens = qMin( burst, bucket.tokens + rate * bucket.refilled.restart() / 1000 );
+            } else {
+                bucket.tokens = burst;
+                bucket.refilled.start();
+            }
+            if ( bucket.tokens < 1 ) {
+                ++rate_limited;
+                continue;
+            }
+            bucket.tokens -= 1;
+        }
+
+        VarbindList varbinds;
+        varbinds.reserve( notification.objects.size() );
+        for ( const auto& object : notification.objects ) {
+            QtSnmpOid key;
+            QSharedPointer< QtSnmpValue > value;
+            QtSnmpTable::Cell cell;
+            bool is_async;
+            // the payload of a notification is not a GET of the object
+            if ( findObject( object, false, true, QtSnmpOid(), false, &key, &value, &cell, &is_async ) ) {
+                if ( value.isNull() ) {
+                    value.reset( new QtSnmpValue( cell.type ) );
+                    cell.copyTo( value.data() );
+                }
+                varbinds << qMakePair( key, value );
+            } else {
+                qWarning() << "OID " << object << " of the notification " << notification.oid << " is not registered";
+            }
+        }
+        if ( not sendNotify( notification.oid, varbinds ) ) {
+            // the session has been closed meanwhile, the rest waits for the next one
+            unsent = notifications.mid( i );
+            break;
+        }
+        ++sent;
+    }
+
+    QMutexLocker locker( &m_notifications_mutex );
+    if ( not unsent.isEmpty() ) {
+        unsent << m_notifications;
+        m_notifications = unsent;
+        m_notification_statistics.queue_depth = m_notifications.size();
+    }
+    m_notification_statistics.sent += sent;
+    m_notification_statistics.rate_limited += rate_limited;
+}
+
+bool QtSnmpSubagent::sendNotify( const QtSnmpOid& notification, const VarbindList& varbinds ) {
+    if ( BackendAgentX == m_backend ) {
+        return m_agentx && m_agentx->sendNotification( notification, varbinds );
+    }
+
+    // net-snmp puts sysUpTime.0 in front of the varbinds and sends a Notify PDU to the master
+    netsnmp_variable_list* variables = nullptr;
+    oid oid_array[ MAX_OID_LEN ];
+    size_t size = toNetSnmpOid( notification, oid_array );
+    if ( 0 == size ) {
+        // it can never be sent, it is not kept for the next session either
+        return true;
+    }
+    snmp_varlist_add_variable( &variables,
+                               snmp_trap_oid,
+                               sizeof( snmp_trap_oid ) / sizeof( oid ),
+                               ASN_OBJECT_ID,
+                               oid_array,
+                               size * sizeof( oid ) );
+    for ( const auto& varbind : varbinds ) {
+        size = toNetSnmpOid( varbind.first, oid_array );
+        if ( 0 == size ) {
+            continue;
+        }
+        netsnmp_variable_list*const variable = snmp_varlist_add_variable( &variables,
+                                                                          oid_array,
+                                                                          size,
+                                                                          ASN_NULL,
+                                                                          nullptr,
+                                                                          0 );
+        if ( variable ) {
+            set_variable_value( variable, *varbind.second );
+        }
+    }
+    send_v2trap( variables );
+    snmp_free_varbind( variables );
+    return true;
+}
+
+void QtSnmpSubagent::setConnectionState( const ConnectionState state ) {
+    const auto previous = static_cast< ConnectionState >( m_connection_state.fetchAndStoreOrdered( state ) );
+    if ( state == previous ) {
+        return;
+    }
+
+    if ( StateStopped == state ) {
+        m_session_lost.invalidate();
+    } else if ( StateConnected == previous ) {
+        m_session_lost.start();
+    } else if ( ( StateConnected == state ) && m_session_lost.isValid() ) {
+        QMutexLocker locker( &m_statistics_mutex );
+        ++m_session_statistics.reconnects;
+        m_session_statistics.reconnect_latency = m_session_lost.elapsed();
+        m_session_lost.invalidate();
+    }
+    emit connectionStateChanged( state );
+    if ( StateConnected == state ) {
+        emit ready();
+        // notifications queued while the session was down
+        QMetaObject::invokeMethod( this, "flushNotifications", Qt::QueuedConnection );
+    }
+}
+
+void QtSnmpSubagent::agentCallbackSessionChanged( const bool is_open ) {
+    setConnectionState( is_open ? StateConnected : StateDisconnected );
+}
+
+void QtSnmpSubagent::registerRegistry() {
+    for ( const auto& subtree : m_subtrees ) {
+        if ( not registerWithMaster( subtree, -1, 0, false ) ) {
+            qWarning() << "unable to register subtree " << subtree;
+        }
+    }
+    for ( const auto& range : m_ranges ) {
+        if ( not registerWithMaster( range.root, range.index, range.upper, false ) ) {
+            qWarning() << "unable to register OID range " << range.root;
+        }
+    }
+    for ( auto iter = m_tables.constBegin(); m_tables.constEnd() != iter; ++iter ) {
+        if ( not registerWithMaster( iter.key(), -1, 0, false ) ) {
+            qWarning() << "unable to register table " << iter.key();
+        }
+    }
+    for ( auto iter = m_parameters.constBegin(); m_parameters.constEnd() != iter; ++iter ) {
+        if ( not isCovered( iter.key() ) && not registerWithMaster( iter.key(), -1, 0, true ) ) {
+            qWarning() << "unable to register OID " << iter.key();
+        }
+    }
+}
+
+int QtSnmpSubagent::agentCallbackGetValue( void*const pointer_to_request, const QtSnmpOid& key ) {
+    QReadLocker locker( &m_lock );
+    auto iter = m_parameters.constFind( key );
+    if ( m_parameters.constEnd() == iter ) {
+        QtSnmpOid cell_key;
+        QtSnmpTable::Cell cell;
+        if ( not findTableCell( key, false, true, QtSnmpOid(), &cell_key, &cell ) ) {
+            return SNMP_ERR_NOSUCHNAME;
+        }
+        if ( m_is_instrumented.load() ) {
+            m_statistics.countGet();
+        }
+        QtSnmpValue cell_value( cell.type );
+        cell.copyTo( &cell_value );
+        setVariableValue( pointer_to_request, cell_value );
+        return SNMP_ERR_NOERROR;
+    }
+
+    if ( iter->async_timeout >= 0 ) {
+        return AgentRequestDelegated;
+    }
+
+    // the provider is called without the lock, it may use the subagent itself
+    if ( isStale( iter->provider ) ) {
+        const QSharedPointer< ProviderGroup > provider = iter->provider;
+        locker.unlock();
+        refreshProvider( provider );
+        locker.relock();
+        iter = m_parameters.constFind( key );
+        if ( m_parameters.constEnd() == iter ) {
+            return SNMP_ERR_NOSUCHNAME;
+        }
+    }
+
+    countGet( *iter );
+    setVariableValue( pointer_to_request, *iter->value );
+    return SNMP_ERR_NOERROR;
+}
+
+int QtSnmpSubagent::agentCallbackGetNextValue( void*const pointer_to_request,
+                                               const QtSnmpOid& key,
+                                               const QtSnmpOid& root,
+                                               const int range_index,
+                                               const quint32 range_upper )
+{
+    auto request  = static_cast< netsnmp_request_info* >( pointer_to_request );
+    QReadLocker locker( &m_lock );
+    const auto& parameters = m_parameters;
+
+    const auto table_iter = m_tables.constFind( root );
+    if ( m_tables.constEnd() != table_iter ) {
+        QtSnmpOid cell_key;
+        QtSnmpTable::Cell cell;
+        if ( table_iter.value()->findCell( key, true, false, QtSnmpOid(), &cell_key, &cell ) ) {
+            if ( m_is_instrumented.load() ) {
+                m_statistics.countGet();
+            }
+            oid oid_array[ MAX_OID_LEN ];
+            const size_t oid_size = toNetSnmpOid( cell_key, oid_array );
+            if ( 0 == oid_size ) {
+                return SNMP_ERR_GENERR;
+            }
+            snmp_set_var_objid( request->requestvb, oid_array, oid_size );
+            QtSnmpValue cell_value( cell.type );
+            cell.copyTo( &cell_value );
+            setVariableValue( pointer_to_request, cell_value );
+        }
+        return SNMP_ERR_NOERROR;
+    }
+
+    // a range registration serves one subtree per value of the sub-identifier at range_index
+    QtSnmpOid subtree = root;
+    quint32 part = ( range_index < 0 ) ? 0 : root.at( range_index );
+    const quint32 last_part = ( range_index < 0 ) ? 0 : range_upper;
+    if ( ( range_index >= 0 ) && ( key.size() > range_index ) && ( key.at( range_index ) > part ) ) {
+        bool is_same_prefix = true;
+        for ( int i = 0; is_same_prefix && ( i < range_index ); ++i ) {
+            is_same_prefix = ( key.at( i ) == root.at( i ) );
+        }
+        if ( is_same_prefix ) {
+            part = key.at( range_index );
+        }
+    }
+
+    for ( ; part <= last_part; ++part ) {
+        if ( range_index >= 0 ) {
+            subtree.replace( range_index, part );
+        }
+
+        const auto iter = ( key < subtree ) ? parameters.lowerBound( subtree )
+                                            : parameters.upperBound( key );
+        if ( ( parameters.constEnd() != iter ) && iter.key().startsWith( subtree ) ) {
+            if ( isStale( iter->provider ) ) {
+                const QSharedPointer< ProviderGroup > provider = iter->provider;
+                locker.unlock();
+                refreshProvider( provider );
+                return agentCallbackGetNextValue( pointer_to_request, key, root, range_index, range_upper );
+            }
+
+            oid oid_array[ MAX_OID_LEN ];
+            const size_t oid_size = toNetSnmpOid( iter.key(), oid_array );
+            if ( 0 == oid_size ) {
+                return SNMP_ERR_GENERR;
+            }
+            snmp_set_var_objid( request->requestvb, oid_array, oid_size );
+            if ( iter->async_timeout >= 0 ) {
+                return AgentRequestDelegated;
+            }
+            countGet( *iter );
+            setVariableValue( pointer_to_request, *iter->value );
+            return SNMP_ERR_NOERROR;
+        }
+
+        if ( part == last_part ) {
+            break;
+        }
+    }
+
+    // an untouched varbind makes the agent continue with the next registration
+    return SNMP_ERR_NOERROR;
+}
 
-    return true;
+void QtSnmpSubagent::agentDelegateGetRequest( void*const cache, const QtSnmpOid& key ) {
+    // emitted by emitDelegatedRequests() once net-snmp has returned, a receiver may answer at once
+    m_delegated_to_emit << qMakePair( startDelegatedRequest( cache, key ), key );
 }
 
-bool QtSnmpSubagent::unregisterSnmpObject( const QString& oid_text ) {
-    auto iter = m_parameters.find( oid_text );
-    if ( m_parameters.end() == iter ) {
-        qWarning() << "OID " << oid_text << " is not registered";
-        return false;
+void QtSnmpSubagent::emitDelegatedRequests() {
+    const auto delegated_to_emit = m_delegated_to_emit;
+    m_delegated_to_emit.resize( 0 );
+    for ( const auto& item : delegated_to_emit ) {
+        emit snmpGetRequest( item.second.toString(), item.first );
     }
+}
 
-    bool ok;
-    QList< oid > oid_list;
-    for ( const auto& part : oid_text.split( ".", QString::SkipEmptyParts ) ) {
-        oid_list << part.toULong( &ok );
-        if ( not ok ) {
-            qWarning() << "Could not parse OID: " << oid_text;
-            return false;
+quint64 QtSnmpSubagent::startDelegatedRequest( void*const cache, const QtSnmpOid& key ) {
+    int timeout = 0;
+    {
+        QReadLocker locker( &m_lock );
+        const auto iter = m_parameters.constFind( key );
+        if ( m_parameters.constEnd() != iter ) {
+            timeout = iter->async_timeout;
         }
     }
 
-    const auto size = static_cast< size_t >( oid_list.size() );
-    auto oid_array = new oid[ size ];
-    for ( int i = 0; i < oid_list.count(); ++i ) {
-        oid_array[i] = oid_list.at( i );
-    }
-    const int res = unregister_mib( oid_array, size );
-    delete [] oid_array;
-
-    if ( MIB_UNREGISTERED_OK != res ) {
-        qWarning() << "Could not unregister OID: " << oid_text;
-        return false;
+    const quint64 request_id = ++m_last_request_id;
+    DelegatedRequest delegated;
+    delegated.cache = cache;
+    delegated.oid = key;
+    delegated.started.start();
+    delegated.timeout = timeout;
+    m_delegated.insert( request_id, delegated );
+    if ( not m_delegated_timer->isActive() || ( m_delegated_timer->remainingTime() > timeout ) ) {
+        m_delegated_timer->start( timeout );
     }
-
-    m_parameters.remove( oid_text );
-    qDebug() << "OID " << oid_text << " has been successfuly unregistred";
-    return true;
+    return request_id;
 }
 
-QVariant QtSnmpSubagent::value( const QString& oid ) const {
-    if ( not m_initialized ) {
-        return {};
+void QtSnmpSubagent::completeGetRequest( const quint64 request_id, const QVariant& value ) {
+    if ( QThread::currentThread() == thread() ) {
+        finishDelegatedRequest( request_id, value );
+    } else {
+        m_statistics.enqueue();
+        QCoreApplication::postEvent( this, new CompleteGetEvent( request_id, value ) );
     }
+}
 
-    const auto iter = m_parameters.constFind( oid );
-    if ( m_parameters.constEnd() == iter ) {
-        return {};
+void QtSnmpSubagent::finishDelegatedRequest( const quint64 request_id, const QVariant& value ) {
+    const auto delegated_iter = m_delegated.find( request_id );
+    if ( m_delegated.end() == delegated_iter ) {
+        qWarning() << "GET request " << request_id << " has expired or does not exist";
+        return;
     }
+    const DelegatedRequest delegated = *delegated_iter;
+    m_delegated.erase( delegated_iter );
 
-    return iter->value;
-}
-
-void QtSnmpSubagent::setValue( const QString& oid_text, const QVariant& value ) {
-    auto iter = m_parameters.find( oid_text );
-    if ( m_parameters.end() == iter ) {
-        qWarning() << "OID" << oid_text << " has not been registred";
-        Q_ASSERT( false );
+    if ( not delegated.cache ) {
+        bool is_set = false;
+        {
+            QReadLocker locker( &m_lock );
+            const auto iter = m_parameters.constFind( delegated.oid );
+            if ( ( m_parameters.constEnd() != iter ) && value.isValid() ) {
+                is_set = iter->validator->check( value );
+                if ( is_set ) {
+                    iter->value->setValue( value );
+                } else {
+                    qWarning() << "Inappropriate value " << value
+                               << " for OID " << delegated.oid << ", genErr will be returned";
+                }
+            }
+        }
+        if ( m_agentx ) {
+            m_agentx->finishDelegatedRequest( request_id, is_set );
+        }
         return;
     }
 
-    if ( not iter->description.checkValue( value ) ) {
-        qWarning() << "Inappropriate value " << value
-                   << " for OID " << oid_text << " will be ignored.";
-        Q_ASSERT( false );
+    // the cache is gone if the master has dropped the PDU meanwhile
+    auto cache = netsnmp_handler_check_cache( static_cast< netsnmp_delegated_cache* >( delegated.cache ) );
+    if ( not cache ) {
+        qWarning() << "GET request " << request_id << " has been dropped by the master";
         return;
+    }
 
+    netsnmp_request_info*const request = cache->requests;
+    int res = SNMP_ERR_GENERR;
+    {
+        QReadLocker locker( &m_lock );
+        const auto iter = m_parameters.constFind( delegated.oid );
+        if ( m_parameters.constEnd() == iter ) {
+            res = SNMP_NOSUCHINSTANCE;
+        } else if ( value.isValid() ) {
+            if ( iter->validator->check( value ) ) {
+                iter->value->setValue( value );
+                setVariableValue( request, *iter->value );
+                res = SNMP_ERR_NOERROR;
+            } else {
+                qWarning() << "Inappropriate value " << value
+                           << " for OID " << delegated.oid << ", genErr will be returned";
+            }
+        }
+    }
+    if ( SNMP_ERR_NOERROR != res ) {
+        netsnmp_set_request_error( cache->reqinfo, request, res );
     }
+    request->delegated = 0;
+    netsnmp_free_delegated_cache( cache );
 
-    iter->value = value;
+    // sends the response once no request of the PDU is delegated, without reading new PDUs
+    netsnmp_check_outstanding_agent_requests();
 }
 
-void QtSnmpSubagent::start() {
-    snmp_enable_stderrlog();
-    netsnmp_ds_set_boolean( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_ROLE, 1 );
-    netsnmp_ds_set_string( NETSNMP_DS_APPLICATION_ID, NETSNMP_DS_AGENT_X_SOCKET, "tcp:localhost:705" );
-    SOCK_STARTUP;
-    init_agent( "lemz-ads-b-subagent" );
-    init_snmp( "lemz-ads-b-subagent" );
-    snmp_log( LOG_INFO, "lemz-ads-b-subagent is up and running.\n" );
-    agent_check_and_process( 0 );
-    startTimer( 100 );
-    m_initialized = true;
-}
+void QtSnmpSubagent::expireDelegatedRequests() {
+    QList< quint64 > expired;
+    for ( auto iter = m_delegated.constBegin(); m_delegated.constEnd() != iter; ++iter ) {
+        if ( iter->started.elapsed() >= iter->timeout ) {
+            expired << iter.key();
+        }
+    }
+    for ( const quint64 request_id : expired ) {
+        qWarning() << "GET request " << request_id << " has timed out";
+        finishDelegatedRequest( request_id, QVariant() );
+    }
 
-int QtSnmpSubagent::agentCallbackGetValue( void*const pointer_to_request, const QString& oid_text ) {
-    auto request  = static_cast< netsnmp_request_info* >( pointer_to_request );
-    auto iter = m_parameters.constFind( oid_text );
-    if ( m_parameters.constEnd() == iter ) {
-        return SNMP_ERR_NOSUCHNAME;
+    QList< quint64 > expired_transactions;
+    for ( auto iter = m_transactions.constBegin(); m_transactions.constEnd() != iter; ++iter ) {
+        if ( iter->is_pending && ( iter->started.elapsed() >= iter->timeout ) ) {
+            expired_transactions << iter.key();
+        }
+    }
+    for ( const quint64 transaction_id : expired_transactions ) {
+        qWarning() << "SET transaction " << transaction_id << " has timed out";
+        finishSetTransaction( transaction_id, false );
     }
 
-    switch ( iter->description.type() ) {
-    case QtSnmpObjectDescription::TypeEnum:
-    case QtSnmpObjectDescription::TypeInterger:
-        {
-            bool ok;
-            const long int_value = iter->value.toInt( &ok );
-            Q_ASSERT( ok );
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_INTEGER,
-                                      &int_value,
-                                      sizeof( int_value ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeUnsigned:
-        {
-            bool ok;
-            const long int_value = iter->value.toInt( &ok );
-            Q_ASSERT( ok );
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_UNSIGNED,
-                                      &int_value,
-                                      sizeof( int_value ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeCounter:
-        {
-            bool ok;
-            const long int_value = iter->value.toInt( &ok );
-            Q_ASSERT( ok );
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_COUNTER,
-                                      &int_value,
-                                      sizeof( int_value ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeGauge:
-        {
-            bool ok;
-            const long int_value = iter->value.toInt( &ok );
-            Q_ASSERT( ok );
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_GAUGE,
-                                      &int_value,
-                                      sizeof( int_value ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeReal:
-        {
-            bool ok;
-            const double value = iter->value.toDouble( &ok );
-            Q_ASSERT( ok );
-            const QString text_value = QString::number( value, 'g', 9 );
-            const QByteArray ba_value = text_value.toLocal8Bit();
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_OCTET_STR,
-                                      ba_value.constData(),
-                                      static_cast< size_t >( ba_value.size() ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeIpAddress:
-        {
-            const QHostAddress address( iter->value.toString() );
-            QByteArray ba_value;
-            QDataStream stream( &ba_value, QIODevice::WriteOnly );
-            stream.setVersion( QDataStream::Qt_4_5 );
-            stream << address.toIPv4Address();
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_IPADDRESS,
-                                      ba_value.constData(),
-                                      static_cast< size_t >( ba_value.size() ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeTimeTicks:
-        {
-            bool ok;
-            const long int_value = iter->value.toInt( &ok );
-            Q_ASSERT( ok );
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_TIMETICKS,
-                                      &int_value,
-                                      sizeof( int_value ) );
-        }
-        break;
-    case QtSnmpObjectDescription::TypeString:
-        {
-            const QByteArray ba_value = iter->value.toString().toLocal8Bit();
-            snmp_set_var_typed_value( request->requestvb,
-                                      ASN_OCTET_STR,
-                                      ba_value.constData(),
-                                      static_cast< size_t >( ba_value.size() ) );
+    qint64 next_timeout = -1;
+    for ( const auto& delegated : m_delegated ) {
+        const qint64 remaining = qMax( delegated.timeout - delegated.started.elapsed(), qint64( 0 ) );
+        if ( ( next_timeout < 0 ) || ( remaining < next_timeout ) ) {
+            next_timeout = remaining;
+        }
+    }
+    for ( const auto& transaction : m_transactions ) {
+        if ( not transaction.is_pending ) {
+            continue;
+        }
+        const qint64 remaining = qMax( transaction.timeout - transaction.started.elapsed(), qint64( 0 ) );
+        if ( ( next_timeout < 0 ) || ( remaining < next_timeout ) ) {
+            next_timeout = remaining;
         }
-        break;
-    default:
-        qWarning() << Q_FUNC_INFO << "unsupported type:"
-                   << static_cast< int >( iter->description.type() )
-                   << " (" << oid_text << ")";
-        break;
     }
+    if ( next_timeout >= 0 ) {
+        m_delegated_timer->start( static_cast< int >( next_timeout ) );
+    }
+}
 
-    return SNMP_ERR_NOERROR;
+void QtSnmpSubagent::setVariableValue( void*const pointer_to_request, const QtSnmpValue& value ) {
+    set_variable_value( static_cast< netsnmp_request_info* >( pointer_to_request )->requestvb, value );
 }
 
-int QtSnmpSubagent::agentCallbackCheckTypeAndLen( void*const pointer_to_request, const QString& oid_text ) {
-    QHash< QString, Parameter >::const_iterator iter = m_parameters.constFind( oid_text );
+int QtSnmpSubagent::agentCallbackCheckTypeAndLen( void*const pointer_to_request, const QtSnmpOid& key ) {
+    QReadLocker locker( &m_lock );
+    QMap< QtSnmpOid, Parameter >::const_iterator iter = m_parameters.constFind( key );
     if ( m_parameters.constEnd() != iter ) {
         netsnmp_request_info*const request  = static_cast< netsnmp_request_info* >( pointer_to_request );
 
-        if ( iter->description.isReadOnly() ) {
+        if ( iter->is_read_only ) {
             return SNMP_ERR_READONLY;
         }
 
-        switch ( iter->description.type() ) {
+        switch ( iter->type() ) {
         case QtSnmpObjectDescription::TypeEnum:
         case QtSnmpObjectDescription::TypeInterger:
             return netsnmp_check_vb_type_and_size(
@@ -362,6 +2107,21 @@ int QtSnmpSubagent::agentCallbackCheckTypeAndLen( void*const pointer_to_request,
                         request->requestvb,
                         ASN_GAUGE,
                         request->requestvb->val_len );
+        case QtSnmpObjectDescription::TypeCounter64:
+            return netsnmp_check_vb_type_and_size(
+                        request->requestvb,
+                        ASN_COUNTER64,
+                        sizeof( struct counter64 ) );
+        case QtSnmpObjectDescription::TypeFloat:
+            return netsnmp_check_vb_type_and_size(
+                        request->requestvb,
+                        ASN_OPAQUE_FLOAT,
+                        sizeof( float ) );
+        case QtSnmpObjectDescription::TypeDouble:
+            return netsnmp_check_vb_type_and_size(
+                        request->requestvb,
+                        ASN_OPAQUE_DOUBLE,
+                        sizeof( double ) );
         case QtSnmpObjectDescription::TypeReal:
             return netsnmp_check_vb_type_and_size(
                         request->requestvb,
@@ -384,164 +2144,408 @@ int QtSnmpSubagent::agentCallbackCheckTypeAndLen( void*const pointer_to_request,
                         request->requestvb->val_len );
         default:
             qWarning() << Q_FUNC_INFO << "unsupported type:"
-                       << static_cast< int >( iter->description.type() )
-                       << " (" << oid_text << ")";
+                       << static_cast< int >( iter->type() )
+                       << " (" << key << ")";
             break;
         }
         return SNMP_ERR_GENERR;
     }
-    return SNMP_ERR_NOSUCHNAME;
+    // table cells are written by the application only
+    return isTableCell( key ) ? SNMP_ERR_NOTWRITABLE : SNMP_ERR_NOSUCHNAME;
 }
 
-int QtSnmpSubagent::agentCallbackCheckValue( void*const pointer_to_request, const QString& oid_text ) {
+int QtSnmpSubagent::agentCallbackCheckValue( void*const pointer_to_request, const QtSnmpOid& key ) {
     bool res = false;
-    QHash< QString, Parameter >::const_iterator iter = m_parameters.constFind( oid_text );
+    QReadLocker locker( &m_lock );
+    QMap< QtSnmpOid, Parameter >::const_iterator iter = m_parameters.constFind( key );
     if ( m_parameters.constEnd() != iter ) {
         netsnmp_request_info*const request  = static_cast< netsnmp_request_info* >( pointer_to_request );
-        switch ( iter->description.type() ) {
+        const QtSnmpValidator& validator = *iter->validator;
+        switch ( validator.type() ) {
         case QtSnmpObjectDescription::TypeEnum:
         case QtSnmpObjectDescription::TypeInterger:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                res = iter->description.checkValue( QVariant::fromValue( static_cast< int >( value ) ) );
-            }
+            res = validator.checkInteger( *request->requestvb->val.integer );
             break;
         case QtSnmpObjectDescription::TypeUnsigned:
         case QtSnmpObjectDescription::TypeCounter:
         case QtSnmpObjectDescription::TypeGauge:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                res = iter->description.checkValue( QVariant::fromValue( static_cast< unsigned >( value ) ) );
-            }
+            res = validator.checkUnsigned( static_cast< unsigned long >( *request->requestvb->val.integer ) );
+            break;
+        case QtSnmpObjectDescription::TypeCounter64:
+            res = validator.checkUnsigned( counter64_value( request->requestvb->val.counter64 ) );
+            break;
+        case QtSnmpObjectDescription::TypeFloat:
+            res = validator.checkReal( static_cast< double >( *request->requestvb->val.floatVal ) );
+            break;
+        case QtSnmpObjectDescription::TypeDouble:
+            res = validator.checkReal( *request->requestvb->val.doubleVal );
             break;
         case QtSnmpObjectDescription::TypeReal:
             {
-                char buffer[ BUFSIZ ];
-                memset( buffer, 0, BUFSIZ );
-                memcpy( buffer, request->requestvb->val.string, request->requestvb->val_len );
-                const QString text_value = buffer;
+                const QByteArray text_value = QByteArray::fromRawData(
+                                                  reinterpret_cast< const char* >( request->requestvb->val.string ),
+                                                  static_cast< int >( request->requestvb->val_len ) );
                 bool ok;
                 const double value = text_value.toDouble( &ok );
-                Q_ASSERT( ok );
-                res = iter->description.checkValue( QVariant::fromValue( value ) );
+                res = ok && validator.checkReal( value );
             }
             break;
         case QtSnmpObjectDescription::TypeIpAddress:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                res = iter->description.checkValue( QVariant::fromValue( static_cast< unsigned >( value ) ) );
-            }
-            break;
         case QtSnmpObjectDescription::TypeTimeTicks:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                res = iter->description.checkValue( QVariant::fromValue( static_cast< int >( value ) ) );
-            }
-            break;
         case QtSnmpObjectDescription::TypeString:
-            {
-                char buffer[ BUFSIZ ];
-                memset( buffer, 0, BUFSIZ );
-                memcpy( buffer, request->requestvb->val.string, request->requestvb->val_len );
-                const QString value = buffer;
-                res = iter->description.checkValue( QVariant::fromValue( value ) );
-            }
+            // the type and the length have been checked in RESERVE1
+            res = true;
             break;
         default:
             qWarning() << Q_FUNC_INFO << "unsupported type:"
-                       << static_cast< int >( iter->description.type() )
-                       << " (" << oid_text << ")";
+                       << static_cast< int >( validator.type() )
+                       << " (" << key << ")";
             Q_ASSERT( false );
             break;
         }
     }
 
     if ( ! res ) {
+        if ( m_parameters.constEnd() != iter ) {
+            countRejectedSet( *iter );
+        }
         return SNMP_ERR_BADVALUE;
     }
 
     return SNMP_ERR_NOERROR;
 }
 
-int QtSnmpSubagent::agentCallbackApplyChange( void*const pointer_to_request, const QString& oid_text ) {
-    netsnmp_request_info*const request  = static_cast< netsnmp_request_info* >( pointer_to_request );
-    QHash< QString, Parameter >::const_iterator iter = m_parameters.constFind( oid_text );
+int QtSnmpSubagent::agentCallbackApplyChange( void*const, const QtSnmpOid& key ) {
+    QReadLocker locker( &m_lock );
+    if ( not m_parameters.contains( key ) ) {
+        return SNMP_ERR_NOSUCHNAME;
+    }
+    // the change is staged by agentDelegateSetRequest() and decided by the application
+    return AgentRequestDelegated;
+}
+
+void QtSnmpSubagent::agentDelegateSetRequest( void*const pointer_to_cache, const QtSnmpOid& key ) {
+    auto cache = static_cast< netsnmp_delegated_cache* >( pointer_to_cache );
+    void*const session = cache->reqinfo->asp;
+    auto transaction_iter = findTransaction( session );
+    if ( m_transactions.end() == transaction_iter ) {
+        transaction_iter = m_transactions.find( beginSetTransaction( session, {} ) );
+    }
+    SetTransaction& transaction = *transaction_iter;
+    transaction.caches << pointer_to_cache;
+
+    QReadLocker locker( &m_lock );
+    const auto iter = m_parameters.constFind( key );
+    SetTransaction::Item item;
+    item.oid = key;
+    item.is_finished = false;
     if ( m_parameters.constEnd() != iter ) {
-        switch ( iter->description.type() ) {
-        case QtSnmpObjectDescription::TypeEnum:
-        case QtSnmpObjectDescription::TypeInterger:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                emit snmpSetRequest( oid_text, QVariant::fromValue( static_cast< int >( value ) ) );
-            }
-            break;
-        case QtSnmpObjectDescription::TypeUnsigned:
-        case QtSnmpObjectDescription::TypeCounter:
-        case QtSnmpObjectDescription::TypeGauge:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                emit snmpSetRequest( oid_text, QVariant::fromValue( static_cast< unsigned >( value ) ) );
-            }
-            break;
-        case QtSnmpObjectDescription::TypeReal:
-            {
-                char buffer[ BUFSIZ ];
-                memset( buffer, 0, BUFSIZ );
-                memcpy( buffer, request->requestvb->val.string, request->requestvb->val_len );
-                const QString text_value = buffer;
-                bool ok;
-                const double value = text_value.toDouble( &ok );
-                Q_ASSERT( ok );
-                emit snmpSetRequest( oid_text, QVariant::fromValue( value ) );
-            }
-            break;
-        case QtSnmpObjectDescription::TypeIpAddress:
-            {
-                quint32 raw_value = 0;
-                memcpy( &raw_value, request->requestvb->val.integer, request->requestvb->val_len );
-                quint32 value = 0;
-                const int size = sizeof( value );
-                quint8* src = reinterpret_cast< quint8* >( &raw_value ) + ( size-1 );
-                quint8* dst = reinterpret_cast< quint8* >( &value );
-                for ( int i = 0; i < size; ++i ) {
-                    *dst++ = *src--;
-                }
-                emit snmpSetRequest( oid_text, QVariant::fromValue( static_cast< unsigned >( value ) ) );
-            }
-            break;
-        case QtSnmpObjectDescription::TypeTimeTicks:
-            {
-                long value = 0;
-                memcpy( &value, request->requestvb->val.integer, request->requestvb->val_len );
-                emit snmpSetRequest( oid_text, QVariant::fromValue( static_cast< int >( value ) ) );
-            }
-            break;
-        case QtSnmpObjectDescription::TypeString:
-            {
-                char buffer[ BUFSIZ ];
-                memset( buffer, 0, BUFSIZ );
-                memcpy( buffer, request->requestvb->val.string, request->requestvb->val_len );
-                const QString value = buffer;
-                emit snmpSetRequest( oid_text, QVariant::fromValue( value ) );
-            }
-            break;
-        default:
-            qWarning() << Q_FUNC_INFO << "unsupported type:"
-                       << static_cast< int >( iter->description.type() )
-                       << " (" << oid_text << ")";
-            Q_ASSERT( false );
-            return SNMP_ERR_GENERR;
+        item.value = request_value( cache->requests, iter->type() );
+        item.old_value = iter->value->value();
+    }
+    transaction.items << item;
+}
+
+void QtSnmpSubagent::completeSetTransaction( const quint64 transaction_id, const bool accepted ) {
+    if ( QThread::currentThread() == thread() ) {
+        finishSetTransaction( transaction_id, accepted );
+    } else {
+        m_statistics.enqueue();
+        QCoreApplication::postEvent( this, new CompleteSetEvent( transaction_id, accepted ) );
+    }
+}
+
+void QtSnmpSubagent::emitSetTransactions() {
+    QList< quint64 > transaction_ids;
+    for ( auto iter = m_transactions.begin(); m_transactions.end() != iter; ++iter ) {
+        if ( not iter->is_emitted ) {
+            iter->is_emitted = true;
+            transaction_ids << iter.key();
+        }
+    }
+
+    const bool is_connected = ( receivers( SIGNAL( snmpSetTransaction( quint64, QStringList, QVariantList ) ) ) > 0 );
+    for ( const quint64 transaction_id : transaction_ids ) {
+        const auto iter = m_transactions.constFind( transaction_id );
+        if ( m_transactions.constEnd() == iter ) {
+            continue;
+        }
+        if ( not is_connected ) {
+            finishSetTransaction( transaction_id, true );
+            continue;
+        }
+
+        QStringList oids;
+        QVariantList values;
+        for ( const auto& item : iter->items ) {
+            oids << item.oid.toString();
+            values << item.value;
+        }
+        emit snmpSetTransaction( transaction_id, oids, values );
+    }
+}
+
+void QtSnmpSubagent::finishSetTransaction( const quint64 transaction_id, const bool accepted ) {
+    const auto transaction_iter = m_transactions.find( transaction_id );
+    if ( ( m_transactions.end() == transaction_iter ) || not transaction_iter->is_pending ) {
+        qWarning() << "SET transaction " << transaction_id << " has expired or does not exist";
+        return;
+    }
+    SetTransaction& transaction = *transaction_iter;
+    transaction.is_pending = false;
+
+    bool is_valid = true;
+    for ( const auto& item : transaction.items ) {
+        is_valid = is_valid && item.value.isValid();
+    }
+    transaction.is_accepted = accepted && is_valid;
+    if ( transaction.is_accepted ) {
+        setTransactionValues( transaction, false );
+    }
+
+    if ( BackendAgentX == m_backend ) {
+        if ( m_agentx ) {
+            m_agentx->finishSetTransaction( transaction_id, transaction.is_accepted );
+        }
+        return;
+    }
+
+    int pending_count = 0;
+    for ( void*const pointer_to_cache : transaction.caches ) {
+        auto cache = netsnmp_handler_check_cache( static_cast< netsnmp_delegated_cache* >( pointer_to_cache ) );
+        if ( not cache ) {
+            continue;
+        }
+        if ( not transaction.is_accepted ) {
+            netsnmp_set_request_error( cache->reqinfo, cache->requests, SNMP_ERR_COMMITFAILED );
+        }
+        cache->requests->delegated = 0;
+        netsnmp_free_delegated_cache( cache );
+        ++pending_count;
+    }
+    transaction.caches.clear();
+
+    // the master has dropped the PDU, COMMIT or UNDO will never come
+    if ( 0 == pending_count ) {
+        qWarning() << "SET transaction " << transaction_id << " has been dropped by the master";
+        if ( transaction.is_accepted ) {
+            setTransactionValues( transaction, true );
+        }
+        m_transactions.erase( transaction_iter );
+    }
+
+    // the agent continues with COMMIT or UNDO once no request of the PDU is delegated
+    netsnmp_check_outstanding_agent_requests();
+}
+
+int QtSnmpSubagent::agentCallbackCommitChange( void*const pointer_to_request, const QtSnmpOid& key ) {
+    return finishTransactionItem( pointer_to_request, key, MODE_SET_COMMIT );
+}
+
+int QtSnmpSubagent::agentCallbackUndoChange( void*const pointer_to_request, const QtSnmpOid& key ) {
+    return finishTransactionItem( pointer_to_request, key, MODE_SET_UNDO );
+}
+
+int QtSnmpSubagent::agentCallbackFreeChange( void*const pointer_to_request, const QtSnmpOid& key ) {
+    return finishTransactionItem( pointer_to_request, key, MODE_SET_FREE );
+}
+
+int QtSnmpSubagent::finishTransactionItem( void*const pointer_to_request,
+                                           const QtSnmpOid& key,
+                                           const int mode )
+{
+    auto request = static_cast< netsnmp_request_info* >( pointer_to_request );
+    const auto transaction_iter = findTransaction( request->agent_req_info->asp );
+    if ( m_transactions.end() == transaction_iter ) {
+        return SNMP_ERR_NOERROR;
+    }
+    const quint64 transaction_id = transaction_iter.key();
+    SetTransaction& transaction = *transaction_iter;
+
+    int finished_count = 0;
+    for ( auto& item : transaction.items ) {
+        if ( item.oid == key ) {
+            item.is_finished = true;
         }
+        finished_count += item.is_finished ? 1 : 0;
+    }
+    if ( finished_count == transaction.items.size() ) {
+        closeSetTransaction( transaction_id, MODE_SET_COMMIT != mode );
     }
     return SNMP_ERR_NOERROR;
 }
 
-void QtSnmpSubagent::timerEvent( QTimerEvent* ) {
-    agent_check_and_process( 0 );
+quint64 QtSnmpSubagent::beginSetTransaction( void*const session, const QVector< SetTransaction::Item >& items ) {
+    SetTransaction transaction;
+    transaction.session = session;
+    transaction.items = items;
+    transaction.started.start();
+    transaction.timeout = qMax( transactionTimeout(), 0 );
+    const quint64 transaction_id = ++m_last_request_id;
+    m_transactions.insert( transaction_id, transaction );
+    if ( not m_delegated_timer->isActive() || ( m_delegated_timer->remainingTime() > transaction.timeout ) ) {
+        m_delegated_timer->start( transaction.timeout );
+    }
+    return transaction_id;
+}
+
+void QtSnmpSubagent::closeSetTransaction( const quint64 transaction_id, const bool is_undo ) {
+    const auto transaction_iter = m_transactions.find( transaction_id );
+    if ( m_transactions.end() == transaction_iter ) {
+        return;
+    }
+    const SetTransaction transaction = *transaction_iter;
+    m_transactions.erase( transaction_iter );
+    if ( not transaction.is_accepted ) {
+        return;
+    }
+
+    if ( is_undo ) {
+        setTransactionValues( transaction, true );
+        emit snmpSetTransactionUndone( transaction_id );
+    } else {
+        for ( const auto& item : transaction.items ) {
+            emit snmpSetRequest( item.oid.toString(), item.value );
+        }
+    }
+}
+
+QtSnmpSubagent::Parameter QtSnmpSubagent::createParameter( const QtSnmpObjectDescription& description,
+                                                           const QVariant& value )
+{
+    Parameter parameter;
+    parameter.validator = sharedValidator( description );
+    parameter.value = QSharedPointer< QtSnmpValue >::create( description.type() );
+    parameter.value->setValue( value );
+    parameter.is_read_only = description.isReadOnly();
+    if ( m_is_instrumented.load() ) {
+        parameter.counters = QSharedPointer< ObjectCounters >::create();
+    }
+    return parameter;
+}
+
+QSharedPointer< const QtSnmpValidator > QtSnmpSubagent::sharedValidator( const QtSnmpObjectDescription& description ) {
+    const QtSnmpValidator validator( description );
+    const uint hash = qHash( validator );
+    auto iter = m_validators.find( hash );
+    while ( ( m_validators.end() != iter ) && ( hash == iter.key() ) ) {
+        const QSharedPointer< const QtSnmpValidator > shared = iter->toStrongRef();
+        if ( shared.isNull() ) {
+            // the objects which used it have been unregistered
+            iter = m_validators.erase( iter );
+            continue;
+        }
+        if ( *shared == validator ) {
+            return shared;
+        }
+        ++iter;
+    }
+
+    const QSharedPointer< const QtSnmpValidator > shared( new QtSnmpValidator( validator ) );
+    m_validators.insert( hash, QWeakPointer< const QtSnmpValidator >( shared ) );
+    return shared;
+}
+
+void QtSnmpSubagent::countGet( const Parameter& parameter ) {
+    if ( m_is_instrumented.load() ) {
+        m_statistics.countGet();
+        if ( parameter.counters ) {
+            parameter.counters->get_requests.add();
+        }
+    }
+}
+
+void QtSnmpSubagent::countSet( const Parameter& parameter ) {
+    if ( m_is_instrumented.load() ) {
+        m_statistics.countSet();
+        if ( parameter.counters ) {
+            parameter.counters->set_requests.add();
+        }
+    }
+}
+
+void QtSnmpSubagent::countRejectedSet( const Parameter& parameter ) {
+    if ( m_is_instrumented.load() ) {
+        m_statistics.countRejectedSet();
+        if ( parameter.counters ) {
+            parameter.counters->rejected_sets.add();
+        }
+    }
+}
+
+void QtSnmpSubagent::setTransactionValues( const SetTransaction& transaction, const bool is_undo ) {
+    QReadLocker locker( &m_lock );
+    for ( const auto& item : transaction.items ) {
+        const auto iter = m_parameters.constFind( item.oid );
+        if ( m_parameters.constEnd() == iter ) {
+            continue;
+        }
+        iter->value->setValue( is_undo ? item.old_value : item.value );
+        if ( not is_undo ) {
+            countSet( *iter );
+        }
+    }
+}
+
+QHash< quint64, QtSnmpSubagent::SetTransaction >::iterator QtSnmpSubagent::findTransaction( void*const session ) {
+    for ( auto iter = m_transactions.begin(); m_transactions.end() != iter; ++iter ) {
+        if ( session == iter->session ) {
+            return iter;
+        }
+    }
+    return m_transactions.end();
+}
+
+void QtSnmpSubagent::processAgentEvents() {
+    ++m_agent_cycle;
+    const bool is_instrumented = m_is_instrumented.load();
+    QElapsedTimer timer;
+    if ( is_instrumented ) {
+        timer.start();
+    }
+    if ( ( agent_check_and_process( 0 ) > 0 ) && is_instrumented ) {
+        m_statistics.countPdu( timer.nsecsElapsed() );
+    }
+    updateAgentNotifiers();
+    emitDelegatedRequests();
+    emitSetTransactions();
+}
+
+void QtSnmpSubagent::updateAgentNotifiers() {
+    int fd_count = 0;
+    fd_set read_fds;
+    FD_ZERO( &read_fds );
+    struct timeval timeout;
+    timerclear( &timeout );
+    int block = 1;
+    snmp_select_info( &fd_count, &read_fds, &timeout, &block );
+
+    auto iter = m_notifiers.begin();
+    while ( m_notifiers.end() != iter ) {
+        if ( ( iter.key() < fd_count ) && FD_ISSET( iter.key(), &read_fds ) ) {
+            ++iter;
+            continue;
+        }
+        // the notifier can be the sender of the current activation
+        iter.value()->setEnabled( false );
+        iter.value()->deleteLater();
+        iter = m_notifiers.erase( iter );
+    }
+
+    for ( int fd = 0; fd < fd_count; ++fd ) {
+        if ( FD_ISSET( fd, &read_fds ) && not m_notifiers.contains( fd ) ) {
+            auto notifier = new QSocketNotifier( fd, QSocketNotifier::Read, this );
+            connect( notifier, SIGNAL( activated( int ) ),
+                     this, SLOT( processAgentEvents() ) );
+            m_notifiers.insert( fd, notifier );
+        }
+    }
+
+    if ( block ) {
+        m_alarm_timer->stop();
+    } else {
+        const qint64 msec = static_cast< qint64 >( timeout.tv_sec ) * 1000
+                            + ( timeout.tv_usec + 999 ) / 1000;
+        m_alarm_timer->start( static_cast< int >( qMin< qint64 >( msec, INT_MAX ) ) );
+    }
 }
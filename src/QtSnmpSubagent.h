@@ -2,48 +2,484 @@
 
 #include <QObject>
 #include "QtSnmpObjectDescription.h"
+#include "QtSnmpOid.h"
+#include "QtSnmpValue.h"
+#include "QtSnmpValidator.h"
+#include "QtSnmpHandle.h"
+#include "QtSnmpStatistics.h"
+#include "QtSnmpTable.h"
 #include <QHash>
+#include <QMap>
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QVector>
+#include <QPair>
+#include <QStringList>
+#include <QElapsedTimer>
+#include <functional>
 #include "win_export.h"
 
+class QSocketNotifier;
+class QTimer;
+class QtSnmpAgentX;
+
 class WIN_EXPORT QtSnmpSubagent : public QObject {
     Q_OBJECT
     Q_DISABLE_COPY( QtSnmpSubagent )
     explicit QtSnmpSubagent( QObject*const parent = nullptr ) : QObject(parent) {}
 
 public:
+    typedef QVector< QPair< QString, QVariant > > ValueList;
+    typedef QVector< QPair< QtSnmpObjectDescription, QVariant > > ObjectList;
+    // Fills the values of the listed OIDs, an invalid value keeps the previous one
+    typedef std::function< void( ValueList& values ) > Provider;
+
+    enum Backend {
+        BackendNetSnmp,     // net-snmp agent library
+        BackendAgentX       // AgentX session served by the Qt event loop
+    };
+
+    enum ConnectionState {
+        StateStopped,       // before start() or after stop()
+        StateDisconnected,  // the master is not reachable
+        StateConnecting,    // waiting for the master to open the session
+        StateConnected      // the registry has been registered with the master
+    };
+    Q_ENUM( ConnectionState )
+
+    struct SessionStatistics {
+        // sessions reopened after the previous one has been lost
+        int reconnects = 0;
+        // ms from the loss of a session until the next one has opened
+        qint64 reconnect_latency = -1;
+        // AgentX only: registration PDUs sent for the registry and ms until the master has answered all
+        int registrations = 0;
+        qint64 registration_time = -1;
+    };
+
+    struct ObjectStatistics {
+        quint64 get_requests = 0;
+        quint64 set_requests = 0;
+        quint64 rejected_sets = 0;
+    };
+
+    struct NotificationStatistics {
+        // notifications waiting for the coalescing window or for the session
+        int queue_depth = 0;
+        int max_queue_depth = 0;
+        quint64 sent = 0;
+        // merged into an equal notification which was queued
+        quint64 coalesced = 0;
+        // refused by the rate limit of the notification type
+        quint64 rate_limited = 0;
+        // refused because the queue was full
+        quint64 dropped = 0;
+    };
+
+    // AgentX only: request PDUs are queued by class and the agent thread serves SETs first,
+    // then GETs, then walks; newly arrived PDUs are read between slices of a long queue
+    enum RequestClass {
+        RequestSet,         // TestSet, CommitSet, UndoSet and CleanupSet
+        RequestGet,         // small GET PDUs and requests starting below a priority subtree
+        RequestWalk,        // GETNEXT, GETBULK and large GET PDUs
+        LimitOfRequestClasses
+    };
+
+    struct RequestStatistics {
+        int queue_depth = 0;
+        int max_queue_depth = 0;
+        quint64 pdus = 0;
+        // µs from the arrival of a PDU until its processing has started
+        qint64 total_wait = 0;
+        qint64 max_wait = 0;
+        // answered with genErr, having waited longer than the timeout or run over the time limit
+        quint64 expired = 0;
+    };
+
+    // returned by the GET callbacks when the value is delivered later by completeGetRequest()
+    enum { AgentRequestDelegated = -1 };
+
     static QtSnmpSubagent* instance();
+    // A further subagent with its own thread and AgentX session, served in parallel with the
+    // other ones; it is started by start() once configured. Only instance() uses net-snmp.
+    static QtSnmpSubagent* createInstance( const QString& application_name );
+    // Stops the subagent first, waiting for its agent thread when deleted from another one
+    virtual ~QtSnmpSubagent();
 
+    // Thread safe, with net-snmp a registration made by another thread is passed to the agent thread
+    // and a refusal of the master is only logged
     bool registerSnmpObject( const QtSnmpObjectDescription&, const QVariant& value );
     bool unregisterSnmpObject( const QString& oid );
 
+    template< class T >
+    QtSnmpHandle< T > registerSnmpHandle( const QtSnmpObjectDescription& description, const T& value ) {
+        if ( not registerSnmpObject( description, QtSnmpValueTraits< T >::toVariant( value ) ) ) {
+            return {};
+        }
+        return handle< T >( description.oid() );
+    }
+
+    template< class T >
+    QtSnmpHandle< T > handle( const QString& oid ) const {
+        QSharedPointer< QtSnmpValue > value;
+        QSharedPointer< const QtSnmpValidator > validator;
+        if ( not findValue( oid, &value, &validator ) ) {
+            return {};
+        }
+        if ( not QtSnmpValueTraits< T >::isCompatible( value->type() ) ) {
+            qWarning() << "OID " << oid << " does not match the type of the handle";
+            return {};
+        }
+        return QtSnmpHandle< T >( value, validator );
+    }
+
+    // Adjacent objects of the list are registered with the master as ranges
+    bool registerSnmpObjects( const ObjectList& objects );
+
+    // Values of the objects are read by the provider when a request finds them older than ttl ms,
+    // one call of the provider serves all objects of the list which this call has registered
+    bool registerSnmpProvider( const ObjectList& objects, const Provider& provider, const int ttl );
+
+    // GET requests for the object are answered asynchronously: snmpGetRequest() is emitted
+    // and the request waits up to timeout ms for completeGetRequest() while other PDUs are served
+    bool registerSnmpAsyncObject( const QtSnmpObjectDescription&, const int timeout );
+    Q_SIGNAL void snmpGetRequest( const QString& oid, const quint64 request_id );
+    // Thread safe, an invalid value answers the request with genErr
+    Q_SLOT void completeGetRequest( const quint64 request_id, const QVariant& value );
+
+    // Objects registered below a subtree are served by one handler of the subtree
+    bool registerSnmpSubtree( const QString& oid );
+    // Removes every object below the OID together with the registrations serving them
+    bool unregisterSnmpSubtree( const QString& oid );
+
+    // The table is served below the entry of its columns, GETNEXT walks the rows in the order
+    // of their indexes; its cells are read only
+    QSharedPointer< QtSnmpTable > registerSnmpTable( const QList< QtSnmpObjectDescription >& columns );
+    bool unregisterSnmpTable( const QString& oid );
+
     QVariant value( const QString& oid ) const;
     Q_SLOT void setValue( const QString& oid, const QVariant& value );
+    // The batch is validated and applied by the agent thread in one pass
+    void setValues( const ValueList& values );
 
+    // Emitted for every varbind of a committed SET
     Q_SIGNAL void snmpSetRequest( const QString& oid, const QVariant& value );
+    // All varbinds of a SET PDU, the PDU waits for completeSetTransaction() when the signal is connected
+    Q_SIGNAL void snmpSetTransaction( const quint64 transaction_id,
+                                      const QStringList& oids,
+                                      const QVariantList& values );
+    // Thread safe, a rejected transaction fails the PDU with commitFailed
+    Q_SLOT void completeSetTransaction( const quint64 transaction_id, const bool accepted );
+    // Thread safe, ms the application has to complete a transaction, used by the transactions
+    // which start afterwards; an unanswered transaction fails with commitFailed
+    void setTransactionTimeout( const int timeout );
+    int transactionTimeout() const;
+    // An accepted transaction has been rolled back, the previous values are restored
+    Q_SIGNAL void snmpSetTransactionUndone( const quint64 transaction_id );
+
+    // Selects the protocol engine, must be called before start()
+    void setBackend( const Backend );
+    Backend backend() const;
 
+    // Connection settings are thread safe and used by start(); after start() the AgentX
+    // backend reconnects with the new settings, the net-snmp backend keeps the old ones
+    // "tcp:localhost:705", "unix:/var/agentx/master"
+    void setMasterAddress( const QString& address );
+    QString masterAddress() const;
+    void setApplicationName( const QString& name );
+    QString applicationName() const;
+    // ms to wait for a response of the master, negative for the default
+    void setTimeout( const int timeout );
+    int timeout() const;
+    // retransmissions of a request before the master is considered lost, negative for the default
+    void setRetries( const int retries );
+    int retries() const;
+    // ms a GET or GETNEXT PDU may take before it fails with genErr, a GETBULK response
+    // is cut short instead; not positive for no limit
+    void setPduTimeLimit( const int limit );
+    int pduTimeLimit() const;
+    // GETNEXT and GETBULK requests starting below these subtrees are served as GETs
+    void setPrioritySubtrees( const QStringList& oids );
+    // Thread safe, by RequestClass
+    QVector< RequestStatistics > requestStatistics() const;
+
+    // Thread safe, returns at once, objects registered before the session opens are registered in one batch
     Q_SLOT void start();
+    // Thread safe, answers pending requests and closes the session, the registry is kept
+    Q_SLOT void stop();
+    // Thread safe
+    ConnectionState connectionState() const;
+    Q_SIGNAL void connectionStateChanged( const QtSnmpSubagent::ConnectionState state );
+    // Emitted every time the session opens and the registry has been registered
+    Q_SIGNAL void ready();
+    // Thread safe
+    SessionStatistics sessionStatistics() const;
+
+    // Requests are counted while the instrumentation is enabled, thread safe
+    void setInstrumentation( const bool enabled );
+    bool isInstrumented() const;
+    // Thread safe
+    const QtSnmpStatistics& statistics() const;
+    // Thread safe, the objects which have been requested
+    QMap< QString, ObjectStatistics > objectStatistics() const;
+    // Serves the statistics below the OID and enables the instrumentation:
+    // .1.0 GET varbinds, .2.0 SET varbinds, .3.0 rejected SET varbinds, .4.0 PDUs (Counter64),
+    // .5.0 queue depth, .6.0 maximum queue depth (Gauge), .7.<bucket>.0 PDUs by latency (Counter64)
+    bool registerSnmpStatistics( const QString& oid );
 
-    int agentCallbackGetValue( void*const request, const QString& oid );
-    int agentCallbackCheckTypeAndLen( void*const request, const QString& oid );
-    int agentCallbackCheckValue( void*const request, const QString& oid );
-    int agentCallbackApplyChange( void*const request, const QString& oid );
+    // Thread safe, queues an SNMPv2 notification which the agent thread sends with the values
+    // the objects have then; an equal notification queued within the coalescing window is merged
+    // into it. Notifications wait for the session, false if the queue is full
+    bool sendNotification( const QString& oid, const QStringList& objects = QStringList() );
+    // Thread safe, ms a queued notification waits for the equal ones
+    void setNotificationWindow( const int window );
+    int notificationWindow() const;
+    // Thread safe, every notification type may be sent burst times at once and rate times
+    // a second on average, the excess is dropped; a rate which is not positive disables the limit
+    void setNotificationRateLimit( const double rate, const int burst );
+    // Thread safe
+    NotificationStatistics notificationStatistics() const;
+
+    int agentCallbackGetValue( void*const request, const QtSnmpOid& oid );
+    int agentCallbackGetNextValue( void*const request,
+                                   const QtSnmpOid& oid,
+                                   const QtSnmpOid& root,
+                                   const int range_index,
+                                   const quint32 range_upper );
+    void agentDelegateGetRequest( void*const cache, const QtSnmpOid& oid );
+    int agentCallbackCheckTypeAndLen( void*const request, const QtSnmpOid& oid );
+    int agentCallbackCheckValue( void*const request, const QtSnmpOid& oid );
+    int agentCallbackApplyChange( void*const request, const QtSnmpOid& oid );
+    void agentDelegateSetRequest( void*const cache, const QtSnmpOid& oid );
+    void agentCallbackSessionChanged( const bool is_open );
+    int agentCallbackCommitChange( void*const request, const QtSnmpOid& oid );
+    int agentCallbackUndoChange( void*const request, const QtSnmpOid& oid );
+    int agentCallbackFreeChange( void*const request, const QtSnmpOid& oid );
 private:
-    virtual void timerEvent( QTimerEvent* ) override final;
+    friend class QtSnmpAgentX;
+
+    static QtSnmpSubagent* createOnThread( const QString& thread_name );
+
+    virtual void customEvent( QEvent* ) override final;
+    void applyValues( const ValueList& values );
+
+    Q_SLOT void processAgentEvents();
+    Q_SLOT void applySettings();
+    Q_SLOT void expireDelegatedRequests();
+    Q_SLOT void scheduleNotifications();
+    Q_SLOT void flushNotifications();
+    void finishDelegatedRequest( const quint64 request_id, const QVariant& value );
+    quint64 startDelegatedRequest( void*const cache, const QtSnmpOid& oid );
+    void updateAgentNotifiers();
+    void setConnectionState( const ConnectionState );
+    // the work of stop(), on the agent thread or once it has finished
+    void shutdown();
+    // registers the whole registry with the net-snmp agent, called under the write lock
+    void registerRegistry();
+    bool isCovered( const QtSnmpOid& ) const;
+    // registration through the selected backend, called under the write lock
+    bool registerWithMaster( const QtSnmpOid& root,
+                             const int range_index,
+                             const quint32 range_upper,
+                             const bool is_instance );
+    bool unregisterWithMaster( const QtSnmpOid& root, const int range_index, const quint32 range_upper );
+    // the object at the OID, or the first one after it before end, with a fresh value;
+    // a table cell is copied into cell and value is null, only a request is counted as a GET
+    bool findObject( const QtSnmpOid& start,
+                     const bool is_next,
+                     const bool include,
+                     const QtSnmpOid& end,
+                     const bool is_request,
+                     QtSnmpOid*const key,
+                     QSharedPointer< QtSnmpValue >*const value,
+                     QtSnmpTable::Cell*const cell,
+                     bool*const is_async );
+    // called under the lock
+    QSharedPointer< QtSnmpTable > findTable( const QtSnmpOid& key ) const;
+    bool findTableCell( const QtSnmpOid& start,
+                        const bool is_next,
+                        const bool include,
+                        const QtSnmpOid& end,
+                        QtSnmpOid*const key,
+                        QtSnmpTable::Cell*const cell ) const;
+    bool isTableCell( const QtSnmpOid& key ) const;
+    bool findValue( const QString& oid,
+                    QSharedPointer< QtSnmpValue >*const value,
+                    QSharedPointer< const QtSnmpValidator >*const validator ) const;
 
 private:
     bool m_initialized = false;
+    // the subagent of instance(), the only one which may use the net-snmp backend
+    bool m_is_default = false;
+    QAtomicInt m_connection_state;
+    QElapsedTimer m_session_lost;
+    mutable QMutex m_statistics_mutex;
+    SessionStatistics m_session_statistics;
+    // by RequestClass, written by the agent thread only
+    struct RequestCounters {
+        QtSnmpCounter queue_depth;
+        QtSnmpCounter max_queue_depth;
+        QtSnmpCounter pdus;
+        QtSnmpCounter total_wait;
+        QtSnmpCounter max_wait;
+        QtSnmpCounter expired;
+    };
+    RequestCounters m_request_counters[ LimitOfRequestClasses ];
+#ifdef QT_SNMP_SUBAGENT_AGENTX
+    Backend m_backend = BackendAgentX;
+#else
+    Backend m_backend = BackendNetSnmp;
+#endif
+    QtSnmpAgentX* m_agentx = nullptr;
 
+    mutable QMutex m_settings_mutex;
+    QString m_master_address = "tcp:localhost:705";
+    QString m_application_name = "lemz-ads-b-subagent";
+    int m_timeout = -1;
+    int m_retries = -1;
+    int m_pdu_time_limit = 1000;
+    int m_transaction_timeout = 5000;
+    QVector< QtSnmpOid > m_priority_subtrees;
+    QVector< QtSnmpOid > prioritySubtrees() const;
+
+    QHash< int, QSocketNotifier* > m_notifiers;
+    QTimer* m_alarm_timer = nullptr;
+
+    // objects which values are read by one call of the provider, used by the agent thread only
+    struct ProviderGroup {
+        Provider provider;
+        int ttl = 0;
+        quint64 cycle = 0;
+        QElapsedTimer updated;
+        ValueList values;
+        QVector< QSharedPointer< QtSnmpValue > > targets;
+        QVector< QSharedPointer< const QtSnmpValidator > > validators;
+    };
+    bool insertObjects( const ObjectList&, const QSharedPointer< ProviderGroup >& );
+    // synchronous when the timeout is negative, registering an existing object as asynchronous fails
+    bool insertObject( const QtSnmpObjectDescription&, const QVariant& value, const int async_timeout );
+    bool isStale( const QSharedPointer< ProviderGroup >& ) const;
+    void refreshProvider( const QSharedPointer< ProviderGroup >& );
+    // incremented for every pass of the agent, a refresh serves all requests of the pass
+    quint64 m_agent_cycle = 0;
+
+    // written by the agent thread only
+    struct ObjectCounters {
+        QtSnmpCounter get_requests;
+        QtSnmpCounter set_requests;
+        QtSnmpCounter rejected_sets;
+    };
+
+    // The OID is the key of the registry and the type is kept by the value,
+    // so the description itself is not stored; the validator is shared.
     struct Parameter {
-        QtSnmpObjectDescription description;
-        QVariant value;
-
-        Parameter( const QtSnmpObjectDescription& _description,
-                   const QVariant& _value )
-            : description( _description )
-            , value( _value )
-        {
+        QSharedPointer< const QtSnmpValidator > validator;
+        QSharedPointer< QtSnmpValue > value;
+        QSharedPointer< ProviderGroup > provider;
+        // allocated while the instrumentation is enabled
+        QSharedPointer< ObjectCounters > counters;
+        // GET is delegated to the application when not negative
+        int async_timeout = -1;
+        bool is_read_only = false;
+
+        QtSnmpObjectDescription::Type type() const {
+            return value->type();
         }
     };
 
-    QHash< QString, Parameter > m_parameters;
+    // called under the write lock
+    Parameter createParameter( const QtSnmpObjectDescription&, const QVariant& value );
+    QSharedPointer< const QtSnmpValidator > sharedValidator( const QtSnmpObjectDescription& );
+    // identical constraints share one validator, e.g. all objects of a column
+    QMultiHash< uint, QWeakPointer< const QtSnmpValidator > > m_validators;
+
+    typedef QVector< QPair< QtSnmpOid, QSharedPointer< QtSnmpValue > > > VarbindList;
+    // false when the session is closed and nothing has been sent
+    bool sendNotify( const QtSnmpOid& notification, const VarbindList& varbinds );
+
+    struct Notification {
+        QtSnmpOid oid;
+        QVector< QtSnmpOid > objects;
+    };
+    // sent in the order of sendNotification(), guarded by the mutex
+    mutable QMutex m_notifications_mutex;
+    QVector< Notification > m_notifications;
+    NotificationStatistics m_notification_statistics;
+    int m_notification_window = 100;
+    double m_notification_rate = 5;
+    int m_notification_burst = 10;
+    // by the notification type, used by the agent thread only
+    struct TokenBucket {
+        double tokens = 0;
+        QElapsedTimer refilled;
+    };
+    QHash< QtSnmpOid, TokenBucket > m_token_buckets;
+    QTimer* m_notification_timer = nullptr;
+
+    void setVariableValue( void*const request, const QtSnmpValue& );
+    void countGet( const Parameter& );
+    void countSet( const Parameter& );
+    void countRejectedSet( const Parameter& );
+
+    QAtomicInt m_is_instrumented;
+    QtSnmpStatistics m_statistics;
+
+    // guards the layout of the registry, values are synchronised by QtSnmpValue
+    mutable QReadWriteLock m_lock;
+    QMap< QtSnmpOid, Parameter > m_parameters;
+    QList< QtSnmpOid > m_subtrees;
+    // by the entry OID
+    QMap< QtSnmpOid, QSharedPointer< QtSnmpTable > > m_tables;
+
+    // registration serving objects which differ only in the sub-identifier at index
+    struct Range {
+        QtSnmpOid root;
+        int index;
+        quint32 upper;
+    };
+    static QtSnmpOid rangePattern( const QtSnmpOid& key, const int index );
+    QHash< QtSnmpOid, Range > m_ranges;
+
+    // GET requests waiting for completeGetRequest(), used by the agent thread only
+    struct DelegatedRequest {
+        void* cache;
+        QtSnmpOid oid;
+        QElapsedTimer started;
+        int timeout;
+    };
+    QHash< quint64, DelegatedRequest > m_delegated;
+    // delegated by the handlers of the current pass, snmpGetRequest() is emitted after the pass
+    QVector< QPair< quint64, QtSnmpOid > > m_delegated_to_emit;
+    void emitDelegatedRequests();
+    quint64 m_last_request_id = 0;
+    QTimer* m_delegated_timer = nullptr;
+
+    // varbinds of a SET PDU staged in ACTION until COMMIT, UNDO or FREE, used by the agent thread only
+    struct SetTransaction {
+        struct Item {
+            QtSnmpOid oid;
+            QVariant value;
+            QVariant old_value;
+            bool is_finished;
+        };
+        void* session = nullptr;
+        QList< void* > caches;
+        QVector< Item > items;
+        QElapsedTimer started;
+        int timeout = 0;
+        bool is_emitted = false;
+        bool is_pending = true;
+        bool is_accepted = false;
+    };
+    QHash< quint64, SetTransaction > m_transactions;
+    QHash< quint64, SetTransaction >::iterator findTransaction( void*const session );
+    void emitSetTransactions();
+    void finishSetTransaction( const quint64 transaction_id, const bool accepted );
+    int finishTransactionItem( void*const request, const QtSnmpOid& oid, const int mode );
+    void setTransactionValues( const SetTransaction&, const bool is_undo );
+    quint64 beginSetTransaction( void*const session, const QVector< SetTransaction::Item >& items );
+    // emits snmpSetRequest() for an accepted transaction or restores the values on undo
+    void closeSetTransaction( const quint64 transaction_id, const bool is_undo );
 };
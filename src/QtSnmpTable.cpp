@@ -0,0 +1,328 @@
+#include "QtSnmpTable.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QDebug>
+#include <algorithm>
+
+QtSnmpTable::QtSnmpTable( const QList< QtSnmpObjectDescription >& columns ) {
+    QList< QPair< QtSnmpOid, QtSnmpObjectDescription > > ordered;
+    bool res = not columns.isEmpty();
+    for ( const auto& description : columns ) {
+        bool ok;
+        const QtSnmpOid oid = QtSnmpOid::fromString( description.oid(), &ok );
+        if ( not ok || not description.isValid() || ( oid.size() < 2 ) ) {
+            qWarning() << "Could not use an incorrect description for a column:" << description;
+            res = false;
+            break;
+        }
+        ordered << qMakePair( oid, description );
+    }
+    std::sort( ordered.begin(), ordered.end(),
+               []( const QPair< QtSnmpOid, QtSnmpObjectDescription >& left,
+                   const QPair< QtSnmpOid, QtSnmpObjectDescription >& right ) {
+        return left.first < right.first;
+    } );
+
+    for ( int i = 0; res && ( i < ordered.size() ); ++i ) {
+        const QtSnmpOid& oid = ordered.at( i ).first;
+        const QtSnmpObjectDescription& description = ordered.at( i ).second;
+        const QtSnmpOid entry( oid.constData(), oid.size() - 1 );
+        if ( 0 == i ) {
+            m_entry = entry;
+        } else if ( ( entry != m_entry ) || ( oid == ordered.at( i - 1 ).first ) ) {
+            qWarning() << "Column " << description.oid() << " does not belong to the table " << m_entry;
+            res = false;
+            break;
+        }
+
+        Column column = {
+            oid.at( oid.size() - 1 ),
+            description,
+            QtSnmpValidator( description ),
+            QSharedPointer< QtSnmpValue >( new QtSnmpValue( description.type() ) ),
+            false,
+            false,
+            {},
+            {}
+        };
+        // a real is kept as its bits and its text, both made when it is stored
+        column.has_text = ( QtSnmpObjectDescription::TypeReal == description.type() );
+        column.is_scalar = column.encoder->isScalar() || column.has_text;
+        m_columns << column;
+    }
+
+    m_is_valid = res;
+    if ( not res ) {
+        m_entry = QtSnmpOid();
+        m_columns.clear();
+    }
+}
+
+bool QtSnmpTable::isValid() const {
+    return m_is_valid;
+}
+
+QString QtSnmpTable::oid() const {
+    return m_entry.toString();
+}
+
+QtSnmpOid QtSnmpTable::entry() const {
+    return m_entry;
+}
+
+int QtSnmpTable::columnCount() const {
+    return m_columns.size();
+}
+
+int QtSnmpTable::rowCount() const {
+    QReadLocker locker( &m_lock );
+    return m_indexes.size();
+}
+
+bool QtSnmpTable::setRow( const QString& index_text, const QVariantList& values ) {
+    bool ok;
+    const QtSnmpOid index = QtSnmpOid::fromString( index_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse the row index " << index_text;
+        return false;
+    }
+    return setRow( index, values );
+}
+
+bool QtSnmpTable::setRow( const quint32 index, const QVariantList& values ) {
+    return setRow( QtSnmpOid( &index, 1 ), values );
+}
+
+bool QtSnmpTable::setRow( const QtSnmpOid& index, const QVariantList& values ) {
+    // the OID of a cell is the entry, the column number and the index
+    if ( m_entry.size() + 1 + index.size() > QtSnmpOid::MaxLength ) {
+        qWarning() << "Row " << index << " of the table " << m_entry << " has an index longer than "
+                   << ( QtSnmpOid::MaxLength - m_entry.size() - 1 ) << " sub-identifiers";
+        return false;
+    }
+    if ( values.size() != m_columns.size() ) {
+        qWarning() << "Row " << index << " of the table " << m_entry << " has "
+                   << values.size() << " values instead of " << m_columns.size();
+        return false;
+    }
+    for ( int i = 0; i < m_columns.size(); ++i ) {
+        if ( not m_columns.at( i ).validator.check( values.at( i ) ) ) {
+            qWarning() << "Inappropriate value " << values.at( i ) << " for the column "
+                       << m_columns.at( i ).description.oid() << ", the row will be ignored";
+            return false;
+        }
+    }
+
+    QWriteLocker locker( &m_lock );
+    const auto iter = std::lower_bound( m_indexes.begin(), m_indexes.end(), index );
+    const int row = static_cast< int >( iter - m_indexes.begin() );
+    if ( ( m_indexes.end() == iter ) || ( *iter != index ) ) {
+        m_indexes.insert( row, index );
+        for ( auto& column : m_columns ) {
+            if ( column.is_scalar ) {
+                column.scalars.insert( row, 0 );
+            }
+            if ( not column.is_scalar || column.has_text ) {
+                column.data.insert( row, QByteArray() );
+            }
+        }
+    }
+    for ( int i = 0; i < m_columns.size(); ++i ) {
+        storeCell( m_columns[ i ], row, values.at( i ) );
+    }
+    return true;
+}
+
+bool QtSnmpTable::removeRow( const QString& index_text ) {
+    bool ok;
+    const QtSnmpOid index = QtSnmpOid::fromString( index_text, &ok );
+    if ( not ok ) {
+        qWarning() << "Could not parse the row index " << index_text;
+        return false;
+    }
+    return removeRow( index );
+}
+
+bool QtSnmpTable::removeRow( const quint32 index ) {
+    return removeRow( QtSnmpOid( &index, 1 ) );
+}
+
+bool QtSnmpTable::removeRow( const QtSnmpOid& index ) {
+    QWriteLocker locker( &m_lock );
+    const int row = findRow( index );
+    if ( row < 0 ) {
+        return false;
+    }
+    m_indexes.remove( row );
+    for ( auto& column : m_columns ) {
+        if ( column.is_scalar ) {
+            column.scalars.remove( row );
+        }
+        if ( not column.is_scalar || column.has_text ) {
+            column.data.remove( row );
+        }
+    }
+    return true;
+}
+
+bool QtSnmpTable::setValue( const QString& index_text, const quint32 number, const QVariant& value ) {
+    const int column_index = findColumn( number );
+    if ( column_index < 0 ) {
+        qWarning() << "Table " << m_entry << " has no column " << number;
+        return false;
+    }
+    if ( not m_columns.at( column_index ).validator.check( value ) ) {
+        qWarning() << "Inappropriate value " << value << " for the column "
+                   << m_columns.at( column_index ).description.oid() << " will be ignored.";
+        return false;
+    }
+
+    const QtSnmpOid index = QtSnmpOid::fromString( index_text );
+    QWriteLocker locker( &m_lock );
+    const int row = findRow( index );
+    if ( row < 0 ) {
+        qWarning() << "Table " << m_entry << " has no row " << index_text;
+        return false;
+    }
+    storeCell( m_columns[ column_index ], row, value );
+    return true;
+}
+
+QVariant QtSnmpTable::value( const QString& index_text, const quint32 number ) const {
+    const int column_index = findColumn( number );
+    if ( column_index < 0 ) {
+        return {};
+    }
+
+    const QtSnmpOid index = QtSnmpOid::fromString( index_text );
+    Cell cell;
+    {
+        QReadLocker locker( &m_lock );
+        const int row = findRow( index );
+        if ( row < 0 ) {
+            return {};
+        }
+        loadCell( m_columns.at( column_index ), row, &cell );
+    }
+    QtSnmpValue value( cell.type );
+    cell.copyTo( &value );
+    return value.value();
+}
+
+void QtSnmpTable::clear() {
+    QWriteLocker locker( &m_lock );
+    m_indexes.clear();
+    for ( auto& column : m_columns ) {
+        column.scalars.clear();
+        column.data.clear();
+    }
+}
+
+bool QtSnmpTable::findCell( const QtSnmpOid& start,
+                            const bool is_next,
+                            const bool include,
+                            const QtSnmpOid& end,
+                            QtSnmpOid*const key,
+                            Cell*const cell ) const
+{
+    const int entry_size = m_entry.size();
+    QReadLocker locker( &m_lock );
+    if ( m_indexes.isEmpty() ) {
+        return false;
+    }
+
+    int column_index = 0;
+    int row = 0;
+    if ( not is_next ) {
+        if ( not start.startsWith( m_entry ) || ( start.size() <= entry_size + 1 ) ) {
+            return false;
+        }
+        column_index = findColumn( start.at( entry_size ) );
+        row = findRow( start.mid( entry_size + 1 ) );
+        if ( ( column_index < 0 ) || ( row < 0 ) ) {
+            return false;
+        }
+    } else if ( start.startsWith( m_entry ) && ( start.size() > entry_size ) ) {
+        const quint32 number = start.at( entry_size );
+        while ( ( column_index < m_columns.size() ) && ( m_columns.at( column_index ).number < number ) ) {
+            ++column_index;
+        }
+        if ( ( column_index < m_columns.size() ) && ( m_columns.at( column_index ).number == number ) ) {
+            const QtSnmpOid index = start.mid( entry_size + 1 );
+            const auto iter = include ? std::lower_bound( m_indexes.begin(), m_indexes.end(), index )
+                                      : std::upper_bound( m_indexes.begin(), m_indexes.end(), index );
+            row = static_cast< int >( iter - m_indexes.begin() );
+            if ( row == m_indexes.size() ) {
+                ++column_index;
+                row = 0;
+            }
+        }
+        if ( column_index == m_columns.size() ) {
+            return false;
+        }
+    } else if ( m_entry < start ) {
+        return false;
+    }
+
+    const Column& column = m_columns.at( column_index );
+    QtSnmpOid result = m_entry;
+    result.append( column.number );
+    const QtSnmpOid& index = m_indexes.at( row );
+    for ( int i = 0; i < index.size(); ++i ) {
+        result.append( index.at( i ) );
+    }
+    if ( is_next && not end.isEmpty() && not ( result < end ) ) {
+        return false;
+    }
+
+    *key = result;
+    loadCell( column, row, cell );
+    return true;
+}
+
+int QtSnmpTable::findRow( const QtSnmpOid& index ) const {
+    const auto iter = std::lower_bound( m_indexes.constBegin(), m_indexes.constEnd(), index );
+    if ( ( m_indexes.constEnd() == iter ) || ( *iter != index ) ) {
+        return -1;
+    }
+    return static_cast< int >( iter - m_indexes.constBegin() );
+}
+
+int QtSnmpTable::findColumn( const quint32 number ) const {
+    for ( int i = 0; i < m_columns.size(); ++i ) {
+        if ( number == m_columns.at( i ).number ) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void QtSnmpTable::storeCell( Column& column, const int row, const QVariant& value ) {
+    column.encoder->setValue( value );
+    if ( column.is_scalar ) {
+        column.scalars[ row ] = column.encoder->scalar();
+    }
+    if ( not column.is_scalar || column.has_text ) {
+        column.data[ row ] = column.encoder->data();
+    }
+}
+
+void QtSnmpTable::loadCell( const Column& column, const int row, Cell*const cell ) {
+    cell->type = column.description.type();
+    cell->is_scalar = column.is_scalar;
+    cell->has_text = column.has_text;
+    cell->scalar = column.is_scalar ? column.scalars.at( row ) : 0;
+    // shares the stored octets
+    cell->data = ( not column.is_scalar || column.has_text ) ? column.data.at( row ) : QByteArray();
+}
+
+void QtSnmpTable::Cell::copyTo( QtSnmpValue*const value ) const {
+    Q_ASSERT( value->type() == type );
+    if ( has_text ) {
+        value->setReal( scalar, data );
+    } else if ( is_scalar ) {
+        value->setScalar( scalar );
+    } else {
+        value->setData( data );
+    }
+}
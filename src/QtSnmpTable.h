@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QList>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <QVariant>
+#include <QVector>
+#include "QtSnmpObjectDescription.h"
+#include "QtSnmpOid.h"
+#include "QtSnmpValidator.h"
+#include "QtSnmpValue.h"
+#include "win_export.h"
+
+// A conceptual table served below its entry OID, the objects are <entry>.<column>.<index>.
+// Cells are stored by column in arrays ordered by the row index, so a walk of a column
+// reads contiguous memory; a row is added or removed by one move of the following rows.
+// All methods are thread safe.
+class WIN_EXPORT QtSnmpTable {
+    Q_DISABLE_COPY( QtSnmpTable )
+
+public:
+    // The OIDs of the columns are <entry>.<column> with the same entry
+    explicit QtSnmpTable( const QList< QtSnmpObjectDescription >& columns );
+
+    bool isValid() const;
+    QString oid() const;
+    QtSnmpOid entry() const;
+    int columnCount() const;
+    int rowCount() const;
+
+    // Values in the order of the column numbers, an existing row is replaced as a whole
+    bool setRow( const QString& index, const QVariantList& values );
+    bool setRow( const quint32 index, const QVariantList& values );
+    bool removeRow( const QString& index );
+    bool removeRow( const quint32 index );
+    bool setValue( const QString& index, const quint32 column, const QVariant& value );
+    QVariant value( const QString& index, const quint32 column ) const;
+    void clear();
+
+    // A cell in its stored form, copied out of the column without allocating
+    struct Cell {
+        QtSnmpObjectDescription::Type type = QtSnmpObjectDescription::LimitOfTypes;
+        bool is_scalar = true;
+        bool has_text = false;
+        quint64 scalar = 0;
+        QByteArray data;
+
+        // the value must have the type of the cell, e.g. one on the stack of the encoder
+        void copyTo( QtSnmpValue*const value ) const;
+    };
+
+    // the cell at the OID, or the first one after it before end
+    bool findCell( const QtSnmpOid& start,
+                   const bool is_next,
+                   const bool include,
+                   const QtSnmpOid& end,
+                   QtSnmpOid*const key,
+                   Cell*const cell ) const;
+
+private:
+    struct Column {
+        quint32 number;
+        QtSnmpObjectDescription description;
+        QtSnmpValidator validator;
+        // converts values into the stored form, used under the write lock
+        QSharedPointer< QtSnmpValue > encoder;
+        bool is_scalar;
+        // a real keeps its text next to its bits
+        bool has_text;
+        QVector< quint64 > scalars;
+        QVector< QByteArray > data;
+    };
+
+    bool setRow( const QtSnmpOid& index, const QVariantList& values );
+    bool removeRow( const QtSnmpOid& index );
+    int findRow( const QtSnmpOid& index ) const;
+    int findColumn( const quint32 number ) const;
+    void storeCell( Column&, const int row, const QVariant& value );
+    static void loadCell( const Column&, const int row, Cell*const );
+
+private:
+    mutable QReadWriteLock m_lock;
+    QtSnmpOid m_entry;
+    bool m_is_valid = false;
+    // ordered
+    QVector< QtSnmpOid > m_indexes;
+    // ordered by the column numbers
+    QVector< Column > m_columns;
+};
@@ -0,0 +1,193 @@
+#include "QtSnmpValidator.h"
+#include <QDebug>
+#include <algorithm>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+QtSnmpValidator::QtSnmpValidator( const QtSnmpObjectDescription& description )
+    : m_type( description.type() )
+    , m_has_limits( description.hasLimits() )
+{
+    bool ok = true;
+    switch ( m_type ) {
+    case QtSnmpObjectDescription::TypeInterger:
+        if ( m_has_limits ) {
+            bool min_ok, max_ok;
+            m_limits.integer.minimum = description.mininum().toInt( &min_ok );
+            m_limits.integer.maximum = description.maximum().toInt( &max_ok );
+            ok = min_ok && max_ok;
+            if ( ok && description.hasStep() ) {
+                m_limits.integer.step = description.step().toInt( &ok );
+                m_has_step = ok && ( 0 != m_limits.integer.step );
+            }
+        }
+        break;
+    case QtSnmpObjectDescription::TypeEnum:
+        for ( const QVariant& available_value : description.availableValues() ) {
+            bool value_ok;
+            m_available_values << available_value.toInt( &value_ok );
+            ok = ok && value_ok;
+        }
+        std::sort( m_available_values.begin(), m_available_values.end() );
+        break;
+    case QtSnmpObjectDescription::TypeUnsigned:
+    case QtSnmpObjectDescription::TypeCounter:
+    case QtSnmpObjectDescription::TypeGauge:
+        if ( m_has_limits ) {
+            bool min_ok, max_ok;
+            m_limits.unsigned_integer.minimum = description.mininum().toUInt( &min_ok );
+            m_limits.unsigned_integer.maximum = description.maximum().toUInt( &max_ok );
+            ok = min_ok && max_ok;
+            if ( ok && description.hasStep() ) {
+                m_limits.unsigned_integer.step = description.step().toUInt( &ok );
+                m_has_step = ok && ( 0 != m_limits.unsigned_integer.step );
+            }
+        }
+        break;
+    case QtSnmpObjectDescription::TypeCounter64:
+        if ( m_has_limits ) {
+            bool min_ok, max_ok;
+            m_limits.unsigned_integer.minimum = description.mininum().toULongLong( &min_ok );
+            m_limits.unsigned_integer.maximum = description.maximum().toULongLong( &max_ok );
+            ok = min_ok && max_ok;
+            if ( ok && description.hasStep() ) {
+                m_limits.unsigned_integer.step = description.step().toULongLong( &ok );
+                m_has_step = ok && ( 0 != m_limits.unsigned_integer.step );
+            }
+        }
+        break;
+    case QtSnmpObjectDescription::TypeReal:
+    case QtSnmpObjectDescription::TypeFloat:
+    case QtSnmpObjectDescription::TypeDouble:
+        if ( m_has_limits ) {
+            bool min_ok, max_ok;
+            m_limits.real.minimum = description.mininum().toDouble( &min_ok );
+            m_limits.real.maximum = description.maximum().toDouble( &max_ok );
+            ok = min_ok && max_ok;
+            if ( ok && description.hasStep() ) {
+                m_limits.real.step = description.step().toDouble( &ok );
+                m_has_step = ok && ( 0 != m_limits.real.step );
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    m_is_consistent = ok;
+}
+
+QtSnmpObjectDescription::Type QtSnmpValidator::type() const {
+    return m_type;
+}
+
+bool QtSnmpValidator::check( const QVariant& value ) const {
+    switch ( m_type ) {
+    case QtSnmpObjectDescription::TypeInterger:
+    case QtSnmpObjectDescription::TypeEnum:
+        return value.canConvert( QVariant::Int ) && checkInteger( value.toInt() );
+    case QtSnmpObjectDescription::TypeUnsigned:
+    case QtSnmpObjectDescription::TypeCounter:
+    case QtSnmpObjectDescription::TypeGauge:
+        return value.canConvert( QVariant::UInt ) && checkUnsigned( value.toUInt() );
+    case QtSnmpObjectDescription::TypeCounter64:
+        return value.canConvert( QVariant::ULongLong ) && checkUnsigned( value.toULongLong() );
+    case QtSnmpObjectDescription::TypeReal:
+    case QtSnmpObjectDescription::TypeFloat:
+    case QtSnmpObjectDescription::TypeDouble:
+        return value.canConvert( QVariant::Double ) && checkReal( value.toDouble() );
+    case QtSnmpObjectDescription::TypeIpAddress:
+    case QtSnmpObjectDescription::TypeTimeTicks:
+        // every 32-bit value is a valid address or a valid amount of ticks
+        return value.canConvert( QVariant::UInt );
+    case QtSnmpObjectDescription::TypeString:
+        return value.canConvert( QVariant::String );
+    default:
+        qWarning() << Q_FUNC_INFO << "unsupported type(" << static_cast< int >( m_type ) << ")";
+        break;
+    }
+    return false;
+}
+
+bool QtSnmpValidator::checkInteger( const qint64 value ) const {
+    if ( not m_is_consistent ) {
+        return false;
+    }
+
+    if ( QtSnmpObjectDescription::TypeEnum == m_type ) {
+        return std::binary_search( m_available_values.constBegin(), m_available_values.constEnd(), value );
+    }
+
+    if ( m_has_limits ) {
+        if ( ( value < m_limits.integer.minimum ) || ( value > m_limits.integer.maximum ) ) {
+            return false;
+        }
+        if ( m_has_step && ( 0 != ( ( value - m_limits.integer.minimum ) % m_limits.integer.step ) ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QtSnmpValidator::checkUnsigned( const quint64 value ) const {
+    if ( not m_is_consistent ) {
+        return false;
+    }
+
+    if ( m_has_limits ) {
+        if ( ( value < m_limits.unsigned_integer.minimum ) || ( value > m_limits.unsigned_integer.maximum ) ) {
+            return false;
+        }
+        if ( m_has_step && ( 0 != ( ( value - m_limits.unsigned_integer.minimum ) % m_limits.unsigned_integer.step ) ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QtSnmpValidator::checkReal( const double value ) const {
+    if ( not m_is_consistent ) {
+        return false;
+    }
+    // a finite double out of the range of a float would become an infinity
+    if ( ( QtSnmpObjectDescription::TypeFloat == m_type ) && ( fabs( value ) > FLT_MAX ) && ( fabs( value ) <= DBL_MAX ) ) {
+        return false;
+    }
+
+    if ( m_has_limits ) {
+        if ( ( value < m_limits.real.minimum ) || ( value > m_limits.real.maximum ) ) {
+            return false;
+        }
+        if ( m_has_step ) {
+            const double double_coef = fabs( value - m_limits.real.minimum ) / m_limits.real.step;
+            const double diff = double_coef - floor( double_coef );
+            const double maximum_diff = 0.0000000001;
+            return diff < maximum_diff;
+        }
+    }
+    return true;
+}
+
+bool operator==( const QtSnmpValidator& left, const QtSnmpValidator& right ) {
+    return ( left.m_type == right.m_type )
+           && ( left.m_is_consistent == right.m_is_consistent )
+           && ( left.m_has_limits == right.m_has_limits )
+           && ( left.m_has_step == right.m_has_step )
+           && ( 0 == memcmp( &left.m_limits, &right.m_limits, sizeof( left.m_limits ) ) )
+           && ( left.m_available_values == right.m_available_values );
+}
+
+bool operator!=( const QtSnmpValidator& left, const QtSnmpValidator& right ) {
+    return not ( left == right );
+}
+
+uint qHash( const QtSnmpValidator& validator, uint seed ) {
+    seed = qHashBits( &validator.m_limits, sizeof( validator.m_limits ), seed );
+    seed = qHashBits( validator.m_available_values.constData(),
+                      static_cast< size_t >( validator.m_available_values.size() ) * sizeof( qint64 ),
+                      seed );
+    return seed ^ qHash( ( static_cast< int >( validator.m_type ) << 3 )
+                         | ( validator.m_is_consistent ? 4 : 0 )
+                         | ( validator.m_has_limits ? 2 : 0 )
+                         | ( validator.m_has_step ? 1 : 0 ) );
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QVariant>
+#include <QVector>
+#include "QtSnmpObjectDescription.h"
+#include "win_export.h"
+
+// Constraints of a description converted once into native types, so checks
+// on the SET and setValue() paths do not convert QVariants any more.
+class WIN_EXPORT QtSnmpValidator {
+public:
+    QtSnmpValidator() = default;
+    explicit QtSnmpValidator( const QtSnmpObjectDescription& );
+
+    QtSnmpObjectDescription::Type type() const;
+
+    bool check( const QVariant& ) const;
+    bool checkInteger( const qint64 ) const;
+    bool checkUnsigned( const quint64 ) const;
+    bool checkReal( const double ) const;
+
+private:
+    QtSnmpObjectDescription::Type m_type = QtSnmpObjectDescription::LimitOfTypes;
+    // false if the constraints can not be represented by the type of the object
+    bool m_is_consistent = true;
+    bool m_has_limits = false;
+    bool m_has_step = false;
+    // only the block of the type of the object is used
+    union Limits {
+        struct {
+            qint64 minimum;
+            qint64 maximum;
+            qint64 step;
+        } integer;
+        struct {
+            quint64 minimum;
+            quint64 maximum;
+            quint64 step;
+        } unsigned_integer;
+        struct {
+            double minimum;
+            double maximum;
+            double step;
+        } real;
+    };
+    Limits m_limits = {};
+    QVector< qint64 > m_available_values;
+
+    friend WIN_EXPORT bool operator==( const QtSnmpValidator&, const QtSnmpValidator& );
+    friend WIN_EXPORT uint qHash( const QtSnmpValidator&, uint seed );
+};
+
+// Validators with the same constraints are equal, so objects may share one
+WIN_EXPORT bool operator==( const QtSnmpValidator&, const QtSnmpValidator& );
+WIN_EXPORT bool operator!=( const QtSnmpValidator&, const QtSnmpValidator& );
+WIN_EXPORT uint qHash( const QtSnmpValidator&, uint seed = 0 );
@@ -0,0 +1,232 @@
+#include "QtSnmpValue.h"
+#include <QHostAddress>
+#include <QThread>
+#include <QtEndian>
+#include <string.h>
+
+namespace {
+    // attempts on a held lock before the thread gives up its time slice
+    const int lock_spins = 64;
+
+    quint64 fromDouble( const double value ) {
+        quint64 result;
+        memcpy( &result, &value, sizeof( result ) );
+        return result;
+    }
+
+    double toDouble( const quint64 value ) {
+        double result;
+        memcpy( &result, &value, sizeof( result ) );
+        return result;
+    }
+
+    quint32 toIpAddress( const QVariant& value ) {
+        if ( QVariant::String == value.type() ) {
+            bool ok;
+            const quint32 result = QHostAddress( value.toString() ).toIPv4Address( &ok );
+            if ( ok ) {
+                return result;
+            }
+        }
+        return value.toUInt();
+    }
+
+    QtSnmpValue::AsnType toAsnType( const QtSnmpObjectDescription::Type type ) {
+        switch ( type ) {
+        case QtSnmpObjectDescription::TypeInterger:
+        case QtSnmpObjectDescription::TypeEnum:
+            return QtSnmpValue::AsnInteger;
+        case QtSnmpObjectDescription::TypeUnsigned:
+        case QtSnmpObjectDescription::TypeGauge:
+            return QtSnmpValue::AsnGauge;
+        case QtSnmpObjectDescription::TypeCounter:
+            return QtSnmpValue::AsnCounter;
+        case QtSnmpObjectDescription::TypeTimeTicks:
+            return QtSnmpValue::AsnTimeTicks;
+        case QtSnmpObjectDescription::TypeIpAddress:
+            return QtSnmpValue::AsnIpAddress;
+        case QtSnmpObjectDescription::TypeCounter64:
+            return QtSnmpValue::AsnCounter64;
+        case QtSnmpObjectDescription::TypeFloat:
+        case QtSnmpObjectDescription::TypeDouble:
+            return QtSnmpValue::AsnOpaque;
+        default:
+            break;
+        }
+        return QtSnmpValue::AsnOctetString;
+    }
+}
+
+QtSnmpValue::QtSnmpValue( const QtSnmpObjectDescription::Type type )
+    : m_type( type )
+    , m_asn_type( toAsnType( type ) )
+{
+    if ( QtSnmpObjectDescription::TypeReal == m_type ) {
+        m_data = QByteArray::number( 0.0, 'g', 9 );
+    }
+}
+
+QtSnmpObjectDescription::Type QtSnmpValue::type() const {
+    return m_type;
+}
+
+QtSnmpValue::AsnType QtSnmpValue::asnType() const {
+    return m_asn_type;
+}
+
+bool QtSnmpValue::isScalar() const {
+    return AsnOctetString != m_asn_type;
+}
+
+void QtSnmpValue::setScalar( const quint64 value ) {
+    m_scalar.storeRelease( value );
+}
+
+quint64 QtSnmpValue::scalar() const {
+    return m_scalar.loadAcquire();
+}
+
+void QtSnmpValue::setData( const QByteArray& data ) {
+    QByteArray previous = data;
+    lockData();
+    m_data.swap( previous );
+    unlockData();
+    // the replaced value is released here, outside of the critical section
+}
+
+QByteArray QtSnmpValue::data() const {
+    lockData();
+    const QByteArray result = m_data;
+    unlockData();
+    return result;
+}
+
+void QtSnmpValue::setInteger( const qint64 value ) {
+    setScalar( static_cast< quint64 >( value ) );
+}
+
+qint64 QtSnmpValue::integer() const {
+    return static_cast< qint64 >( scalar() );
+}
+
+void QtSnmpValue::setUnsigned( const quint64 value ) {
+    if ( AsnIpAddress == m_asn_type ) {
+        setScalar( qToBigEndian( static_cast< quint32 >( value ) ) );
+    } else {
+        setScalar( value );
+    }
+}
+
+quint64 QtSnmpValue::unsignedInteger() const {
+    if ( AsnIpAddress == m_asn_type ) {
+        return qFromBigEndian( static_cast< quint32 >( scalar() ) );
+    }
+    return scalar();
+}
+
+void QtSnmpValue::setReal( const double value ) {
+    switch ( m_type ) {
+    case QtSnmpObjectDescription::TypeFloat:
+        setScalar( fromDouble( static_cast< float >( value ) ) );
+        break;
+    case QtSnmpObjectDescription::TypeReal:
+        // formatted once here instead of on every read
+        setReal( fromDouble( value ), QByteArray::number( value, 'g', 9 ) );
+        break;
+    default:
+        setScalar( fromDouble( value ) );
+        break;
+    }
+}
+
+void QtSnmpValue::setReal( const quint64 bits, const QByteArray& text ) {
+    QByteArray previous = text;
+    lockData();
+    m_scalar.storeRelease( bits );
+    m_data.swap( previous );
+    unlockData();
+}
+
+double QtSnmpValue::real() const {
+    return toDouble( scalar() );
+}
+
+void QtSnmpValue::setString( const QByteArray& value ) {
+    setData( value );
+}
+
+QByteArray QtSnmpValue::string() const {
+    return data();
+}
+
+void QtSnmpValue::setValue( const QVariant& value ) {
+    switch ( m_type ) {
+    case QtSnmpObjectDescription::TypeInterger:
+    case QtSnmpObjectDescription::TypeEnum:
+        setInteger( value.toInt() );
+        break;
+    case QtSnmpObjectDescription::TypeUnsigned:
+    case QtSnmpObjectDescription::TypeCounter:
+    case QtSnmpObjectDescription::TypeGauge:
+    case QtSnmpObjectDescription::TypeTimeTicks:
+        setUnsigned( value.toUInt() );
+        break;
+    case QtSnmpObjectDescription::TypeCounter64:
+        setUnsigned( value.toULongLong() );
+        break;
+    case QtSnmpObjectDescription::TypeReal:
+    case QtSnmpObjectDescription::TypeFloat:
+    case QtSnmpObjectDescription::TypeDouble:
+        setReal( value.toDouble() );
+        break;
+    case QtSnmpObjectDescription::TypeIpAddress:
+        setUnsigned( toIpAddress( value ) );
+        break;
+    case QtSnmpObjectDescription::TypeString:
+        setString( value.toString().toLocal8Bit() );
+        break;
+    default:
+        break;
+    }
+}
+
+QVariant QtSnmpValue::value() const {
+    switch ( m_type ) {
+    case QtSnmpObjectDescription::TypeInterger:
+    case QtSnmpObjectDescription::TypeEnum:
+        return static_cast< int >( integer() );
+    case QtSnmpObjectDescription::TypeUnsigned:
+    case QtSnmpObjectDescription::TypeCounter:
+    case QtSnmpObjectDescription::TypeGauge:
+    case QtSnmpObjectDescription::TypeTimeTicks:
+        return static_cast< uint >( unsignedInteger() );
+    case QtSnmpObjectDescription::TypeCounter64:
+        return static_cast< qulonglong >( unsignedInteger() );
+    case QtSnmpObjectDescription::TypeReal:
+    case QtSnmpObjectDescription::TypeFloat:
+    case QtSnmpObjectDescription::TypeDouble:
+        return real();
+    case QtSnmpObjectDescription::TypeIpAddress:
+        return QHostAddress( static_cast< quint32 >( unsignedInteger() ) ).toString();
+    case QtSnmpObjectDescription::TypeString:
+        return QString::fromLocal8Bit( string() );
+    default:
+        break;
+    }
+    return {};
+}
+
+void QtSnmpValue::lockData() const {
+    int spins = 0;
+    while ( not m_data_lock.testAndSetAcquire( 0, 1 ) ) {
+        // the holder may have been preempted, it gets the core instead of a spinning thread
+        if ( ++spins >= lock_spins ) {
+            QThread::yieldCurrentThread();
+            spins = 0;
+        }
+    }
+}
+
+void QtSnmpValue::unlockData() const {
+    m_data_lock.storeRelease( 0 );
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QVariant>
+#include <QByteArray>
+#include <QAtomicInteger>
+#include "QtSnmpObjectDescription.h"
+#include "win_export.h"
+
+// Holds the current value of one object; any thread may publish or read it.
+// Fixed-size values live in a single atomic word, so they are published and
+// read without locks. Octet strings are not lock-free: they are prepared by
+// the producer and swapped in under a per-value spin lock held only for the
+// swap or for a reference count update, so readers always see either the old
+// or the new value as a whole. A thread which finds the lock held yields after
+// a few attempts.
+// Values are kept in their wire form, encoded once when they are published.
+class WIN_EXPORT QtSnmpValue {
+    Q_DISABLE_COPY( QtSnmpValue )
+
+public:
+    enum AsnType : quint8 {
+        AsnInteger = 0x02,
+        AsnOctetString = 0x04,
+        AsnIpAddress = 0x40,
+        AsnCounter = 0x41,
+        AsnGauge = 0x42,
+        AsnTimeTicks = 0x43,
+        AsnOpaque = 0x44,
+        AsnCounter64 = 0x46
+    };
+
+public:
+    explicit QtSnmpValue( const QtSnmpObjectDescription::Type );
+
+    QtSnmpObjectDescription::Type type() const;
+    AsnType asnType() const;
+    bool isScalar() const;
+
+    // integers in host order, an IP address in network order, the bits of a real, a float or a double
+    void setScalar( const quint64 );
+    quint64 scalar() const;
+
+    // the octets of a string or the text of a real, a float or a double has no text
+    void setData( const QByteArray& );
+    QByteArray data() const;
+
+    // typed access, the caller must match the type of the object
+    void setInteger( const qint64 );
+    qint64 integer() const;
+    void setUnsigned( const quint64 );
+    quint64 unsignedInteger() const;
+    void setReal( const double );
+    double real() const;
+    // the bits of a real with its text, published together so data() always matches them
+    void setReal( const quint64 bits, const QByteArray& text );
+    void setString( const QByteArray& );
+    QByteArray string() const;
+
+    void setValue( const QVariant& );
+    QVariant value() const;
+
+private:
+    void lockData() const;
+    void unlockData() const;
+
+private:
+    const QtSnmpObjectDescription::Type m_type;
+    const AsnType m_asn_type;
+    QAtomicInteger< quint64 > m_scalar;
+    mutable QAtomicInt m_data_lock;
+    QByteArray m_data;
+};
@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_agentx
+SOURCES *= $${PWD}/tst_agentx.cpp
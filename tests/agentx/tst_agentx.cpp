@@ -0,0 +1,319 @@
+#include <QtTest>
+#include <QAtomicInt>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpTable.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// The AgentX backend against the PDUs of an independent encoder: reads, the phases of a SET
+// with their errors, tables and PDUs the subagent does not serve
+class tst_AgentX : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void get();
+    Q_SLOT void getNext();
+    Q_SLOT void getBulk();
+    Q_SLOT void setPhases();
+    Q_SLOT void undoSet();
+    Q_SLOT void setErrors_data();
+    Q_SLOT void setErrors();
+    Q_SLOT void setErrorIndex();
+    Q_SLOT void rejectedTransaction();
+    Q_SLOT void unknownTransaction();
+    Q_SLOT void unsupportedPdu();
+    Q_SLOT void tableWalk();
+
+private:
+    QVector< QtSnmpFakeMaster::Varbind > walk( const QtSnmpOid& prefix );
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+    QSharedPointer< QtSnmpTable > m_table;
+};
+
+namespace {
+    const QString writable_integer = QtSnmpTestSupport::objectOid( 1, 1 );
+    const QString writable_string = QtSnmpTestSupport::objectOid( 1, 2 );
+    const QString read_only_gauge = QtSnmpTestSupport::objectOid( 1, 3 );
+    const QString missing_object = QtSnmpTestSupport::objectOid( 1, 9 );
+    const char*const table_entry = ".1.3.6.1.4.1.99999.2.1";
+    const int integer_limit = 100;
+
+    QtSnmpOid key( const QString& oid ) {
+        return QtSnmpOid::fromString( oid );
+    }
+
+    QtSnmpOid cell( const int column, const int row ) {
+        return QtSnmpOid::fromString( QString( "%1.%2.%3" ).arg( table_entry ).arg( column ).arg( row ) );
+    }
+}
+
+void tst_AgentX::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_agentx" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_agentx" );
+
+    QtSnmpObjectDescription integer( writable_integer, QtSnmpObjectDescription::TypeInterger );
+    integer.setLimits( 0, integer_limit );
+    QVERIFY( m_subagent->registerSnmpObject( integer, 10 ) );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( writable_string, QtSnmpObjectDescription::TypeString ),
+                                             "initial" ) );
+    QtSnmpObjectDescription gauge( read_only_gauge, QtSnmpObjectDescription::TypeGauge );
+    gauge.setReadOnly( true );
+    QVERIFY( m_subagent->registerSnmpObject( gauge, 7u ) );
+
+    m_table = m_subagent->registerSnmpTable( {
+        QtSnmpObjectDescription( QString( table_entry ) + ".1", QtSnmpObjectDescription::TypeInterger ),
+        QtSnmpObjectDescription( QString( table_entry ) + ".2", QtSnmpObjectDescription::TypeString ) } );
+    QVERIFY( not m_table.isNull() );
+    for ( quint32 row = 1; row <= 3; ++row ) {
+        QVERIFY( m_table->setRow( row, { int( row * 10 ), QString( "row %1" ).arg( row ) } ) );
+    }
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_AgentX::cleanupTestCase() {
+    m_table.clear();
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+QVector< QtSnmpFakeMaster::Varbind > tst_AgentX::walk( const QtSnmpOid& prefix ) {
+    QVector< QtSnmpFakeMaster::Varbind > result;
+    QtSnmpOid current = prefix;
+    forever {
+        const QtSnmpFakeMaster::Response response = m_master.getNext( { current } );
+        if ( not response.is_valid || response.varbinds.isEmpty()
+             || ( QtSnmpFakeMaster::TypeEndOfMibView == response.varbinds.first().type )
+             || not response.varbinds.first().oid.startsWith( prefix ) )
+        {
+            return result;
+        }
+        result << response.varbinds.first();
+        current = result.last().oid;
+    }
+}
+
+void tst_AgentX::get() {
+    const QtSnmpFakeMaster::Response response = m_master.get( { key( writable_integer ),
+                                                                key( writable_string ),
+                                                                key( read_only_gauge ),
+                                                                key( missing_object ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.index, quint16( 0 ) );
+    QCOMPARE( response.varbinds.size(), 4 );
+    // the varbinds answer the request in its order
+    QCOMPARE( response.varbinds.at( 0 ).oid, key( writable_integer ) );
+    QCOMPARE( response.varbinds.at( 0 ).type, quint16( QtSnmpFakeMaster::TypeInteger ) );
+    QCOMPARE( response.varbinds.at( 0 ).number, quint64( 10 ) );
+    QCOMPARE( response.varbinds.at( 1 ).type, quint16( QtSnmpFakeMaster::TypeOctetString ) );
+    QCOMPARE( response.varbinds.at( 1 ).octets, QByteArray( "initial" ) );
+    QCOMPARE( response.varbinds.at( 2 ).type, quint16( QtSnmpFakeMaster::TypeGauge32 ) );
+    QCOMPARE( response.varbinds.at( 2 ).number, quint64( 7 ) );
+    QCOMPARE( response.varbinds.at( 3 ).oid, key( missing_object ) );
+    QCOMPARE( response.varbinds.at( 3 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+}
+
+void tst_AgentX::getNext() {
+    // several search ranges in one PDU, the last one after everything registered
+    const QtSnmpFakeMaster::Response response = m_master.getNext( { QtSnmpOid::fromString( ".1.3.6.1.4.1.99999.1" ),
+                                                                    key( writable_string ),
+                                                                    key( read_only_gauge ),
+                                                                    QtSnmpOid::fromString( ".1.3.6.1.4.1.99999.3" ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 4 );
+    QCOMPARE( response.varbinds.at( 0 ).oid, key( writable_integer ) );
+    QCOMPARE( response.varbinds.at( 1 ).oid, key( read_only_gauge ) );
+    QCOMPARE( response.varbinds.at( 2 ).oid, cell( 1, 1 ) );
+    QCOMPARE( response.varbinds.at( 2 ).number, quint64( 10 ) );
+    QCOMPARE( response.varbinds.at( 3 ).type, quint16( QtSnmpFakeMaster::TypeEndOfMibView ) );
+}
+
+void tst_AgentX::getBulk() {
+    // one non-repeater, then three successors of the second OID
+    const QtSnmpFakeMaster::Response response = m_master.getBulk( { key( writable_integer ),
+                                                                    key( writable_string ) }, 1, 3 );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 4 );
+    QCOMPARE( response.varbinds.at( 0 ).oid, key( writable_string ) );
+    QCOMPARE( response.varbinds.at( 1 ).oid, key( read_only_gauge ) );
+    QCOMPARE( response.varbinds.at( 2 ).oid, cell( 1, 1 ) );
+    QCOMPARE( response.varbinds.at( 3 ).oid, cell( 1, 2 ) );
+    QCOMPARE( response.varbinds.at( 3 ).number, quint64( 20 ) );
+}
+
+void tst_AgentX::setPhases() {
+    const quint32 transaction_id = 1001;
+    const QtSnmpFakeMaster::Response test = m_master.testSet( { QtSnmpFakeMaster::integerVarbind( key( writable_integer ), 42 ),
+                                                                QtSnmpFakeMaster::octetStringVarbind( key( writable_string ), "set" ) },
+                                                              transaction_id );
+    QVERIFY( test.is_valid );
+    QCOMPARE( test.error, quint16( QtSnmpFakeMaster::NoError ) );
+    // nothing is written before the commit
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), 10 );
+
+    const QtSnmpFakeMaster::Response commit = m_master.commitSet( transaction_id );
+    QVERIFY( commit.is_valid );
+    QCOMPARE( commit.error, quint16( QtSnmpFakeMaster::NoError ) );
+    m_master.cleanupSet( transaction_id );
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), 42 );
+    QCOMPARE( m_subagent->value( writable_string ).toString(), QString( "set" ) );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { key( writable_integer ), key( writable_string ) } );
+    QCOMPARE( response.varbinds.value( 0 ).number, quint64( 42 ) );
+    QCOMPARE( response.varbinds.value( 1 ).octets, QByteArray( "set" ) );
+}
+
+void tst_AgentX::undoSet() {
+    QCOMPARE( m_master.set( { QtSnmpFakeMaster::integerVarbind( key( writable_integer ), 50 ) } ).error,
+              quint16( QtSnmpFakeMaster::NoError ) );
+
+    QAtomicInt undone( 0 );
+    const QMetaObject::Connection connection =
+        connect( m_subagent, &QtSnmpSubagent::snmpSetTransactionUndone, m_subagent, [ &undone ]( const quint64 ) {
+            undone.ref();
+        }, Qt::DirectConnection );
+
+    // another subagent of the PDU has failed its commit, the master undoes this one
+    const quint32 transaction_id = 1002;
+    QCOMPARE( m_master.testSet( { QtSnmpFakeMaster::integerVarbind( key( writable_integer ), 60 ) }, transaction_id ).error,
+              quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_master.commitSet( transaction_id ).error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), 60 );
+    const QtSnmpFakeMaster::Response undo = m_master.undoSet( transaction_id );
+    m_master.cleanupSet( transaction_id );
+    disconnect( connection );
+
+    QVERIFY( undo.is_valid );
+    QCOMPARE( undo.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), 50 );
+    QCOMPARE( undone.load(), 1 );
+}
+
+void tst_AgentX::setErrors_data() {
+    QTest::addColumn< QString >( "oid" );
+    QTest::addColumn< bool >( "is_string" );
+    QTest::addColumn< int >( "value" );
+    QTest::addColumn< int >( "error" );
+
+    QTest::newRow( "wrong type" ) << writable_integer << true << 42 << int( QtSnmpFakeMaster::WrongType );
+    QTest::newRow( "above the limit" ) << writable_integer << false << integer_limit + 1 << int( QtSnmpFakeMaster::WrongValue );
+    QTest::newRow( "below the limit" ) << writable_integer << false << -1 << int( QtSnmpFakeMaster::WrongValue );
+    QTest::newRow( "read only" ) << read_only_gauge << false << 1 << int( QtSnmpFakeMaster::NotWritable );
+    QTest::newRow( "table cell" ) << QString( table_entry ) + ".1.1" << false << 1 << int( QtSnmpFakeMaster::NotWritable );
+    QTest::newRow( "missing" ) << missing_object << false << 1 << int( QtSnmpFakeMaster::NoCreation );
+}
+
+void tst_AgentX::setErrors() {
+    QFETCH( QString, oid );
+    QFETCH( bool, is_string );
+    QFETCH( int, value );
+    QFETCH( int, error );
+
+    const QVariant before = m_subagent->value( oid );
+    const QtSnmpFakeMaster::Response response = m_master.set( {
+        is_string ? QtSnmpFakeMaster::octetStringVarbind( key( oid ), QByteArray::number( value ) )
+                  : QtSnmpFakeMaster::integerVarbind( key( oid ), value ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( int( response.error ), error );
+    QCOMPARE( response.index, quint16( 1 ) );
+    QCOMPARE( m_subagent->value( oid ), before );
+}
+
+void tst_AgentX::setErrorIndex() {
+    const int before = m_subagent->value( writable_integer ).toInt();
+    // the index names the failed varbind and the PDU is not applied in part
+    const QtSnmpFakeMaster::Response response = m_master.set( {
+        QtSnmpFakeMaster::integerVarbind( key( writable_integer ), before + 1 ),
+        QtSnmpFakeMaster::integerVarbind( key( missing_object ), 1 ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoCreation ) );
+    QCOMPARE( response.index, quint16( 2 ) );
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), before );
+    QVERIFY( not m_subagent->value( missing_object ).isValid() );
+}
+
+void tst_AgentX::rejectedTransaction() {
+    const int before = m_subagent->value( writable_integer ).toInt();
+    QAtomicInt transactions( 0 );
+    const QMetaObject::Connection connection =
+        connect( m_subagent, &QtSnmpSubagent::snmpSetTransaction, m_subagent,
+                 [ this, &transactions ]( const quint64 transaction_id, const QStringList& oids, const QVariantList& values ) {
+            // the application sees the whole PDU before it decides
+            if ( ( ( QStringList() << writable_integer ) == oids ) && ( 1 == values.size() ) && ( 77 == values.first().toInt() ) ) {
+                transactions.ref();
+            }
+            m_subagent->completeSetTransaction( transaction_id, false );
+        }, Qt::DirectConnection );
+    const QtSnmpFakeMaster::Response response = m_master.set( { QtSnmpFakeMaster::integerVarbind( key( writable_integer ), 77 ) } );
+    disconnect( connection );
+
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::CommitFailed ) );
+    QCOMPARE( transactions.load(), 1 );
+    QCOMPARE( m_subagent->value( writable_integer ).toInt(), before );
+}
+
+void tst_AgentX::unknownTransaction() {
+    QCOMPARE( m_master.commitSet( 4242 ).error, quint16( QtSnmpFakeMaster::CommitFailed ) );
+    QCOMPARE( m_master.undoSet( 4242 ).error, quint16( QtSnmpFakeMaster::UndoFailed ) );
+}
+
+void tst_AgentX::unsupportedPdu() {
+    // a subagent pings its master, it does not answer pings
+    QtSnmpFakeMaster::Response response;
+    QVERIFY( m_master.execute( QtSnmpFakeMaster::emptyRequest( QtSnmpFakeMaster::PduPing ), &response ) );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::ProcessingError ) );
+    // the session goes on
+    QCOMPARE( m_master.get( { key( read_only_gauge ) } ).varbinds.value( 0 ).number, quint64( 7 ) );
+}
+
+void tst_AgentX::tableWalk() {
+    const QtSnmpOid entry = QtSnmpOid::fromString( table_entry );
+    // column by column, the rows in the order of their indexes
+    QVector< QtSnmpFakeMaster::Varbind > cells = walk( entry );
+    QCOMPARE( cells.size(), 6 );
+    for ( int row = 1; row <= 3; ++row ) {
+        QCOMPARE( cells.at( row - 1 ).oid, cell( 1, row ) );
+        QCOMPARE( cells.at( row - 1 ).number, quint64( row * 10 ) );
+        QCOMPARE( cells.at( row + 2 ).oid, cell( 2, row ) );
+        QCOMPARE( cells.at( row + 2 ).octets, QString( "row %1" ).arg( row ).toLatin1() );
+    }
+
+    // rows added out of order and removed are walked in order
+    QVERIFY( m_table->removeRow( 2u ) );
+    QVERIFY( m_table->setRow( 15u, { 150, QString( "row 15" ) } ) );
+    QVERIFY( m_table->setRow( 0u, { 0, QString( "row 0" ) } ) );
+    QVERIFY( m_table->setValue( "3", 2, QString( "changed" ) ) );
+    cells = walk( entry );
+    QCOMPARE( cells.size(), 8 );
+    const int rows[] = { 0, 1, 3, 15 };
+    for ( int i = 0; i < 4; ++i ) {
+        QCOMPARE( cells.at( i ).oid, cell( 1, rows[ i ] ) );
+        QCOMPARE( cells.at( i + 4 ).oid, cell( 2, rows[ i ] ) );
+    }
+    QCOMPARE( cells.at( 6 ).octets, QByteArray( "changed" ) );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { cell( 1, 15 ), cell( 1, 2 ) } );
+    QCOMPARE( response.varbinds.value( 0 ).number, quint64( 150 ) );
+    QCOMPARE( response.varbinds.value( 1 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+
+    // the entry, the column and the index of a cell fit into the longest OID
+    QStringList index;
+    while ( entry.size() + 1 + index.size() < QtSnmpOid::MaxLength ) {
+        index << "1";
+    }
+    QVERIFY( m_table->setRow( index.join( '.' ), { 1, QString( "longest" ) } ) );
+    QVERIFY( m_table->removeRow( index.join( '.' ) ) );
+    index << "1";
+    QVERIFY( not m_table->setRow( index.join( '.' ), { 1, QString( "too long" ) } ) );
+    QCOMPARE( m_table->rowCount(), 4 );
+}
+
+QTEST_GUILESS_MAIN( tst_AgentX )
+#include "tst_agentx.moc"
@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_binarytypes
+SOURCES *= $${PWD}/tst_binarytypes.cpp
@@ -0,0 +1,237 @@
+#include <QtTest>
+#include <QtEndian>
+#include <cfloat>
+#include <cstring>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Counter64 keeps all 64 bits on GET and SET; TypeFloat and TypeDouble travel as an Opaque
+// holding the net-snmp float or double extension, which the test encodes on its own
+class tst_BinaryTypes : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void counter64Get_data();
+    Q_SLOT void counter64Get();
+    Q_SLOT void counter64Set();
+    Q_SLOT void counter64Handle();
+    Q_SLOT void opaqueGet_data();
+    Q_SLOT void opaqueGet();
+    Q_SLOT void opaqueSet();
+    Q_SLOT void malformedOpaque_data();
+    Q_SLOT void malformedOpaque();
+    Q_SLOT void realLimits();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+};
+
+namespace {
+    const QString counter64_oid = QtSnmpTestSupport::objectOid( 1, 1 );
+    const QString limited_counter64_oid = QtSnmpTestSupport::objectOid( 1, 2 );
+    const QString float_oid = QtSnmpTestSupport::objectOid( 2, 1 );
+    const QString double_oid = QtSnmpTestSupport::objectOid( 2, 2 );
+    const QString limited_double_oid = QtSnmpTestSupport::objectOid( 2, 3 );
+    const quint64 counter64_limit = Q_UINT64_C( 0x10000000000 );
+
+    QByteArray opaque_float( const float value ) {
+        quint32 bits;
+        memcpy( &bits, &value, sizeof( bits ) );
+        QByteArray result( "\x9f\x78\x04", 3 );
+        result.resize( 7 );
+        qToBigEndian< quint32 >( bits, reinterpret_cast< uchar* >( result.data() ) + 3 );
+        return result;
+    }
+
+    QByteArray opaque_double( const double value ) {
+        quint64 bits;
+        memcpy( &bits, &value, sizeof( bits ) );
+        QByteArray result( "\x9f\x79\x08", 3 );
+        result.resize( 11 );
+        qToBigEndian< quint64 >( bits, reinterpret_cast< uchar* >( result.data() ) + 3 );
+        return result;
+    }
+
+    QtSnmpFakeMaster::Varbind varbind( const QString& oid, const quint16 type, const quint64 number, const QByteArray& octets ) {
+        QtSnmpFakeMaster::Varbind result;
+        result.type = type;
+        result.oid = QtSnmpOid::fromString( oid );
+        result.number = number;
+        result.octets = octets;
+        return result;
+    }
+}
+
+void tst_BinaryTypes::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_binarytypes" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_binarytypes" );
+
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( counter64_oid, QtSnmpObjectDescription::TypeCounter64 ),
+                                             QVariant::fromValue( Q_UINT64_C( 0 ) ) ) );
+    QtSnmpObjectDescription limited_counter64( limited_counter64_oid, QtSnmpObjectDescription::TypeCounter64 );
+    limited_counter64.setLimits( QVariant::fromValue( Q_UINT64_C( 0 ) ), QVariant::fromValue( counter64_limit ) );
+    QVERIFY( m_subagent->registerSnmpObject( limited_counter64, QVariant::fromValue( Q_UINT64_C( 0 ) ) ) );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( float_oid, QtSnmpObjectDescription::TypeFloat ), 0.0 ) );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( double_oid, QtSnmpObjectDescription::TypeDouble ), 0.0 ) );
+    QtSnmpObjectDescription limited_double( limited_double_oid, QtSnmpObjectDescription::TypeDouble );
+    limited_double.setLimits( -1.0, 1.0 );
+    QVERIFY( m_subagent->registerSnmpObject( limited_double, 0.0 ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_BinaryTypes::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_BinaryTypes::counter64Get_data() {
+    QTest::addColumn< quint64 >( "value" );
+
+    QTest::newRow( "zero" ) << Q_UINT64_C( 0 );
+    QTest::newRow( "32-bit maximum" ) << Q_UINT64_C( 0xFFFFFFFF );
+    QTest::newRow( "above 32 bits" ) << Q_UINT64_C( 0x100000000 );
+    QTest::newRow( "10 GbE day of bytes" ) << Q_UINT64_C( 108000000000000 );
+    QTest::newRow( "64-bit maximum" ) << Q_UINT64_C( 0xFFFFFFFFFFFFFFFF );
+}
+
+void tst_BinaryTypes::counter64Get() {
+    QFETCH( quint64, value );
+
+    m_subagent->setValue( counter64_oid, QVariant::fromValue( value ) );
+    QCOMPARE( m_subagent->value( counter64_oid ).toULongLong(), value );
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpOid::fromString( counter64_oid ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.varbinds.size(), 1 );
+    QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeCounter64 ) );
+    QCOMPARE( response.varbinds.first().number, value );
+}
+
+void tst_BinaryTypes::counter64Set() {
+    const quint64 value = Q_UINT64_C( 0x123456789 );
+    QtSnmpFakeMaster::Response response = m_master.set( { varbind( counter64_oid, QtSnmpFakeMaster::TypeCounter64, value, QByteArray() ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_subagent->value( counter64_oid ).toULongLong(), value );
+    QCOMPARE( m_master.get( { QtSnmpOid::fromString( counter64_oid ) } ).varbinds.value( 0 ).number, value );
+
+    // a 32-bit counter is not a Counter64
+    response = m_master.set( { varbind( counter64_oid, QtSnmpFakeMaster::TypeCounter32, 5, QByteArray() ) } );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::WrongType ) );
+    QCOMPARE( m_subagent->value( counter64_oid ).toULongLong(), value );
+
+    // the limits are compared with all 64 bits
+    response = m_master.set( { varbind( limited_counter64_oid, QtSnmpFakeMaster::TypeCounter64, counter64_limit, QByteArray() ) } );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    response = m_master.set( { varbind( limited_counter64_oid, QtSnmpFakeMaster::TypeCounter64, counter64_limit + 1, QByteArray() ) } );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::WrongValue ) );
+    QCOMPARE( m_subagent->value( limited_counter64_oid ).toULongLong(), counter64_limit );
+}
+
+void tst_BinaryTypes::counter64Handle() {
+    QtSnmpHandle< quint64 > handle = m_subagent->handle< quint64 >( counter64_oid );
+    QVERIFY( not handle.isNull() );
+    QVERIFY( m_subagent->handle< quint32 >( counter64_oid ).isNull() );
+
+    // a byte counter crossing the 32-bit boundary does not wrap
+    quint64 bytes = Q_UINT64_C( 0xFFFFFF00 );
+    QVERIFY( handle.set( bytes ) );
+    for ( int i = 0; i < 4; ++i ) {
+        bytes += 1500;
+        QVERIFY( handle.set( bytes ) );
+    }
+    QCOMPARE( handle.get(), Q_UINT64_C( 0xFFFFFF00 ) + 6000 );
+    QCOMPARE( m_master.get( { QtSnmpOid::fromString( counter64_oid ) } ).varbinds.value( 0 ).number, bytes );
+
+    QtSnmpHandle< quint64 > limited = m_subagent->handle< quint64 >( limited_counter64_oid );
+    QVERIFY( not limited.set( counter64_limit + 1 ) );
+    QCOMPARE( limited.get(), counter64_limit );
+}
+
+void tst_BinaryTypes::opaqueGet_data() {
+    QTest::addColumn< bool >( "is_float" );
+    QTest::addColumn< double >( "value" );
+
+    QTest::newRow( "float" ) << true << 1.5;
+    QTest::newRow( "float fraction" ) << true << -0.1;
+    QTest::newRow( "float large" ) << true << 1e30;
+    QTest::newRow( "double" ) << false << 1.5;
+    QTest::newRow( "double fraction" ) << false << -0.1;
+    QTest::newRow( "double large" ) << false << 1e300;
+    QTest::newRow( "double tiny" ) << false << 4.9e-324;
+}
+
+void tst_BinaryTypes::opaqueGet() {
+    QFETCH( bool, is_float );
+    QFETCH( double, value );
+
+    const QString oid = is_float ? float_oid : double_oid;
+    m_subagent->setValue( oid, value );
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpOid::fromString( oid ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.varbinds.size(), 1 );
+    QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeOpaque ) );
+    QCOMPARE( response.varbinds.first().octets, is_float ? opaque_float( float( value ) ) : opaque_double( value ) );
+    // a float keeps the precision of a float
+    QCOMPARE( m_subagent->value( oid ).toDouble(), is_float ? double( float( value ) ) : value );
+}
+
+void tst_BinaryTypes::opaqueSet() {
+    QtSnmpFakeMaster::Response response = m_master.set( {
+        varbind( float_oid, QtSnmpFakeMaster::TypeOpaque, 0, opaque_float( 2.75f ) ),
+        varbind( double_oid, QtSnmpFakeMaster::TypeOpaque, 0, opaque_double( 3.141592653589793 ) ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_subagent->value( float_oid ).toDouble(), 2.75 );
+    QCOMPARE( m_subagent->value( double_oid ).toDouble(), 3.141592653589793 );
+
+    // the binary value is not sent as text
+    response = m_master.set( { QtSnmpFakeMaster::octetStringVarbind( QtSnmpOid::fromString( double_oid ), "1.0" ) } );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::WrongType ) );
+    QCOMPARE( m_subagent->value( double_oid ).toDouble(), 3.141592653589793 );
+}
+
+void tst_BinaryTypes::malformedOpaque_data() {
+    QTest::addColumn< QString >( "oid" );
+    QTest::addColumn< QByteArray >( "octets" );
+
+    const QByteArray valid_double = opaque_double( 0.5 );
+    QTest::newRow( "double into a float" ) << float_oid << valid_double;
+    QTest::newRow( "float into a double" ) << double_oid << opaque_float( 0.5f );
+    QTest::newRow( "truncated" ) << double_oid << valid_double.left( 10 );
+    QTest::newRow( "trailing octet" ) << double_oid << ( valid_double + '\0' );
+    QTest::newRow( "wrong tag" ) << double_oid << ( QByteArray( "\x9e", 1 ) + valid_double.mid( 1 ) );
+    QTest::newRow( "wrong length" ) << double_oid << ( valid_double.left( 2 ) + QByteArray( "\x04", 1 ) + valid_double.mid( 3 ) );
+    QTest::newRow( "empty" ) << float_oid << QByteArray();
+}
+
+void tst_BinaryTypes::malformedOpaque() {
+    QFETCH( QString, oid );
+    QFETCH( QByteArray, octets );
+
+    const double before = m_subagent->value( oid ).toDouble();
+    const QtSnmpFakeMaster::Response response = m_master.set( { varbind( oid, QtSnmpFakeMaster::TypeOpaque, 0, octets ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::WrongValue ) );
+    QCOMPARE( m_subagent->value( oid ).toDouble(), before );
+}
+
+void tst_BinaryTypes::realLimits() {
+    QCOMPARE( m_master.set( { varbind( limited_double_oid, QtSnmpFakeMaster::TypeOpaque, 0, opaque_double( 0.75 ) ) } ).error,
+              quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( m_master.set( { varbind( limited_double_oid, QtSnmpFakeMaster::TypeOpaque, 0, opaque_double( 1.25 ) ) } ).error,
+              quint16( QtSnmpFakeMaster::WrongValue ) );
+    QCOMPARE( m_subagent->value( limited_double_oid ).toDouble(), 0.75 );
+
+    // a double beyond the range of a float is refused rather than stored as an infinity
+    QtSnmpHandle< double > handle = m_subagent->handle< double >( float_oid );
+    QVERIFY( not handle.isNull() );
+    QVERIFY( handle.set( double( FLT_MAX ) ) );
+    QVERIFY( not handle.set( 1e39 ) );
+    QCOMPARE( handle.get(), double( FLT_MAX ) );
+}
+
+QTEST_GUILESS_MAIN( tst_BinaryTypes )
+#include "tst_binarytypes.moc"
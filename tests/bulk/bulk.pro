@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_bulk
+SOURCES *= $${PWD}/tst_bulk.cpp
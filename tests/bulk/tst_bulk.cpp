@@ -0,0 +1,185 @@
+#include <QtTest>
+#include <algorithm>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// registerSnmpObjects() registers runs of adjacent objects as AgentX ranges and
+// unregisterSnmpSubtree() removes every object below a prefix with its registrations
+class tst_Bulk : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void coalescedRegistrations();
+    Q_SLOT void valuesOfTheList();
+    Q_SLOT void registerAfterStart();
+    Q_SLOT void alreadyRegistered();
+    Q_SLOT void invalidList();
+    Q_SLOT void unregisterSubtree();
+
+private:
+    const QtSnmpFakeMaster::Registration* findRegistration( const QtSnmpOid& root ) const;
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+    QVector< QtSnmpFakeMaster::Registration > m_registrations;
+};
+
+namespace {
+    const char*const enterprise = ".1.3.6.1.4.1.99999";
+    // the sub-identifier of the index in QtSnmpTestSupport::objectOid() as AgentX counts it, from 1
+    const quint8 index_subid = 9;
+
+    QtSnmpOid oid( const QString& suffix ) {
+        return QtSnmpOid::fromString( enterprise + suffix );
+    }
+
+    QPair< QtSnmpObjectDescription, QVariant > integer( const QString& oid, const int value ) {
+        return qMakePair( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeInterger ), QVariant( value ) );
+    }
+}
+
+const QtSnmpFakeMaster::Registration* tst_Bulk::findRegistration( const QtSnmpOid& root ) const {
+    for ( const auto& registration : m_registrations ) {
+        if ( root == registration.root ) {
+            return &registration;
+        }
+    }
+    return nullptr;
+}
+
+void tst_Bulk::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_bulk" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_bulk" );
+
+    QtSnmpSubagent::ObjectList objects;
+    // .1.1.0 to .1.10.0, .1.12.0 alone, .1.20.0 to .1.22.0
+    for ( int index = 1; index <= 10; ++index ) {
+        objects << integer( QtSnmpTestSupport::objectOid( 1, index ), index );
+    }
+    objects << integer( QtSnmpTestSupport::objectOid( 1, 12 ), 12 );
+    for ( int index = 20; index <= 22; ++index ) {
+        objects << integer( QtSnmpTestSupport::objectOid( 1, index ), index );
+    }
+    // siblings of a shorter OID, the index is its last sub-identifier
+    objects << integer( QString( enterprise ) + ".2.5", 25 ) << integer( QString( enterprise ) + ".2.6", 26 );
+    // the order of the list does not matter, a repeated object is skipped
+    std::reverse( objects.begin(), objects.end() );
+    objects << integer( QtSnmpTestSupport::objectOid( 1, 3 ), 300 );
+    QVERIFY( m_subagent->registerSnmpObjects( objects ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+    m_registrations = m_master.registrations();
+}
+
+void tst_Bulk::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Bulk::coalescedRegistrations() {
+    QCOMPARE( m_registrations.size(), 4 );
+    QCOMPARE( m_master.registrationPdus(), 4 );
+    QCOMPARE( m_subagent->sessionStatistics().registrations, 4 );
+
+    const QtSnmpFakeMaster::Registration* registration = findRegistration( QtSnmpTestSupport::objectKey( 1, 1 ) );
+    QVERIFY( registration );
+    QCOMPARE( registration->range_subid, index_subid );
+    QCOMPARE( registration->upper_bound, quint32( 10 ) );
+
+    registration = findRegistration( QtSnmpTestSupport::objectKey( 1, 12 ) );
+    QVERIFY( registration );
+    QCOMPARE( registration->range_subid, quint8( 0 ) );
+    QVERIFY( registration->is_instance );
+
+    registration = findRegistration( QtSnmpTestSupport::objectKey( 1, 20 ) );
+    QVERIFY( registration );
+    QCOMPARE( registration->range_subid, index_subid );
+    QCOMPARE( registration->upper_bound, quint32( 22 ) );
+
+    registration = findRegistration( oid( ".2.5" ) );
+    QVERIFY( registration );
+    QCOMPARE( registration->range_subid, index_subid );
+    QCOMPARE( registration->upper_bound, quint32( 6 ) );
+}
+
+void tst_Bulk::valuesOfTheList() {
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 1, 3 ) ).toInt(), 3 );
+    QCOMPARE( m_subagent->value( QString( enterprise ) + ".2.6" ).toInt(), 26 );
+    QVERIFY( not m_subagent->value( QtSnmpTestSupport::objectOid( 1, 11 ) ).isValid() );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpTestSupport::objectKey( 1, 7 ),
+                                                                QtSnmpTestSupport::objectKey( 1, 11 ),
+                                                                QtSnmpTestSupport::objectKey( 1, 21 ) } );
+    QCOMPARE( response.varbinds.size(), 3 );
+    QCOMPARE( response.varbinds.at( 0 ).number, quint64( 7 ) );
+    QCOMPARE( response.varbinds.at( 1 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+    QCOMPARE( response.varbinds.at( 2 ).number, quint64( 21 ) );
+}
+
+void tst_Bulk::registerAfterStart() {
+    const int pdus = m_master.registrationPdus();
+    QtSnmpSubagent::ObjectList objects;
+    for ( int index = 1; index <= 100; ++index ) {
+        objects << integer( QtSnmpTestSupport::objectOid( 3, index ), index );
+    }
+    QVERIFY( m_subagent->registerSnmpObjects( objects ) );
+    QVERIFY( m_master.waitForRegistrations( m_registrations.size() + 1 ) );
+    QCOMPARE( m_master.registrationPdus(), pdus + 1 );
+
+    m_registrations = m_master.registrations();
+    const QtSnmpFakeMaster::Registration* registration = findRegistration( QtSnmpTestSupport::objectKey( 3, 1 ) );
+    QVERIFY( registration );
+    QCOMPARE( registration->range_subid, index_subid );
+    QCOMPARE( registration->upper_bound, quint32( 100 ) );
+}
+
+void tst_Bulk::alreadyRegistered() {
+    const int pdus = m_master.registrationPdus();
+    QVERIFY( m_subagent->registerSnmpObjects( { integer( QtSnmpTestSupport::objectOid( 1, 1 ), 1000 ),
+                                                integer( QtSnmpTestSupport::objectOid( 4, 1 ), 41 ) } ) );
+    QVERIFY( m_master.waitForRegistrations( m_registrations.size() + 1 ) );
+    QCOMPARE( m_master.registrationPdus(), pdus + 1 );
+    // the registered object keeps its value
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 1, 1 ) ).toInt(), 1 );
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 4, 1 ) ).toInt(), 41 );
+    m_registrations = m_master.registrations();
+}
+
+void tst_Bulk::invalidList() {
+    const int pdus = m_master.registrationPdus();
+    QVERIFY( not m_subagent->registerSnmpObjects( { integer( QtSnmpTestSupport::objectOid( 5, 1 ), 51 ),
+                                                    integer( "not an oid", 0 ) } ) );
+    // nothing of the list is registered
+    QVERIFY( not m_subagent->value( QtSnmpTestSupport::objectOid( 5, 1 ) ).isValid() );
+    m_master.serve( 50 );
+    QCOMPARE( m_master.registrationPdus(), pdus );
+}
+
+void tst_Bulk::unregisterSubtree() {
+    QVERIFY( m_subagent->unregisterSnmpSubtree( QString( enterprise ) + ".1" ) );
+    for ( int index = 1; index <= 22; ++index ) {
+        QVERIFY( not m_subagent->value( QtSnmpTestSupport::objectOid( 1, index ) ).isValid() );
+    }
+    // the ranges and the instance of the prefix are unregistered, the others stay
+    QVERIFY( m_master.waitUntil( [ this ]() {
+        for ( const auto& registration : m_master.registrations() ) {
+            if ( registration.root.startsWith( oid( ".1" ) ) ) {
+                return false;
+            }
+        }
+        return true;
+    } ) );
+    QCOMPARE( m_master.registrations().size(), m_registrations.size() - 3 );
+    QCOMPARE( m_subagent->value( QString( enterprise ) + ".2.5" ).toInt(), 25 );
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 3, 50 ) ).toInt(), 50 );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpTestSupport::objectKey( 1, 7 ) } );
+    QCOMPARE( response.varbinds.value( 0 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+    // nothing is left below the prefix
+    QVERIFY( not m_subagent->unregisterSnmpSubtree( QString( enterprise ) + ".1" ) );
+}
+
+QTEST_GUILESS_MAIN( tst_Bulk )
+#include "tst_bulk.moc"
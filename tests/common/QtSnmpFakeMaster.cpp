@@ -0,0 +1,819 @@
+#include "QtSnmpFakeMaster.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtEndian>
+#include <QDebug>
+
+namespace {
+    enum Flag : quint8 {
+        FlagInstanceRegistration = 0x01,
+        FlagNonDefaultContext = 0x08,
+        FlagNetworkByteOrder = 0x10
+    };
+
+    const quint8 agentx_version = 1;
+    const int header_size = 20;
+
+    void append_byte( QByteArray& output, const quint8 value ) {
+        output.append( static_cast< char >( value ) );
+    }
+
+    void append_short( QByteArray& output, const quint16 value ) {
+        uchar buffer[ 2 ];
+        qToBigEndian< quint16 >( value, buffer );
+        output.append( reinterpret_cast< const char* >( buffer ), 2 );
+    }
+
+    void append_int( QByteArray& output, const quint32 value ) {
+        uchar buffer[ 4 ];
+        qToBigEndian< quint32 >( value, buffer );
+        output.append( reinterpret_cast< const char* >( buffer ), 4 );
+    }
+
+    void append_long( QByteArray& output, const quint64 value ) {
+        uchar buffer[ 8 ];
+        qToBigEndian< quint64 >( value, buffer );
+        output.append( reinterpret_cast< const char* >( buffer ), 8 );
+    }
+
+    // the OID is written without the prefix compression, as net-snmp does
+    void append_oid( QByteArray& output, const QtSnmpOid& oid, const bool include ) {
+        append_byte( output, static_cast< quint8 >( oid.size() ) );
+        append_byte( output, 0 );
+        append_byte( output, include ? 1 : 0 );
+        append_byte( output, 0 );
+        for ( int i = 0; i < oid.size(); ++i ) {
+            append_int( output, oid.at( i ) );
+        }
+    }
+
+    void append_octets( QByteArray& output, const QByteArray& octets ) {
+        static const char padding[ 3 ] = { 0, 0, 0 };
+        append_int( output, static_cast< quint32 >( octets.size() ) );
+        output.append( octets );
+        output.append( padding, ( 4 - ( octets.size() % 4 ) ) % 4 );
+    }
+
+    void append_varbind( QByteArray& output, const QtSnmpFakeMaster::Varbind& varbind ) {
+        append_short( output, varbind.type );
+        append_short( output, 0 );
+        append_oid( output, varbind.oid, false );
+        switch ( varbind.type ) {
+        case QtSnmpFakeMaster::TypeInteger:
+        case QtSnmpFakeMaster::TypeCounter32:
+        case QtSnmpFakeMaster::TypeGauge32:
+        case QtSnmpFakeMaster::TypeTimeTicks:
+            append_int( output, static_cast< quint32 >( varbind.number ) );
+            break;
+        case QtSnmpFakeMaster::TypeCounter64:
+            append_long( output, varbind.number );
+            break;
+        case QtSnmpFakeMaster::TypeOctetString:
+        case QtSnmpFakeMaster::TypeIpAddress:
+        case QtSnmpFakeMaster::TypeOpaque:
+            append_octets( output, varbind.octets );
+            break;
+        case QtSnmpFakeMaster::TypeObjectIdentifier:
+            append_oid( output, varbind.object_identifier, false );
+            break;
+        default:
+            break;
+        }
+    }
+
+    // search ranges without an upper bound
+    QByteArray search_ranges( const QVector< QtSnmpOid >& oids ) {
+        QByteArray result;
+        for ( const auto& oid : oids ) {
+            append_oid( result, oid, false );
+            append_oid( result, QtSnmpOid(), false );
+        }
+        return result;
+    }
+
+    // a malformed field invalidates the reader
+    class PacketReader {
+    public:
+        PacketReader( const char*const data, const int size, const bool is_big_endian )
+            : m_data( reinterpret_cast< const uchar* >( data ) )
+            , m_size( size )
+            , m_is_big_endian( is_big_endian )
+        {
+        }
+
+        bool isValid() const {
+            return m_is_valid;
+        }
+
+        bool atEnd() const {
+            return m_offset >= m_size;
+        }
+
+        quint8 readByte() {
+            if ( not require( 1 ) ) {
+                return 0;
+            }
+            return m_data[ m_offset++ ];
+        }
+
+        quint16 readShort() {
+            if ( not require( 2 ) ) {
+                return 0;
+            }
+            const uchar*const data = m_data + m_offset;
+            m_offset += 2;
+            return m_is_big_endian ? qFromBigEndian< quint16 >( data ) : qFromLittleEndian< quint16 >( data );
+        }
+
+        quint32 readInt() {
+            if ( not require( 4 ) ) {
+                return 0;
+            }
+            const uchar*const data = m_data + m_offset;
+            m_offset += 4;
+            return m_is_big_endian ? qFromBigEndian< quint32 >( data ) : qFromLittleEndian< quint32 >( data );
+        }
+
+        quint64 readLong() {
+            if ( not require( 8 ) ) {
+                return 0;
+            }
+            const uchar*const data = m_data + m_offset;
+            m_offset += 8;
+            return m_is_big_endian ? qFromBigEndian< quint64 >( data ) : qFromLittleEndian< quint64 >( data );
+        }
+
+        QtSnmpOid readOid() {
+            const quint8 size = readByte();
+            const quint8 prefix = readByte();
+            readByte();
+            readByte();
+            QtSnmpOid result;
+            if ( prefix ) {
+                static const quint32 internet[] = { 1, 3, 6, 1 };
+                result = QtSnmpOid( internet, 4 );
+                result.append( prefix );
+            }
+            if ( size + result.size() > QtSnmpOid::MaxLength ) {
+                m_is_valid = false;
+                m_offset = m_size;
+                return {};
+            }
+            for ( int i = 0; i < size; ++i ) {
+                result.append( readInt() );
+            }
+            return result;
+        }
+
+        QByteArray readOctets() {
+            const quint32 length = readInt();
+            const quint32 padded_length = ( length + 3 ) & ~3u;
+            if ( ( padded_length < length ) || not require( static_cast< int >( padded_length ) ) ) {
+                m_is_valid = false;
+                return {};
+            }
+            const QByteArray result( reinterpret_cast< const char* >( m_data + m_offset ),
+                                     static_cast< int >( length ) );
+            m_offset += static_cast< int >( padded_length );
+            return result;
+        }
+
+        QtSnmpFakeMaster::Varbind readVarbind() {
+            QtSnmpFakeMaster::Varbind result;
+            result.type = readShort();
+            readShort();
+            result.oid = readOid();
+            switch ( result.type ) {
+            case QtSnmpFakeMaster::TypeInteger:
+            case QtSnmpFakeMaster::TypeCounter32:
+            case QtSnmpFakeMaster::TypeGauge32:
+            case QtSnmpFakeMaster::TypeTimeTicks:
+                result.number = readInt();
+                break;
+            case QtSnmpFakeMaster::TypeCounter64:
+                result.number = readLong();
+                break;
+            case QtSnmpFakeMaster::TypeOctetString:
+            case QtSnmpFakeMaster::TypeIpAddress:
+            case QtSnmpFakeMaster::TypeOpaque:
+                result.octets = readOctets();
+                break;
+            case QtSnmpFakeMaster::TypeObjectIdentifier:
+                result.object_identifier = readOid();
+                break;
+            default:
+                break;
+            }
+            return result;
+        }
+
+    private:
+        bool require( const int size ) {
+            if ( ( size < 0 ) || ( m_size - m_offset < size ) ) {
+                m_is_valid = false;
+                m_offset = m_size;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        const uchar*const m_data;
+        const int m_size;
+        const bool m_is_big_endian;
+        int m_offset = 0;
+        bool m_is_valid = true;
+    };
+}
+
+QtSnmpFakeMaster::QtSnmpFakeMaster( QObject*const parent )
+    : QObject( parent )
+{
+    m_timeout_timer.setSingleShot( true );
+    connect( &m_timeout_timer, SIGNAL( timeout() ),
+             &m_loop, SLOT( quit() ) );
+}
+
+QtSnmpFakeMaster::~QtSnmpFakeMaster() {
+    close();
+}
+
+bool QtSnmpFakeMaster::listen( const QString& address ) {
+    close();
+    if ( address.startsWith( "unix:" ) ) {
+        const QString path = address.mid( 5 );
+        QLocalServer::removeServer( path );
+        m_local_server = new QLocalServer( this );
+        connect( m_local_server, SIGNAL( newConnection() ),
+                 this, SLOT( acceptLocalConnection() ) );
+        if ( not m_local_server->listen( path ) ) {
+            qWarning() << "Could not listen on " << path << ": " << m_local_server->errorString();
+            return false;
+        }
+        m_address = "unix:" + m_local_server->fullServerName();
+        return true;
+    }
+
+    const QStringList parts = ( address.startsWith( "tcp:" ) ? address.mid( 4 ) : address ).split( ':' );
+    const QString host_name = parts.value( 0 ).isEmpty() ? QString( "localhost" ) : parts.value( 0 );
+    const QHostAddress host = ( "localhost" == host_name ) ? QHostAddress( QHostAddress::LocalHost )
+                                                           : QHostAddress( host_name );
+    const quint16 port = parts.value( 1 ).toUShort();
+    m_tcp_server = new QTcpServer( this );
+    connect( m_tcp_server, SIGNAL( newConnection() ),
+             this, SLOT( acceptTcpConnection() ) );
+    if ( not m_tcp_server->listen( host, port ) ) {
+        qWarning() << "Could not listen on " << address << ": " << m_tcp_server->errorString();
+        return false;
+    }
+    m_address = QString( "tcp:%1:%2" ).arg( host_name ).arg( m_tcp_server->serverPort() );
+    return true;
+}
+
+QString QtSnmpFakeMaster::address() const {
+    return m_address;
+}
+
+void QtSnmpFakeMaster::close() {
+    for ( int i = 0; i < m_sessions.size(); ++i ) {
+        dropSession( i );
+    }
+    delete m_tcp_server;
+    m_tcp_server = nullptr;
+    delete m_local_server;
+    m_local_server = nullptr;
+    m_address.clear();
+}
+
+int QtSnmpFakeMaster::sessions() const {
+    return m_sessions.size();
+}
+
+bool QtSnmpFakeMaster::isOpen( const int session ) const {
+    return ( session >= 0 ) && ( session < m_sessions.size() ) && m_sessions.at( session ).is_open;
+}
+
+QString QtSnmpFakeMaster::sessionDescription( const int session ) const {
+    return m_sessions.value( session ).description;
+}
+
+int QtSnmpFakeMaster::sessionTimeout( const int session ) const {
+    return m_sessions.value( session ).timeout;
+}
+
+void QtSnmpFakeMaster::dropSession( const int session ) {
+    if ( ( session < 0 ) || ( session >= m_sessions.size() ) ) {
+        return;
+    }
+    Session& state = m_sessions[ session ];
+    state.is_open = false;
+    if ( not state.socket ) {
+        return;
+    }
+    QIODevice*const socket = state.socket;
+    state.socket = nullptr;
+    m_socket_sessions.remove( socket );
+    socket->disconnect( this );
+    socket->close();
+    socket->deleteLater();
+    for ( int i = m_registrations.size() - 1; i >= 0; --i ) {
+        if ( session == m_registrations.at( i ).session ) {
+            m_registrations.remove( i );
+        }
+    }
+}
+
+QVector< QtSnmpFakeMaster::Registration > QtSnmpFakeMaster::registrations() const {
+    return m_registrations;
+}
+
+int QtSnmpFakeMaster::registrationPdus() const {
+    return m_registration_pdus;
+}
+
+QVector< QtSnmpFakeMaster::VarbindList > QtSnmpFakeMaster::notifications() const {
+    return m_notifications;
+}
+
+bool QtSnmpFakeMaster::waitForSessions( const int count, const int timeout ) {
+    return waitFor( [this, count]() {
+        int open = 0;
+        for ( const auto& session : m_sessions ) {
+            open += session.is_open ? 1 : 0;
+        }
+        return open >= count;
+    }, timeout );
+}
+
+bool QtSnmpFakeMaster::waitForRegistrations( const int count, const int timeout ) {
+    return waitFor( [this, count]() { return m_registrations.size() >= count; }, timeout );
+}
+
+bool QtSnmpFakeMaster::waitForNotifications( const int count, const int timeout ) {
+    return waitFor( [this, count]() { return m_notifications.size() >= count; }, timeout );
+}
+
+void QtSnmpFakeMaster::serve( const int timeout ) {
+    waitFor( []() { return false; }, timeout );
+}
+
+bool QtSnmpFakeMaster::waitUntil( const std::function< bool() >& condition, const int timeout ) {
+    QElapsedTimer timer;
+    timer.start();
+    while ( not condition() ) {
+        if ( timer.elapsed() >= timeout ) {
+            return false;
+        }
+        serve( 1 );
+    }
+    return true;
+}
+
+QtSnmpFakeMaster::Request QtSnmpFakeMaster::getRequest( const QVector< QtSnmpOid >& oids ) {
+    Request result;
+    result.type = PduGet;
+    result.payload = search_ranges( oids );
+    return result;
+}
+
+QtSnmpFakeMaster::Request QtSnmpFakeMaster::getNextRequest( const QVector< QtSnmpOid >& oids ) {
+    Request result;
+    result.type = PduGetNext;
+    result.payload = search_ranges( oids );
+    return result;
+}
+
+QtSnmpFakeMaster::Request QtSnmpFakeMaster::getBulkRequest( const QVector< QtSnmpOid >& oids,
+                                                            const quint16 non_repeaters,
+                                                            const quint16 max_repetitions )
+{
+    Request result;
+    result.type = PduGetBulk;
+    append_short( result.payload, non_repeaters );
+    append_short( result.payload, max_repetitions );
+    result.payload.append( search_ranges( oids ) );
+    return result;
+}
+
+QtSnmpFakeMaster::Request QtSnmpFakeMaster::testSetRequest( const VarbindList& varbinds ) {
+    Request result;
+    result.type = PduTestSet;
+    for ( const auto& varbind : varbinds ) {
+        append_varbind( result.payload, varbind );
+    }
+    return result;
+}
+
+QtSnmpFakeMaster::Request QtSnmpFakeMaster::emptyRequest( const PduType type ) {
+    Request result;
+    result.type = type;
+    return result;
+}
+
+bool QtSnmpFakeMaster::execute( const Request& request,
+                                Response*const response,
+                                const int session,
+                                const quint32 transaction_id,
+                                const int timeout )
+{
+    if ( not isOpen( session ) ) {
+        return false;
+    }
+    m_is_answered = false;
+    m_awaited_response = response;
+    m_awaited_packet_id = send( session, request.type, transaction_id, request.payload );
+    const bool is_answered = waitFor( [this]() { return m_is_answered; }, timeout );
+    m_awaited_packet_id = 0;
+    m_awaited_response = nullptr;
+    if ( response ) {
+        response->is_valid = is_answered;
+    }
+    return is_answered;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::get( const QVector< QtSnmpOid >& oids, const int session ) {
+    Response response;
+    execute( getRequest( oids ), &response, session );
+    return response;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::getNext( const QVector< QtSnmpOid >& oids, const int session ) {
+    Response response;
+    execute( getNextRequest( oids ), &response, session );
+    return response;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::getBulk( const QVector< QtSnmpOid >& oids,
+                                                      const quint16 non_repeaters,
+                                                      const quint16 max_repetitions,
+                                                      const int session )
+{
+    Response response;
+    execute( getBulkRequest( oids, non_repeaters, max_repetitions ), &response, session );
+    return response;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::set( const VarbindList& varbinds, const int session ) {
+    const quint32 transaction_id = ++m_last_transaction_id;
+    const Response test = testSet( varbinds, transaction_id, session );
+    if ( not test.is_valid ) {
+        return test;
+    }
+    if ( NoError != test.error ) {
+        cleanupSet( transaction_id, session );
+        return test;
+    }
+    const Response commit = commitSet( transaction_id, session );
+    if ( commit.is_valid && ( NoError != commit.error ) ) {
+        undoSet( transaction_id, session );
+    }
+    cleanupSet( transaction_id, session );
+    return commit;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::testSet( const VarbindList& varbinds,
+                                                      const quint32 transaction_id,
+                                                      const int session )
+{
+    Response response;
+    execute( testSetRequest( varbinds ), &response, session, transaction_id );
+    return response;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::commitSet( const quint32 transaction_id, const int session ) {
+    Response response;
+    execute( emptyRequest( PduCommitSet ), &response, session, transaction_id );
+    return response;
+}
+
+QtSnmpFakeMaster::Response QtSnmpFakeMaster::undoSet( const quint32 transaction_id, const int session ) {
+    Response response;
+    execute( emptyRequest( PduUndoSet ), &response, session, transaction_id );
+    return response;
+}
+
+void QtSnmpFakeMaster::cleanupSet( const quint32 transaction_id, const int session ) {
+    if ( isOpen( session ) ) {
+        send( session, PduCleanupSet, transaction_id, QByteArray() );
+    }
+}
+
+qint64 QtSnmpFakeMaster::pipeline( const Request& request,
+                                   const QVector< int >& sessions,
+                                   const int count,
+                                   const int depth,
+                                   const int timeout )
+{
+    for ( const int session : sessions ) {
+        if ( not isOpen( session ) ) {
+            return -1;
+        }
+    }
+    if ( ( count <= 0 ) || ( depth <= 0 ) || sessions.isEmpty() ) {
+        return 0;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    m_pipeline_request = &request;
+    m_pipeline_first_packet_id = m_last_packet_id + 1;
+    m_pipeline_remaining = count;
+    m_pipeline_answered = 0;
+    for ( int i = 0; ( i < depth ) && ( m_pipeline_remaining > 0 ); ++i ) {
+        for ( const int session : sessions ) {
+            if ( m_pipeline_remaining > 0 ) {
+                --m_pipeline_remaining;
+                send( session, request.type, 0, request.payload );
+            }
+        }
+    }
+    const bool is_finished = waitFor( [this, count]() { return m_pipeline_answered >= count; }, timeout );
+    const qint64 elapsed = timer.nsecsElapsed();
+    m_pipeline_request = nullptr;
+    return is_finished ? elapsed : -1;
+}
+
+QtSnmpFakeMaster::Varbind QtSnmpFakeMaster::integerVarbind( const QtSnmpOid& oid, const qint32 value ) {
+    Varbind result;
+    result.type = TypeInteger;
+    result.oid = oid;
+    result.number = static_cast< quint32 >( value );
+    return result;
+}
+
+QtSnmpFakeMaster::Varbind QtSnmpFakeMaster::octetStringVarbind( const QtSnmpOid& oid, const QByteArray& value ) {
+    Varbind result;
+    result.type = TypeOctetString;
+    result.oid = oid;
+    result.octets = value;
+    return result;
+}
+
+void QtSnmpFakeMaster::acceptTcpConnection() {
+    while ( QTcpSocket*const socket = m_tcp_server->nextPendingConnection() ) {
+        socket->setSocketOption( QAbstractSocket::LowDelayOption, 1 );
+        addSession( socket );
+    }
+}
+
+void QtSnmpFakeMaster::acceptLocalConnection() {
+    while ( QLocalSocket*const socket = m_local_server->nextPendingConnection() ) {
+        addSession( socket );
+    }
+}
+
+void QtSnmpFakeMaster::addSession( QIODevice*const socket ) {
+    Session session;
+    session.socket = socket;
+    m_socket_sessions.insert( socket, m_sessions.size() );
+    m_sessions << session;
+    connect( socket, SIGNAL( readyRead() ),
+             this, SLOT( readPackets() ) );
+    connect( socket, SIGNAL( disconnected() ),
+             this, SLOT( closeSession() ) );
+}
+
+void QtSnmpFakeMaster::closeSession() {
+    dropSession( m_socket_sessions.value( sender(), -1 ) );
+    m_loop.quit();
+}
+
+void QtSnmpFakeMaster::readPackets() {
+    const int session = m_socket_sessions.value( sender(), -1 );
+    if ( session < 0 ) {
+        return;
+    }
+    QIODevice*const socket = m_sessions.at( session ).socket;
+    QByteArray& input = m_sessions[ session ].input;
+    const qint64 available = socket->bytesAvailable();
+    if ( available > 0 ) {
+        const int offset = input.size();
+        input.resize( offset + static_cast< int >( available ) );
+        const qint64 count = socket->read( input.data() + offset, available );
+        input.resize( offset + static_cast< int >( qMax( count, qint64( 0 ) ) ) );
+    }
+
+    int consumed = 0;
+    while ( input.size() - consumed >= header_size ) {
+        const char*const data = input.constData() + consumed;
+        const quint8 flags = static_cast< quint8 >( data[ 2 ] );
+        PacketReader reader( data, header_size, 0 != ( flags & FlagNetworkByteOrder ) );
+        const quint8 version = reader.readByte();
+        Header header;
+        header.type = reader.readByte();
+        header.flags = reader.readByte();
+        reader.readByte();
+        header.session_id = reader.readInt();
+        header.transaction_id = reader.readInt();
+        header.packet_id = reader.readInt();
+        const quint32 payload_size = reader.readInt();
+        if ( agentx_version != version ) {
+            qWarning() << "Malformed AgentX packet from session " << session;
+            dropSession( session );
+            m_loop.quit();
+            return;
+        }
+        if ( static_cast< quint32 >( input.size() - consumed - header_size ) < payload_size ) {
+            break;
+        }
+        processPacket( session, header, data + header_size, static_cast< int >( payload_size ) );
+        // the session may have been dropped by the packet
+        if ( m_sessions.at( session ).socket != socket ) {
+            return;
+        }
+        consumed += header_size + static_cast< int >( payload_size );
+    }
+    if ( consumed > 0 ) {
+        m_sessions[ session ].input.remove( 0, consumed );
+    }
+}
+
+void QtSnmpFakeMaster::processPacket( const int session,
+                                      const Header& header,
+                                      const char*const payload,
+                                      const int size )
+{
+    PacketReader reader( payload, size, 0 != ( header.flags & FlagNetworkByteOrder ) );
+    if ( ( header.flags & FlagNonDefaultContext ) && ( PduResponse != header.type ) ) {
+        reader.readOctets();
+    }
+
+    switch ( header.type ) {
+    case PduResponse:
+        processResponse( session, header, payload, size );
+        return;
+    case PduOpen:
+        {
+            Session& state = m_sessions[ session ];
+            state.timeout = reader.readByte();
+            reader.readByte();
+            reader.readShort();
+            reader.readOid();
+            state.description = QString::fromUtf8( reader.readOctets() );
+            state.id = ++m_last_session_id;
+            state.is_open = true;
+            Header opened = header;
+            opened.session_id = state.id;
+            answer( session, opened, NoError );
+            m_loop.quit();
+        }
+        return;
+    case PduClose:
+        answer( session, header, NoError );
+        dropSession( session );
+        m_loop.quit();
+        return;
+    case PduRegister:
+    case PduUnregister:
+        {
+            Registration registration;
+            registration.session = session;
+            registration.is_instance = ( 0 != ( header.flags & FlagInstanceRegistration ) );
+            reader.readByte();
+            registration.priority = reader.readByte();
+            registration.range_subid = reader.readByte();
+            reader.readByte();
+            registration.root = reader.readOid();
+            if ( registration.range_subid ) {
+                registration.upper_bound = reader.readInt();
+            }
+            if ( not reader.isValid() ) {
+                answer( session, header, ParseError );
+                return;
+            }
+            ++m_registration_pdus;
+            if ( PduRegister == header.type ) {
+                m_registrations << registration;
+            } else {
+                for ( int i = 0; i < m_registrations.size(); ++i ) {
+                    const Registration& registered = m_registrations.at( i );
+                    if ( ( registered.session == session )
+                         && ( registered.root == registration.root )
+                         && ( registered.range_subid == registration.range_subid )
+                         && ( registered.upper_bound == registration.upper_bound ) )
+                    {
+                        m_registrations.remove( i );
+                        break;
+                    }
+                }
+            }
+            answer( session, header, NoError );
+            m_loop.quit();
+        }
+        return;
+    case PduNotify:
+        {
+            VarbindList varbinds;
+            while ( not reader.atEnd() ) {
+                varbinds << reader.readVarbind();
+            }
+            if ( not reader.isValid() ) {
+                answer( session, header, ParseError );
+                return;
+            }
+            m_notifications << varbinds;
+            answer( session, header, NoError );
+            m_loop.quit();
+        }
+        return;
+    default:
+        // Ping, AddAgentCaps and the other administrative PDUs are accepted as they are
+        answer( session, header, NoError );
+        return;
+    }
+}
+
+void QtSnmpFakeMaster::processResponse( const int session,
+                                        const Header& header,
+                                        const char*const payload,
+                                        const int size )
+{
+    if ( m_awaited_packet_id && ( header.packet_id == m_awaited_packet_id ) ) {
+        if ( m_awaited_response ) {
+            PacketReader reader( payload, size, 0 != ( header.flags & FlagNetworkByteOrder ) );
+            reader.readInt();
+            m_awaited_response->error = reader.readShort();
+            m_awaited_response->index = reader.readShort();
+            m_awaited_response->varbinds.clear();
+            while ( not reader.atEnd() ) {
+                m_awaited_response->varbinds << reader.readVarbind();
+            }
+            if ( not reader.isValid() ) {
+                qWarning() << "Malformed AgentX response from session " << session;
+                m_awaited_response->error = ParseError;
+            }
+        }
+        m_awaited_packet_id = 0;
+        m_is_answered = true;
+        m_loop.quit();
+        return;
+    }
+
+    if ( m_pipeline_request && ( header.packet_id >= m_pipeline_first_packet_id ) ) {
+        ++m_pipeline_answered;
+        if ( m_pipeline_remaining > 0 ) {
+            --m_pipeline_remaining;
+            send( session, m_pipeline_request->type, 0, m_pipeline_request->payload );
+        } else if ( 0 == m_pipeline_remaining ) {
+            m_loop.quit();
+        }
+    }
+}
+
+void QtSnmpFakeMaster::answer( const int session, const Header& header, const quint16 error ) {
+    QIODevice*const socket = m_sessions.at( session ).socket;
+    if ( not socket ) {
+        return;
+    }
+    m_output.resize( 0 );
+    append_byte( m_output, agentx_version );
+    append_byte( m_output, PduResponse );
+    append_byte( m_output, FlagNetworkByteOrder );
+    append_byte( m_output, 0 );
+    append_int( m_output, header.session_id );
+    append_int( m_output, header.transaction_id );
+    append_int( m_output, header.packet_id );
+    append_int( m_output, 8 );
+    append_int( m_output, 0 );
+    append_short( m_output, error );
+    append_short( m_output, 0 );
+    socket->write( m_output );
+}
+
+quint32 QtSnmpFakeMaster::send( const int session,
+                                const quint8 type,
+                                const quint32 transaction_id,
+                                const QByteArray& payload )
+{
+    const Session& state = m_sessions.at( session );
+    const quint32 packet_id = ++m_last_packet_id;
+    m_output.resize( 0 );
+    append_byte( m_output, agentx_version );
+    append_byte( m_output, type );
+    append_byte( m_output, FlagNetworkByteOrder );
+    append_byte( m_output, 0 );
+    append_int( m_output, state.id );
+    append_int( m_output, transaction_id );
+    append_int( m_output, packet_id );
+    append_int( m_output, static_cast< quint32 >( payload.size() ) );
+    m_output.append( payload );
+    state.socket->write( m_output );
+    return packet_id;
+}
+
+bool QtSnmpFakeMaster::waitFor( const std::function< bool() >& condition, const int timeout ) {
+    if ( condition() ) {
+        return true;
+    }
+    m_timeout_timer.start( timeout );
+    while ( not condition() && m_timeout_timer.isActive() ) {
+        m_loop.exec();
+    }
+    m_timeout_timer.stop();
+    return condition();
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <QObject>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QEventLoop>
+#include <QTimer>
+#include <functional>
+#include "QtSnmpOid.h"
+
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+
+// AgentX master standing in for snmpd in the benchmarks and the tests: it accepts subagent
+// sessions on a local socket, answers their administrative PDUs and sends them requests.
+// The PDUs are encoded here and not with the library, so the wire format of the subagent
+// is checked against an independent implementation. All calls are made by the thread of
+// the master, which runs its event loop while it waits.
+class QtSnmpFakeMaster : public QObject {
+    Q_OBJECT
+    Q_DISABLE_COPY( QtSnmpFakeMaster )
+
+public:
+    enum PduType : quint8 {
+        PduOpen = 1,
+        PduClose = 2,
+        PduRegister = 3,
+        PduUnregister = 4,
+        PduGet = 5,
+        PduGetNext = 6,
+        PduGetBulk = 7,
+        PduTestSet = 8,
+        PduCommitSet = 9,
+        PduUndoSet = 10,
+        PduCleanupSet = 11,
+        PduNotify = 12,
+        PduPing = 13,
+        PduResponse = 18
+    };
+
+    enum VarbindType : quint16 {
+        TypeInteger = 2,
+        TypeOctetString = 4,
+        TypeNull = 5,
+        TypeObjectIdentifier = 6,
+        TypeIpAddress = 64,
+        TypeCounter32 = 65,
+        TypeGauge32 = 66,
+        TypeTimeTicks = 67,
+        TypeOpaque = 68,
+        TypeCounter64 = 70,
+        TypeNoSuchObject = 128,
+        TypeNoSuchInstance = 129,
+        TypeEndOfMibView = 130
+    };
+
+    enum Error : quint16 {
+        NoError = 0,
+        GenErr = 5,
+        WrongType = 7,
+        WrongValue = 10,
+        NoCreation = 11,
+        CommitFailed = 14,
+        UndoFailed = 15,
+        NotWritable = 17,
+        ParseError = 266,
+        ProcessingError = 268
+    };
+
+    enum {
+        // ms
+        DefaultTimeout = 5000
+    };
+
+    struct Varbind {
+        quint16 type = TypeNull;
+        QtSnmpOid oid;
+        // Integer, Counter32, Gauge32, TimeTicks and Counter64
+        quint64 number = 0;
+        // OctetString, IpAddress and Opaque
+        QByteArray octets;
+        // ObjectIdentifier
+        QtSnmpOid object_identifier;
+    };
+    typedef QVector< Varbind > VarbindList;
+
+    struct Response {
+        // false if the subagent has not answered in time
+        bool is_valid = false;
+        quint16 error = NoError;
+        quint16 index = 0;
+        VarbindList varbinds;
+    };
+
+    struct Registration {
+        int session = -1;
+        QtSnmpOid root;
+        quint8 priority = 0;
+        quint8 range_subid = 0;
+        quint32 upper_bound = 0;
+        bool is_instance = false;
+    };
+
+    // the payload of a request PDU, encoded once and sent any number of times
+    struct Request {
+        quint8 type = 0;
+        QByteArray payload;
+    };
+
+public:
+    explicit QtSnmpFakeMaster( QObject*const parent = nullptr );
+    virtual ~QtSnmpFakeMaster();
+
+    // "tcp:127.0.0.1:0" listens on a free port, "unix:/path" on a local socket
+    bool listen( const QString& address );
+    // the address to pass to QtSnmpSubagent::setMasterAddress()
+    QString address() const;
+    void close();
+
+    // sessions are numbered in the order of their connections, a closed one keeps its number
+    int sessions() const;
+    bool isOpen( const int session ) const;
+    QString sessionDescription( const int session ) const;
+    // seconds the subagent has asked for in its Open PDU, 0 for the default of the master
+    int sessionTimeout( const int session ) const;
+    // closes the connection of the session as a restarting master would
+    void dropSession( const int session );
+
+    // the subtrees registered and not unregistered since the master has started
+    QVector< Registration > registrations() const;
+    // Register and Unregister PDUs received
+    int registrationPdus() const;
+    // varbinds of the Notify PDUs received, sysUpTime.0 and snmpTrapOID.0 first
+    QVector< VarbindList > notifications() const;
+
+    // the event loop of the thread runs until the condition holds or the timeout expires
+    bool waitForSessions( const int count, const int timeout = DefaultTimeout );
+    bool waitForRegistrations( const int count, const int timeout = DefaultTimeout );
+    bool waitForNotifications( const int count, const int timeout = DefaultTimeout );
+    // waits timeout ms while the PDUs of the subagents are answered
+    void serve( const int timeout );
+    // serves the subagents until the condition, which may depend on other threads, holds;
+    // it is checked every millisecond
+    bool waitUntil( const std::function< bool() >& condition, const int timeout = DefaultTimeout );
+
+    static Request getRequest( const QVector< QtSnmpOid >& oids );
+    // every search range starts after its OID and is not bounded
+    static Request getNextRequest( const QVector< QtSnmpOid >& oids );
+    static Request getBulkRequest( const QVector< QtSnmpOid >& oids,
+                                   const quint16 non_repeaters,
+                                   const quint16 max_repetitions );
+    static Request testSetRequest( const VarbindList& varbinds );
+    static Request emptyRequest( const PduType type );
+
+    // Sends the request to the session and waits for the response; the varbinds are decoded
+    // only if the response is asked for, so a caller which measures can skip the decoding
+    bool execute( const Request& request,
+                  Response*const response = nullptr,
+                  const int session = 0,
+                  const quint32 transaction_id = 0,
+                  const int timeout = DefaultTimeout );
+
+    Response get( const QVector< QtSnmpOid >& oids, const int session = 0 );
+    Response getNext( const QVector< QtSnmpOid >& oids, const int session = 0 );
+    Response getBulk( const QVector< QtSnmpOid >& oids,
+                      const quint16 non_repeaters,
+                      const quint16 max_repetitions,
+                      const int session = 0 );
+    // TestSet, then CommitSet or UndoSet, then CleanupSet as snmpd sends them for one SET;
+    // the response of the phase which has failed or of the commit
+    Response set( const VarbindList& varbinds, const int session = 0 );
+    // the phases of a SET, which share the transaction id
+    Response testSet( const VarbindList& varbinds, const quint32 transaction_id, const int session = 0 );
+    Response commitSet( const quint32 transaction_id, const int session = 0 );
+    Response undoSet( const quint32 transaction_id, const int session = 0 );
+    // CleanupSet is not answered
+    void cleanupSet( const quint32 transaction_id, const int session = 0 );
+
+    // Keeps depth copies of the request outstanding on every session until count responses
+    // have arrived; ns elapsed, negative on timeout
+    qint64 pipeline( const Request& request,
+                     const QVector< int >& sessions,
+                     const int count,
+                     const int depth,
+                     const int timeout = DefaultTimeout );
+
+    static Varbind integerVarbind( const QtSnmpOid& oid, const qint32 value );
+    static Varbind octetStringVarbind( const QtSnmpOid& oid, const QByteArray& value );
+
+private:
+    struct Session {
+        QIODevice* socket = nullptr;
+        QByteArray input;
+        quint32 id = 0;
+        bool is_open = false;
+        QString description;
+        quint8 timeout = 0;
+    };
+
+    struct Header {
+        quint8 type = 0;
+        quint8 flags = 0;
+        quint32 session_id = 0;
+        quint32 transaction_id = 0;
+        quint32 packet_id = 0;
+    };
+
+    Q_SLOT void acceptTcpConnection();
+    Q_SLOT void acceptLocalConnection();
+    Q_SLOT void readPackets();
+    Q_SLOT void closeSession();
+    void addSession( QIODevice*const socket );
+    void processPacket( const int session, const Header& header, const char*const payload, const int size );
+    void processResponse( const int session, const Header& header, const char*const payload, const int size );
+    void answer( const int session, const Header& header, const quint16 error );
+    quint32 send( const int session, const quint8 type, const quint32 transaction_id, const QByteArray& payload );
+    bool waitFor( const std::function< bool() >& condition, const int timeout );
+
+private:
+    QTcpServer* m_tcp_server = nullptr;
+    QLocalServer* m_local_server = nullptr;
+    QString m_address;
+    QVector< Session > m_sessions;
+    QHash< QObject*, int > m_socket_sessions;
+    quint32 m_last_session_id = 0;
+    quint32 m_last_packet_id = 0;
+    quint32 m_last_transaction_id = 0;
+    QVector< Registration > m_registrations;
+    int m_registration_pdus = 0;
+    QVector< VarbindList > m_notifications;
+    QByteArray m_output;
+
+    QEventLoop m_loop;
+    QTimer m_timeout_timer;
+
+    // the request waited for by execute()
+    quint32 m_awaited_packet_id = 0;
+    Response* m_awaited_response = nullptr;
+    bool m_is_answered = false;
+
+    // the requests of pipeline()
+    const Request* m_pipeline_request = nullptr;
+    quint32 m_pipeline_first_packet_id = 0;
+    int m_pipeline_remaining = 0;
+    int m_pipeline_answered = 0;
+};
@@ -0,0 +1,96 @@
+#include "QtSnmpTestSupport.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpSubagent.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDebug>
+
+namespace {
+    // ms without a new registration after which net-snmp is considered to have registered all
+    const int registration_quiet_period = 200;
+
+    bool wait_for_state( QtSnmpSubagent*const subagent,
+                         const std::function< bool( QtSnmpSubagent::ConnectionState ) >& condition )
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while ( not condition( subagent->connectionState() ) ) {
+            if ( timer.elapsed() > QtSnmpFakeMaster::DefaultTimeout ) {
+                return false;
+            }
+            QCoreApplication::processEvents();
+            QThread::msleep( 1 );
+        }
+        return true;
+    }
+}
+
+QtSnmpSubagent* QtSnmpTestSupport::createSubagent( const QString& backend, const QString& name ) {
+    if ( "netsnmp" != backend ) {
+        return QtSnmpSubagent::createInstance( name );
+    }
+
+    // instance() starts at once with the default master, it is restarted with the benchmark one
+    QtSnmpSubagent*const subagent = QtSnmpSubagent::instance();
+    wait_for_state( subagent, []( QtSnmpSubagent::ConnectionState state ) {
+        return QtSnmpSubagent::StateStopped != state;
+    } );
+    subagent->stop();
+    wait_for_state( subagent, []( QtSnmpSubagent::ConnectionState state ) {
+        return QtSnmpSubagent::StateStopped == state;
+    } );
+    subagent->setBackend( QtSnmpSubagent::BackendNetSnmp );
+    subagent->setApplicationName( name );
+    return subagent;
+}
+
+qint64 QtSnmpTestSupport::startSubagent( QtSnmpSubagent*const subagent, QtSnmpFakeMaster& master, const int timeout ) {
+    const bool is_agentx = ( QtSnmpSubagent::BackendAgentX == subagent->backend() );
+    subagent->setMasterAddress( master.address() );
+    QElapsedTimer timer;
+    timer.start();
+    subagent->start();
+
+    int pdus = master.registrationPdus();
+    qint64 last_change = 0;
+    qint64 last_registration = -1;
+    const bool is_registered = master.waitUntil( [&]() {
+        const qint64 now = timer.elapsed();
+        if ( master.registrationPdus() != pdus ) {
+            pdus = master.registrationPdus();
+            last_change = now;
+            last_registration = now;
+        }
+        if ( QtSnmpSubagent::StateConnected != subagent->connectionState() ) {
+            last_change = now;
+            return false;
+        }
+        if ( is_agentx ) {
+            return subagent->sessionStatistics().registration_time >= 0;
+        }
+        // net-snmp registers by itself, the registry is complete once the PDUs have stopped
+        return now - last_change > registration_quiet_period;
+    }, timeout );
+    if ( not is_registered ) {
+        qWarning() << "The subagent has not registered with the master in " << timeout << " ms";
+        return -1;
+    }
+    return ( last_registration >= 0 ) ? last_registration : timer.elapsed();
+}
+
+void QtSnmpTestSupport::destroySubagent( QtSnmpSubagent*const subagent ) {
+    subagent->stop();
+    wait_for_state( subagent, []( QtSnmpSubagent::ConnectionState state ) {
+        return QtSnmpSubagent::StateStopped == state;
+    } );
+    // instance() is kept for the rest of the process
+    if ( QtSnmpSubagent::BackendNetSnmp == subagent->backend() ) {
+        return;
+    }
+    // the thread deletes the subagent when its event loop finishes
+    QThread*const thread = subagent->thread();
+    QMetaObject::invokeMethod( subagent, "deleteLater", Qt::QueuedConnection );
+    thread->quit();
+    thread->wait( QtSnmpFakeMaster::DefaultTimeout );
+}
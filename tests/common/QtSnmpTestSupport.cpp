@@ -0,0 +1,23 @@
+#include "QtSnmpTestSupport.h"
+#include <QCoreApplication>
+#include <QDir>
+
+namespace {
+    const char*const enterprise_oid = ".1.3.6.1.4.1.99999";
+}
+
+QString QtSnmpTestSupport::masterAddress( const QString& transport, const QString& name ) {
+    if ( "tcp" == transport ) {
+        return "tcp:127.0.0.1:0";
+    }
+    const QString file_name = QString( "%1-%2.sock" ).arg( name ).arg( QCoreApplication::applicationPid() );
+    return "unix:" + QDir( QDir::tempPath() ).filePath( file_name );
+}
+
+QString QtSnmpTestSupport::objectOid( const int branch, const int index ) {
+    return QString( "%1.%2.%3.0" ).arg( enterprise_oid ).arg( branch ).arg( index );
+}
+
+QtSnmpOid QtSnmpTestSupport::objectKey( const int branch, const int index ) {
+    return QtSnmpOid::fromString( objectOid( branch, index ) );
+}
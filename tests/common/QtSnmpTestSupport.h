@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QString>
+#include <QThread>
+#include <functional>
+#include "QtSnmpOid.h"
+
+class QtSnmpSubagent;
+class QtSnmpFakeMaster;
+
+// Helpers shared by the tests and the benchmarks, which serve a subagent from the fake master.
+namespace QtSnmpTestSupport {
+    // runs the function on a thread of its own
+    class Worker : public QThread {
+    public:
+        explicit Worker( const std::function< void() >& function ) : m_function( function ) {}
+
+    protected:
+        virtual void run() override {
+            m_function();
+        }
+
+    private:
+        std::function< void() > m_function;
+    };
+
+    // "unix:<temp>/<name>-<pid>.sock" or "tcp:127.0.0.1:0"
+    QString masterAddress( const QString& transport, const QString& name );
+
+    // .1.3.6.1.4.1.99999.<branch>.<index>.0, objects of one branch are registered as a range
+    QString objectOid( const int branch, const int index );
+    QtSnmpOid objectKey( const int branch, const int index );
+
+    // Defined by QtSnmpTestSubagent.cpp, which a benchmark built against an older checkout
+    // of the library leaves out.
+    // A subagent of the backend which is not started yet; the net-snmp backend uses instance(),
+    // so there is one such subagent per process
+    QtSnmpSubagent* createSubagent( const QString& backend, const QString& name );
+    // Starts the subagent with the master and waits until its registry has been registered;
+    // ms from start() until the master has received the last registration, negative on timeout
+    qint64 startSubagent( QtSnmpSubagent*const subagent, QtSnmpFakeMaster& master, const int timeout );
+    // stops the subagent and waits for its thread
+    void destroySubagent( QtSnmpSubagent*const subagent );
+}
@@ -0,0 +1,5 @@
+# the fake AgentX master and the helpers which the tests and the benchmarks share
+TEST_SUPPORT_PATH = $${PWD}
+INCLUDEPATH *= $${TEST_SUPPORT_PATH}
+HEADERS *= $$files( $${TEST_SUPPORT_PATH}/*.h )
+SOURCES *= $$files( $${TEST_SUPPORT_PATH}/*.cpp )
@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_instances
+SOURCES *= $${PWD}/tst_instances.cpp
@@ -0,0 +1,147 @@
+#include <QtTest>
+#include <QSet>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Subagents created by createInstance() are independent: every one runs its own thread,
+// AgentX session and registry, and keeps serving while another one stops
+class tst_Instances : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void ownThreads();
+    Q_SLOT void ownSessions();
+    Q_SLOT void ownRegistries();
+    Q_SLOT void parallelRequests();
+    Q_SLOT void stopOne();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QVector< QtSnmpSubagent* > m_subagents;
+};
+
+namespace {
+    const int instances = 4;
+    const int objects = 10;
+    // every instance serves the objects of its own branch and a shared OID of its own value
+    const QString shared_oid = QtSnmpTestSupport::objectOid( 100, 1 );
+
+    int own_value( const int instance, const int index ) {
+        return instance * 1000 + index;
+    }
+}
+
+void tst_Instances::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_instances" ) ) );
+    for ( int instance = 0; instance < instances; ++instance ) {
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", QString( "tst_instances_%1" ).arg( instance ) );
+        m_subagents << subagent;
+        QtSnmpSubagent::ObjectList list;
+        for ( int index = 1; index <= objects; ++index ) {
+            list << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( instance + 1, index ),
+                                                        QtSnmpObjectDescription::TypeInterger ),
+                               QVariant( own_value( instance, index ) ) );
+        }
+        QVERIFY( subagent->registerSnmpObjects( list ) );
+        QVERIFY( subagent->registerSnmpObject( QtSnmpObjectDescription( shared_oid, QtSnmpObjectDescription::TypeInterger ),
+                                               instance ) );
+        // the sessions are numbered in the order of the instances
+        QVERIFY( QtSnmpTestSupport::startSubagent( subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+    }
+}
+
+void tst_Instances::cleanupTestCase() {
+    for ( QtSnmpSubagent*const subagent : m_subagents ) {
+        QtSnmpTestSupport::destroySubagent( subagent );
+    }
+}
+
+void tst_Instances::ownThreads() {
+    QSet< QThread* > threads;
+    for ( QtSnmpSubagent*const subagent : m_subagents ) {
+        QVERIFY( subagent->thread() != QThread::currentThread() );
+        QVERIFY( subagent->thread()->isRunning() );
+        threads.insert( subagent->thread() );
+    }
+    QCOMPARE( threads.size(), instances );
+}
+
+void tst_Instances::ownSessions() {
+    QCOMPARE( m_master.sessions(), instances );
+    for ( int instance = 0; instance < instances; ++instance ) {
+        QVERIFY( m_master.isOpen( instance ) );
+        QCOMPARE( m_master.sessionDescription( instance ), QString( "tst_instances_%1" ).arg( instance ) );
+    }
+    // a range of the branch and the shared OID per instance
+    QCOMPARE( m_master.registrations().size(), 2 * instances );
+    for ( const auto& registration : m_master.registrations() ) {
+        if ( QtSnmpOid::fromString( shared_oid ) != registration.root ) {
+            QCOMPARE( registration.root, QtSnmpTestSupport::objectKey( registration.session + 1, 1 ) );
+        }
+    }
+}
+
+void tst_Instances::ownRegistries() {
+    for ( int instance = 0; instance < instances; ++instance ) {
+        QCOMPARE( m_subagents.at( instance )->value( shared_oid ).toInt(), instance );
+        const int other = ( instance + 1 ) % instances;
+        QVERIFY( not m_subagents.at( instance )->value( QtSnmpTestSupport::objectOid( other + 1, 1 ) ).isValid() );
+
+        const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpTestSupport::objectKey( instance + 1, objects ),
+                                                                    QtSnmpOid::fromString( shared_oid ),
+                                                                    QtSnmpTestSupport::objectKey( other + 1, 1 ) },
+                                                                  instance );
+        QVERIFY( response.is_valid );
+        QCOMPARE( response.varbinds.size(), 3 );
+        QCOMPARE( response.varbinds.at( 0 ).number, quint64( own_value( instance, objects ) ) );
+        QCOMPARE( response.varbinds.at( 1 ).number, quint64( instance ) );
+        QCOMPARE( response.varbinds.at( 2 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+    }
+
+    // a SET reaches the instance of the session only
+    QCOMPARE( m_master.set( { QtSnmpFakeMaster::integerVarbind( QtSnmpOid::fromString( shared_oid ), 42 ) }, 2 ).error,
+              quint16( QtSnmpFakeMaster::NoError ) );
+    for ( int instance = 0; instance < instances; ++instance ) {
+        QCOMPARE( m_subagents.at( instance )->value( shared_oid ).toInt(), ( 2 == instance ) ? 42 : instance );
+    }
+    m_subagents.at( 2 )->setValue( shared_oid, 2 );
+}
+
+void tst_Instances::parallelRequests() {
+    // requests outstanding on all sessions at once are answered by every instance
+    const QtSnmpFakeMaster::Request request = QtSnmpFakeMaster::getRequest( { QtSnmpOid::fromString( shared_oid ) } );
+    QVector< int > sessions;
+    for ( int instance = 0; instance < instances; ++instance ) {
+        sessions << instance;
+    }
+    QVERIFY( m_master.pipeline( request, sessions, 400 * instances, 8 ) >= 0 );
+    for ( int instance = 0; instance < instances; ++instance ) {
+        QCOMPARE( m_master.get( { QtSnmpOid::fromString( shared_oid ) }, instance ).varbinds.value( 0 ).number,
+                  quint64( instance ) );
+    }
+}
+
+void tst_Instances::stopOne() {
+    QtSnmpSubagent*const stopped = m_subagents.at( 1 );
+    stopped->stop();
+    QVERIFY( m_master.waitUntil( [ this, stopped ]() {
+        return not m_master.isOpen( 1 ) && ( QtSnmpSubagent::StateStopped == stopped->connectionState() );
+    } ) );
+    for ( int instance = 0; instance < instances; ++instance ) {
+        if ( 1 == instance ) {
+            continue;
+        }
+        QVERIFY( m_master.isOpen( instance ) );
+        QCOMPARE( QtSnmpSubagent::StateConnected, m_subagents.at( instance )->connectionState() );
+        QCOMPARE( m_master.get( { QtSnmpTestSupport::objectKey( instance + 1, 1 ) }, instance ).varbinds.value( 0 ).number,
+                  quint64( own_value( instance, 1 ) ) );
+    }
+    // the stopped instance keeps its registry
+    QCOMPARE( stopped->value( shared_oid ).toInt(), 1 );
+}
+
+QTEST_GUILESS_MAIN( tst_Instances )
+#include "tst_instances.moc"
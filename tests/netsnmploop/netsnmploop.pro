@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_netsnmploop
+SOURCES *= $${PWD}/tst_netsnmploop.cpp
@@ -0,0 +1,107 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+#include <algorithm>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+
+// The net-snmp backend reads the session sockets as soon as they are readable,
+// a polling timer of 100 ms would delay every PDU by 50 ms on average
+class tst_NetSnmpLoop : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void requestIsAnsweredAtOnce_data();
+    Q_SLOT void requestIsAnsweredAtOnce();
+    Q_SLOT void setIsAppliedAtOnce();
+
+private:
+    QTemporaryDir m_directory;
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+};
+
+namespace {
+    const char*const integer_oid = ".1.3.6.1.4.1.99999.1.1.0";
+    const char*const next_oid = ".1.3.6.1.4.1.99999.1.2.0";
+    const int requests = 50;
+    // ms, far below the 50 ms of a polling timer
+    const qint64 max_median_latency = 20;
+
+    qint64 median( QVector< qint64 >& latencies ) {
+        std::sort( latencies.begin(), latencies.end() );
+        return latencies.at( latencies.size() / 2 );
+    }
+}
+
+void tst_NetSnmpLoop::initTestCase() {
+    QVERIFY( m_directory.isValid() );
+    QVERIFY( m_master.listen( "unix:" + m_directory.filePath( "master" ) ) );
+
+    // instance() starts at once with the default master, the test restarts it with its own
+    m_subagent = QtSnmpSubagent::instance();
+    QTRY_VERIFY( QtSnmpSubagent::StateStopped != m_subagent->connectionState() );
+    m_subagent->stop();
+    QTRY_COMPARE( m_subagent->connectionState(), QtSnmpSubagent::StateStopped );
+    m_subagent->setBackend( QtSnmpSubagent::BackendNetSnmp );
+    m_subagent->setMasterAddress( m_master.address() );
+
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( integer_oid, QtSnmpObjectDescription::TypeInterger ), 42 ) );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( next_oid, QtSnmpObjectDescription::TypeInterger ), 43 ) );
+    m_subagent->start();
+    QVERIFY( m_master.waitUntil( [this]() {
+        return ( QtSnmpSubagent::StateConnected == m_subagent->connectionState() )
+               && ( m_master.registrations().size() >= 1 );
+    }, 10000 ) );
+}
+
+void tst_NetSnmpLoop::cleanupTestCase() {
+    m_subagent->stop();
+    QTRY_COMPARE( m_subagent->connectionState(), QtSnmpSubagent::StateStopped );
+}
+
+void tst_NetSnmpLoop::requestIsAnsweredAtOnce_data() {
+    QTest::addColumn< bool >( "is_next" );
+    QTest::newRow( "get" ) << false;
+    QTest::newRow( "getnext" ) << true;
+}
+
+void tst_NetSnmpLoop::requestIsAnsweredAtOnce() {
+    QFETCH( bool, is_next );
+    const QtSnmpOid oid = QtSnmpOid::fromString( integer_oid );
+    const QtSnmpFakeMaster::Request request = is_next ? QtSnmpFakeMaster::getNextRequest( { oid } )
+                                                      : QtSnmpFakeMaster::getRequest( { oid } );
+    QVector< qint64 > latencies;
+    for ( int i = 0; i < requests; ++i ) {
+        QtSnmpFakeMaster::Response response;
+        QElapsedTimer timer;
+        timer.start();
+        QVERIFY( m_master.execute( request, &response ) );
+        latencies << timer.elapsed();
+        QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+        QCOMPARE( response.varbinds.size(), 1 );
+        QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeInteger ) );
+        QCOMPARE( response.varbinds.first().number, quint64( is_next ? 43 : 42 ) );
+    }
+    QVERIFY2( median( latencies ) < max_median_latency, "requests wait for a polling cycle" );
+}
+
+void tst_NetSnmpLoop::setIsAppliedAtOnce() {
+    const QtSnmpOid oid = QtSnmpOid::fromString( integer_oid );
+    QVector< qint64 > latencies;
+    for ( int i = 0; i < requests; ++i ) {
+        QElapsedTimer timer;
+        timer.start();
+        const QtSnmpFakeMaster::Response response = m_master.set( { QtSnmpFakeMaster::integerVarbind( oid, i ) } );
+        latencies << timer.elapsed();
+        QVERIFY( response.is_valid );
+        QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+        QCOMPARE( m_subagent->value( integer_oid ).toInt(), i );
+    }
+    QVERIFY2( median( latencies ) < max_median_latency, "SET phases wait for a polling cycle" );
+}
+
+QTEST_GUILESS_MAIN( tst_NetSnmpLoop )
+#include "tst_netsnmploop.moc"
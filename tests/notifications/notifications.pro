@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_notifications
+SOURCES *= $${PWD}/tst_notifications.cpp
@@ -0,0 +1,196 @@
+#include <QtTest>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Notify PDUs carry the values the objects have when they are sent; equal notifications are
+// merged within the window and every notification type has a token bucket of its own
+class tst_Notifications : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void varbinds();
+    Q_SLOT void coalescing();
+    Q_SLOT void burst();
+    Q_SLOT void bucketPerType();
+    Q_SLOT void refill();
+    Q_SLOT void queuedUntilSession();
+
+private:
+    QtSnmpSubagent::NotificationStatistics waitForStatistics( const quint64 handled );
+    // sends one notification of the type for each of the objects, all different
+    void sendDistinct( const QString& type, const int count );
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+    int m_handled = 0;
+};
+
+namespace {
+    const int objects = 20;
+    // ms
+    const int window = 50;
+    const char*const snmp_trap_oid = ".1.3.6.1.6.3.1.1.4.1.0";
+
+    QString notification_type( const int number ) {
+        return QString( ".1.3.6.1.4.1.99999.0.%1" ).arg( number );
+    }
+}
+
+void tst_Notifications::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_notifications" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_notifications" );
+    QtSnmpSubagent::ObjectList list;
+    for ( int index = 1; index <= objects; ++index ) {
+        list << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( 1, index ), QtSnmpObjectDescription::TypeInterger ),
+                           QVariant( index ) );
+    }
+    QVERIFY( m_subagent->registerSnmpObjects( list ) );
+    m_subagent->setNotificationWindow( window );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_Notifications::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+QtSnmpSubagent::NotificationStatistics tst_Notifications::waitForStatistics( const quint64 handled ) {
+    QtSnmpSubagent::NotificationStatistics statistics;
+    m_master.waitUntil( [ this, handled, &statistics ]() {
+        statistics = m_subagent->notificationStatistics();
+        return statistics.sent + statistics.rate_limited >= handled;
+    } );
+    return statistics;
+}
+
+void tst_Notifications::sendDistinct( const QString& type, const int count ) {
+    for ( int index = 1; index <= count; ++index ) {
+        QVERIFY( m_subagent->sendNotification( type, { QtSnmpTestSupport::objectOid( 1, index ) } ) );
+    }
+    m_handled += count;
+}
+
+void tst_Notifications::varbinds() {
+    m_subagent->setInstrumentation( true );
+    m_subagent->setValue( QtSnmpTestSupport::objectOid( 1, 2 ), 200 );
+    QVERIFY( m_subagent->sendNotification( notification_type( 1 ), { QtSnmpTestSupport::objectOid( 1, 1 ),
+                                                                      QtSnmpTestSupport::objectOid( 1, 2 ) } ) );
+    // the value at the time of sending, not of queueing
+    m_subagent->setValue( QtSnmpTestSupport::objectOid( 1, 1 ), 100 );
+    ++m_handled;
+    QVERIFY( m_master.waitForNotifications( 1 ) );
+
+    const QtSnmpFakeMaster::VarbindList varbinds = m_master.notifications().first();
+    QCOMPARE( varbinds.size(), 4 );
+    QCOMPARE( varbinds.at( 0 ).type, quint16( QtSnmpFakeMaster::TypeTimeTicks ) );
+    QCOMPARE( varbinds.at( 1 ).oid, QtSnmpOid::fromString( snmp_trap_oid ) );
+    QCOMPARE( varbinds.at( 1 ).object_identifier, QtSnmpOid::fromString( notification_type( 1 ) ) );
+    QCOMPARE( varbinds.at( 2 ).oid, QtSnmpTestSupport::objectKey( 1, 1 ) );
+    QCOMPARE( varbinds.at( 2 ).number, quint64( 100 ) );
+    QCOMPARE( varbinds.at( 3 ).number, quint64( 200 ) );
+    QCOMPARE( waitForStatistics( m_handled ).sent, quint64( 1 ) );
+    // reading the payload is not a GET of the objects
+    const QMap< QString, QtSnmpSubagent::ObjectStatistics > statistics = m_subagent->objectStatistics();
+    QCOMPARE( statistics.value( QtSnmpTestSupport::objectOid( 1, 1 ) ).get_requests, quint64( 0 ) );
+    QCOMPARE( statistics.value( QtSnmpTestSupport::objectOid( 1, 2 ) ).get_requests, quint64( 0 ) );
+    m_subagent->setInstrumentation( false );
+}
+
+void tst_Notifications::coalescing() {
+    const int before = m_master.notifications().size();
+    const quint64 coalesced = m_subagent->notificationStatistics().coalesced;
+    // an alarm storm within the window is one notification
+    for ( int i = 0; i < 5; ++i ) {
+        QVERIFY( m_subagent->sendNotification( notification_type( 2 ), { QtSnmpTestSupport::objectOid( 1, 3 ) } ) );
+    }
+    ++m_handled;
+    QVERIFY( m_master.waitForNotifications( before + 1 ) );
+    m_master.serve( window * 3 );
+    QCOMPARE( m_master.notifications().size(), before + 1 );
+    QCOMPARE( m_subagent->notificationStatistics().coalesced, coalesced + 4 );
+}
+
+void tst_Notifications::burst() {
+    // the bucket starts full and refills too slowly to matter here
+    m_subagent->setNotificationRateLimit( 0.001, 3 );
+    const int before = m_master.notifications().size();
+    const quint64 rate_limited = m_subagent->notificationStatistics().rate_limited;
+    sendDistinct( notification_type( 3 ), 8 );
+    const QtSnmpSubagent::NotificationStatistics statistics = waitForStatistics( m_handled );
+    m_master.serve( window * 3 );
+    QCOMPARE( m_master.notifications().size(), before + 3 );
+    QCOMPARE( statistics.rate_limited, rate_limited + 5 );
+}
+
+void tst_Notifications::bucketPerType() {
+    // the type limited before does not limit another one
+    const int before = m_master.notifications().size();
+    sendDistinct( notification_type( 3 ), 2 );
+    sendDistinct( notification_type( 4 ), 2 );
+    waitForStatistics( m_handled );
+    m_master.serve( window * 3 );
+    QCOMPARE( m_master.notifications().size(), before + 2 );
+    for ( int i = before; i < m_master.notifications().size(); ++i ) {
+        QCOMPARE( m_master.notifications().at( i ).value( 1 ).object_identifier, QtSnmpOid::fromString( notification_type( 4 ) ) );
+    }
+}
+
+void tst_Notifications::refill() {
+    // 20 tokens a second, at most 2 at once
+    m_subagent->setNotificationRateLimit( 20, 2 );
+    sendDistinct( notification_type( 5 ), 4 );
+    QtSnmpSubagent::NotificationStatistics statistics = waitForStatistics( m_handled );
+    const quint64 sent = statistics.sent;
+    const quint64 rate_limited = statistics.rate_limited;
+
+    // a pause of several tokens refills the bucket up to the burst only
+    m_master.serve( 500 );
+    sendDistinct( notification_type( 5 ), 4 );
+    statistics = waitForStatistics( m_handled );
+    QCOMPARE( statistics.sent, sent + 2 );
+    QCOMPARE( statistics.rate_limited, rate_limited + 2 );
+
+    // no limit at all
+    m_subagent->setNotificationRateLimit( 0, 1 );
+    sendDistinct( notification_type( 5 ), objects );
+    statistics = waitForStatistics( m_handled );
+    QCOMPARE( statistics.sent, sent + 2 + objects );
+}
+
+void tst_Notifications::queuedUntilSession() {
+    QtSnmpFakeMaster master;
+    QVERIFY( master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_notifications_queued" ) ) );
+    QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_notifications_queued" );
+    QVERIFY( subagent->registerSnmpObject( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( 1, 1 ),
+                                                                    QtSnmpObjectDescription::TypeInterger ), 1 ) );
+    subagent->setNotificationWindow( window );
+    subagent->setNotificationRateLimit( 0, 1 );
+
+    // the queue is bounded while there is no session
+    const int queue_limit = 1000;
+    int accepted = 0;
+    for ( int i = 0; i <= queue_limit; ++i ) {
+        accepted += subagent->sendNotification( notification_type( 100 + i ) ) ? 1 : 0;
+    }
+    const QtSnmpSubagent::NotificationStatistics queued = subagent->notificationStatistics();
+
+    const bool is_started = ( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+    const bool is_sent = is_started && master.waitForNotifications( queue_limit );
+    const QtSnmpSubagent::NotificationStatistics statistics = subagent->notificationStatistics();
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QCOMPARE( accepted, queue_limit );
+    QCOMPARE( queued.queue_depth, queue_limit );
+    QCOMPARE( queued.dropped, quint64( 1 ) );
+    QVERIFY( is_started );
+    QVERIFY( is_sent );
+    QCOMPARE( master.notifications().first().value( 1 ).object_identifier, QtSnmpOid::fromString( notification_type( 100 ) ) );
+    QCOMPARE( statistics.queue_depth, 0 );
+    QCOMPARE( statistics.max_queue_depth, queue_limit );
+}
+
+QTEST_GUILESS_MAIN( tst_Notifications )
+#include "tst_notifications.moc"
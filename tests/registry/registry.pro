@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_registry
+SOURCES *= $${PWD}/tst_registry.cpp
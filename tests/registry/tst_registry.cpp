@@ -0,0 +1,222 @@
+#include <QtTest>
+#include <QHash>
+#include <algorithm>
+#include "QtSnmpOid.h"
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// The registry is keyed by binary OIDs, which order numerically and hash by their sub-identifiers
+class tst_Registry : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void parse_data();
+    Q_SLOT void parse();
+    Q_SLOT void order();
+    Q_SLOT void hash();
+    Q_SLOT void prefix();
+    Q_SLOT void lookup();
+    Q_SLOT void asyncRegistration();
+    Q_SLOT void getOfManyVarbinds();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+};
+
+namespace {
+    const int branch_objects = 200;
+
+    QtSnmpOid oid( const QString& text ) {
+        return QtSnmpOid::fromString( text );
+    }
+}
+
+void tst_Registry::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_registry" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_registry" );
+    QtSnmpSubagent::ObjectList objects;
+    for ( int index = 1; index <= branch_objects; ++index ) {
+        objects << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( 1, index ),
+                                                       QtSnmpObjectDescription::TypeInterger ),
+                              QVariant( index ) );
+    }
+    QVERIFY( m_subagent->registerSnmpObjects( objects ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_Registry::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Registry::parse_data() {
+    QTest::addColumn< QString >( "text" );
+    QTest::addColumn< bool >( "is_valid" );
+    QTest::addColumn< int >( "size" );
+    QTest::addColumn< QString >( "canonical" );
+
+    QTest::newRow( "leading dot" ) << ".1.3.6.1" << true << 4 << ".1.3.6.1";
+    QTest::newRow( "no leading dot" ) << "1.3.6.1" << true << 4 << ".1.3.6.1";
+    QTest::newRow( "single" ) << "0" << true << 1 << ".0";
+    QTest::newRow( "largest" ) << ".1.4294967295" << true << 2 << ".1.4294967295";
+    QTest::newRow( "overflow" ) << ".1.4294967296" << false << 0 << "";
+    QTest::newRow( "empty" ) << "" << false << 0 << "";
+    QTest::newRow( "dot only" ) << "." << false << 0 << "";
+    QTest::newRow( "trailing dot" ) << ".1.3." << false << 0 << "";
+    QTest::newRow( "double dot" ) << ".1..3" << false << 0 << "";
+    QTest::newRow( "letter" ) << ".1.3a.6" << false << 0 << "";
+    QTest::newRow( "negative" ) << ".1.-3" << false << 0 << "";
+
+    QStringList parts;
+    for ( int i = 0; i < QtSnmpOid::MaxLength; ++i ) {
+        parts << "1";
+    }
+    QTest::newRow( "longest" ) << parts.join( '.' ) << true << int( QtSnmpOid::MaxLength ) << "." + parts.join( '.' );
+    parts << "1";
+    QTest::newRow( "too long" ) << parts.join( '.' ) << false << 0 << "";
+}
+
+void tst_Registry::parse() {
+    QFETCH( QString, text );
+    QFETCH( bool, is_valid );
+    QFETCH( int, size );
+    QFETCH( QString, canonical );
+
+    bool ok = not is_valid;
+    const QtSnmpOid result = QtSnmpOid::fromString( text, &ok );
+    QCOMPARE( ok, is_valid );
+    QCOMPARE( result.size(), size );
+    QCOMPARE( result.isEmpty(), not is_valid );
+    if ( is_valid ) {
+        QCOMPARE( result.toString(), canonical );
+        QCOMPARE( QtSnmpOid::fromString( result.toString() ), result );
+    }
+}
+
+void tst_Registry::order() {
+    // the order of GETNEXT, which differs from the order of the strings
+    const QVector< QtSnmpOid > expected = {
+        oid( ".1.3" ),
+        oid( ".1.3.6" ),
+        oid( ".1.3.6.1.2" ),
+        oid( ".1.3.6.1.10" ),
+        oid( ".1.3.6.2" ),
+        oid( ".1.3.6.10" ),
+        oid( ".1.3.6.4294967295" ),
+        oid( ".2" )
+    };
+    QVector< QtSnmpOid > sorted = expected;
+    std::reverse( sorted.begin(), sorted.end() );
+    std::sort( sorted.begin(), sorted.end() );
+    QCOMPARE( sorted, expected );
+
+    for ( int i = 0; i + 1 < expected.size(); ++i ) {
+        QVERIFY( expected.at( i ) < expected.at( i + 1 ) );
+        QVERIFY( not ( expected.at( i + 1 ) < expected.at( i ) ) );
+        QVERIFY( expected.at( i ) != expected.at( i + 1 ) );
+    }
+    QVERIFY( not ( expected.first() < expected.first() ) );
+}
+
+void tst_Registry::hash() {
+    QCOMPARE( qHash( oid( ".1.3.6.1" ) ), qHash( oid( "1.3.6.1" ) ) );
+    QCOMPARE( qHash( oid( ".1.3.6.1" ), 7 ), qHash( oid( "1.3.6.1" ), 7 ) );
+
+    QHash< QtSnmpOid, int > objects;
+    for ( int i = 0; i < 10000; ++i ) {
+        objects.insert( QtSnmpTestSupport::objectKey( 1 + i % 4, i ), i );
+    }
+    QCOMPARE( objects.size(), 10000 );
+    for ( int i = 0; i < 10000; ++i ) {
+        QCOMPARE( objects.value( QtSnmpTestSupport::objectKey( 1 + i % 4, i ), -1 ), i );
+    }
+    QVERIFY( not objects.contains( QtSnmpTestSupport::objectKey( 5, 0 ) ) );
+}
+
+void tst_Registry::prefix() {
+    const QtSnmpOid object = oid( ".1.3.6.1.4.1.99999.1.2.0" );
+    QVERIFY( object.startsWith( oid( ".1.3.6.1.4.1" ) ) );
+    QVERIFY( object.startsWith( object ) );
+    QVERIFY( object.startsWith( QtSnmpOid() ) );
+    QVERIFY( not object.startsWith( oid( ".1.3.6.1.4.2" ) ) );
+    QVERIFY( not oid( ".1.3.6" ).startsWith( object ) );
+    QCOMPARE( object.mid( 7 ), oid( ".99999.1.2.0" ) );
+    QVERIFY( object.mid( object.size() ).isEmpty() );
+
+    QtSnmpOid changed = object;
+    changed.replace( 8, 3 );
+    changed.append( 7 );
+    QCOMPARE( changed, oid( ".1.3.6.1.4.1.99999.1.3.0.7" ) );
+}
+
+void tst_Registry::lookup() {
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 1, 7 ) ).toInt(), 7 );
+    // the same object in another notation
+    QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 1, 7 ).mid( 1 ) ).toInt(), 7 );
+    QVERIFY( not m_subagent->value( QtSnmpTestSupport::objectOid( 1, branch_objects + 1 ) ).isValid() );
+    QVERIFY( not m_subagent->value( "not an oid" ).isValid() );
+
+    const QString extra = QtSnmpTestSupport::objectOid( 2, 1 );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( extra, QtSnmpObjectDescription::TypeInterger ), 5 ) );
+    QCOMPARE( m_subagent->value( extra ).toInt(), 5 );
+    QVERIFY( m_subagent->unregisterSnmpObject( extra ) );
+    QVERIFY( not m_subagent->value( extra ).isValid() );
+    QVERIFY( not m_subagent->unregisterSnmpObject( extra ) );
+}
+
+void tst_Registry::asyncRegistration() {
+    // an existing object stays synchronous
+    const QString existing = QtSnmpTestSupport::objectOid( 2, 2 );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( existing, QtSnmpObjectDescription::TypeInterger ), 9 ) );
+    QVERIFY( not m_subagent->registerSnmpAsyncObject( QtSnmpObjectDescription( existing, QtSnmpObjectDescription::TypeInterger ), 1000 ) );
+
+    const QString delegated = QtSnmpTestSupport::objectOid( 2, 3 );
+    QVERIFY( m_subagent->registerSnmpAsyncObject( QtSnmpObjectDescription( delegated, QtSnmpObjectDescription::TypeInterger ), 1000 ) );
+    QStringList requested;
+    const QMetaObject::Connection connection = connect(
+        m_subagent, &QtSnmpSubagent::snmpGetRequest, this,
+        [ this, &requested ]( const QString& oid, const quint64 request_id ) {
+            requested << oid;
+            m_subagent->completeGetRequest( request_id, 11 );
+        },
+        Qt::DirectConnection );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { oid( existing ), oid( delegated ) } );
+    disconnect( connection );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 2 );
+    QCOMPARE( response.varbinds.at( 0 ).number, quint64( 9 ) );
+    QCOMPARE( response.varbinds.at( 1 ).number, quint64( 11 ) );
+    QCOMPARE( requested, QStringList() << oid( delegated ).toString() );
+
+    QVERIFY( m_subagent->unregisterSnmpObject( existing ) );
+    QVERIFY( m_subagent->unregisterSnmpObject( delegated ) );
+}
+
+void tst_Registry::getOfManyVarbinds() {
+    QVector< QtSnmpOid > oids;
+    for ( int index = branch_objects; index > 0; index -= 3 ) {
+        oids << QtSnmpTestSupport::objectKey( 1, index );
+    }
+    oids << QtSnmpTestSupport::objectKey( 1, branch_objects + 1 );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( oids );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), oids.size() );
+    // the varbinds are answered in the order of the request
+    for ( int i = 0; i + 1 < oids.size(); ++i ) {
+        const QtSnmpFakeMaster::Varbind& varbind = response.varbinds.at( i );
+        QCOMPARE( varbind.oid, oids.at( i ) );
+        QCOMPARE( varbind.type, quint16( QtSnmpFakeMaster::TypeInteger ) );
+        QCOMPARE( varbind.number, quint64( branch_objects - 3 * i ) );
+    }
+    QCOMPARE( response.varbinds.last().type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+}
+
+QTEST_GUILESS_MAIN( tst_Registry )
+#include "tst_registry.moc"
@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_subtree
+SOURCES *= $${PWD}/tst_subtree.cpp
@@ -0,0 +1,209 @@
+#include <QtTest>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+Q_DECLARE_METATYPE( QtSnmpOid )
+
+// A subtree is registered with the master once and its objects are served in the order of
+// the OID index, as are the objects of ranges
+class tst_Subtree : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void registrations();
+    Q_SLOT void overlappingSubtree();
+    Q_SLOT void get();
+    Q_SLOT void getNext_data();
+    Q_SLOT void getNext();
+    Q_SLOT void walk();
+    Q_SLOT void bulkWalk_data();
+    Q_SLOT void bulkWalk();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+    // every object in the order of a walk
+    QVector< QtSnmpOid > m_objects;
+};
+
+namespace {
+    const char*const enterprise = ".1.3.6.1.4.1.99999";
+    const char*const subtree = ".1.3.6.1.4.1.99999.3";
+    const int range_objects = 20;
+    // the sub-identifier of the index in QtSnmpTestSupport::objectOid(), counted from 1
+    const quint8 range_subid = 9;
+
+    QtSnmpOid oid( const QString& suffix ) {
+        return QtSnmpOid::fromString( enterprise + suffix );
+    }
+
+    QtSnmpObjectDescription integer( const QString& suffix ) {
+        return QtSnmpObjectDescription( enterprise + suffix, QtSnmpObjectDescription::TypeInterger );
+    }
+
+    // the OIDs of the varbinds up to the end of the MIB view
+    QVector< QtSnmpOid > walked( const QtSnmpFakeMaster::VarbindList& varbinds, bool*const is_end ) {
+        QVector< QtSnmpOid > result;
+        for ( const auto& varbind : varbinds ) {
+            if ( QtSnmpFakeMaster::TypeEndOfMibView == varbind.type ) {
+                *is_end = true;
+                break;
+            }
+            result << varbind.oid;
+        }
+        return result;
+    }
+}
+
+void tst_Subtree::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_subtree" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_subtree" );
+
+    // registered by itself at first, then served by the subtree
+    QVERIFY( m_subagent->registerSnmpObject( integer( ".3.1.0" ), 31 ) );
+    QVERIFY( m_subagent->registerSnmpSubtree( subtree ) );
+    QVERIFY( m_subagent->registerSnmpObject( integer( ".3.10.0" ), 310 ) );
+    QVERIFY( m_subagent->registerSnmpObject( integer( ".3.2.1.0" ), 321 ) );
+    QVERIFY( m_subagent->registerSnmpObject( integer( ".3.2.0" ), 32 ) );
+
+    QtSnmpSubagent::ObjectList objects;
+    for ( int index = range_objects; index > 0; --index ) {
+        objects << qMakePair( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( 1, index ),
+                                                       QtSnmpObjectDescription::TypeInterger ),
+                              QVariant( index ) );
+    }
+    QVERIFY( m_subagent->registerSnmpObjects( objects ) );
+    QVERIFY( m_subagent->registerSnmpObject( integer( ".5.1.0" ), 51 ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+
+    for ( int index = 1; index <= range_objects; ++index ) {
+        m_objects << QtSnmpTestSupport::objectKey( 1, index );
+    }
+    m_objects << oid( ".3.1.0" ) << oid( ".3.2.0" ) << oid( ".3.2.1.0" ) << oid( ".3.10.0" ) << oid( ".5.1.0" );
+}
+
+void tst_Subtree::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Subtree::registrations() {
+    const QVector< QtSnmpFakeMaster::Registration > registrations = m_master.registrations();
+    QCOMPARE( registrations.size(), 3 );
+    bool has_subtree = false;
+    bool has_range = false;
+    bool has_instance = false;
+    for ( const auto& registration : registrations ) {
+        if ( QtSnmpOid::fromString( subtree ) == registration.root ) {
+            has_subtree = ( 0 == registration.range_subid ) && not registration.is_instance;
+        } else if ( QtSnmpTestSupport::objectKey( 1, 1 ) == registration.root ) {
+            has_range = ( range_subid == registration.range_subid )
+                        && ( quint32( range_objects ) == registration.upper_bound );
+        } else if ( oid( ".5.1.0" ) == registration.root ) {
+            has_instance = ( 0 == registration.range_subid ) && registration.is_instance;
+        }
+    }
+    QVERIFY( has_subtree );
+    QVERIFY( has_range );
+    QVERIFY( has_instance );
+}
+
+void tst_Subtree::overlappingSubtree() {
+    QVERIFY( not m_subagent->registerSnmpSubtree( QString( subtree ) + ".2" ) );
+    QVERIFY( not m_subagent->registerSnmpSubtree( enterprise ) );
+    QVERIFY( not m_subagent->registerSnmpSubtree( "not an oid" ) );
+    m_master.serve( 50 );
+    QCOMPARE( m_master.registrations().size(), 3 );
+}
+
+void tst_Subtree::get() {
+    const QtSnmpFakeMaster::Response response = m_master.get( { oid( ".3.10.0" ), oid( ".3.1.0" ), oid( ".3.3.0" ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 3 );
+    QCOMPARE( response.varbinds.at( 0 ).number, quint64( 310 ) );
+    QCOMPARE( response.varbinds.at( 1 ).number, quint64( 31 ) );
+    QCOMPARE( response.varbinds.at( 2 ).type, quint16( QtSnmpFakeMaster::TypeNoSuchInstance ) );
+}
+
+void tst_Subtree::getNext_data() {
+    QTest::addColumn< QtSnmpOid >( "start" );
+    QTest::addColumn< QtSnmpOid >( "next" );
+
+    QTest::newRow( "before the range" ) << oid( ".1" ) << QtSnmpTestSupport::objectKey( 1, 1 );
+    QTest::newRow( "inside the range" ) << QtSnmpTestSupport::objectKey( 1, 5 ) << QtSnmpTestSupport::objectKey( 1, 6 );
+    QTest::newRow( "between range objects" ) << oid( ".1.5" ) << QtSnmpTestSupport::objectKey( 1, 5 );
+    QTest::newRow( "end of the range" ) << QtSnmpTestSupport::objectKey( 1, range_objects ) << oid( ".3.1.0" );
+    QTest::newRow( "into a longer OID" ) << oid( ".3.2.0" ) << oid( ".3.2.1.0" );
+    QTest::newRow( "numeric order" ) << oid( ".3.2.1.0" ) << oid( ".3.10.0" );
+    QTest::newRow( "out of the subtree" ) << oid( ".3.10.0" ) << oid( ".5.1.0" );
+    QTest::newRow( "last object" ) << oid( ".5.1.0" ) << QtSnmpOid();
+}
+
+void tst_Subtree::getNext() {
+    QFETCH( QtSnmpOid, start );
+    QFETCH( QtSnmpOid, next );
+
+    const QtSnmpFakeMaster::Response response = m_master.getNext( { start } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 1 );
+    if ( next.isEmpty() ) {
+        QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeEndOfMibView ) );
+    } else {
+        QCOMPARE( response.varbinds.first().oid, next );
+        QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeInteger ) );
+    }
+}
+
+void tst_Subtree::walk() {
+    QVector< QtSnmpOid > result;
+    QtSnmpOid current = QtSnmpOid::fromString( enterprise );
+    bool is_end = false;
+    while ( not is_end && ( result.size() <= m_objects.size() ) ) {
+        const QtSnmpFakeMaster::Response response = m_master.getNext( { current } );
+        QVERIFY( response.is_valid );
+        const QVector< QtSnmpOid > oids = walked( response.varbinds, &is_end );
+        if ( oids.isEmpty() ) {
+            break;
+        }
+        result << oids;
+        current = oids.last();
+    }
+    QVERIFY( is_end );
+    QCOMPARE( result, m_objects );
+}
+
+void tst_Subtree::bulkWalk_data() {
+    QTest::addColumn< int >( "repetitions" );
+    QTest::newRow( "1" ) << 1;
+    QTest::newRow( "7" ) << 7;
+    QTest::newRow( "all" ) << 100;
+}
+
+void tst_Subtree::bulkWalk() {
+    QFETCH( int, repetitions );
+
+    QVector< QtSnmpOid > result;
+    QtSnmpOid current = QtSnmpOid::fromString( enterprise );
+    bool is_end = false;
+    while ( not is_end && ( result.size() <= m_objects.size() ) ) {
+        const QtSnmpFakeMaster::Response response = m_master.getBulk( { current }, 0, quint16( repetitions ) );
+        QVERIFY( response.is_valid );
+        QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+        QVERIFY( response.varbinds.size() <= repetitions );
+        const QVector< QtSnmpOid > oids = walked( response.varbinds, &is_end );
+        if ( oids.isEmpty() ) {
+            break;
+        }
+        result << oids;
+        current = oids.last();
+    }
+    QVERIFY( is_end );
+    QCOMPARE( result, m_objects );
+}
+
+QTEST_GUILESS_MAIN( tst_Subtree )
+#include "tst_subtree.moc"
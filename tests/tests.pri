@@ -0,0 +1,12 @@
+exists( $${PWD}/../../config.pri ) : include($${PWD}/../../config.pri)
+QT = core network testlib
+TEMPLATE = app
+CONFIG *= testcase console c++11
+CONFIG -= app_bundle
+
+# the library and the fake master are built in
+include( $${PWD}/common/common.pri )
+INCLUDEPATH *= $${PWD}/../src
+HEADERS *= $$files( $${PWD}/../src/*.h )
+SOURCES *= $$files( $${PWD}/../src/*.cpp )
+unix : LIBS *= $$system(net-snmp-config --agent-libs)
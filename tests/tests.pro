@@ -0,0 +1,13 @@
+TEMPLATE = subdirs
+SUBDIRS *= netsnmploop \
+           registry \
+           subtree \
+           values \
+           types \
+           bulk \
+           agentx \
+           transport \
+           instances \
+           binarytypes \
+           validators \
+           notifications
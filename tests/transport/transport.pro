@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_transport
+SOURCES *= $${PWD}/tst_transport.cpp
@@ -0,0 +1,151 @@
+#include <QtTest>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// The connection settings: the defaults, sessions over TCP and Unix sockets with the name
+// and the timeout of the Open PDU, and new settings applied to a running subagent
+class tst_Transport : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void defaults();
+    Q_SLOT void serve_data();
+    Q_SLOT void serve();
+    Q_SLOT void changeMaster();
+    Q_SLOT void changeApplicationName();
+    Q_SLOT void deleteRunning();
+};
+
+namespace {
+    const QString object_oid = QtSnmpTestSupport::objectOid( 1, 1 );
+
+    QtSnmpSubagent* create_subagent( const QString& name ) {
+        QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", name );
+        subagent->registerSnmpObject( QtSnmpObjectDescription( object_oid, QtSnmpObjectDescription::TypeInterger ), 15 );
+        return subagent;
+    }
+
+    bool is_served( QtSnmpFakeMaster& master, const int session ) {
+        const QtSnmpFakeMaster::Response response = master.get( { QtSnmpOid::fromString( object_oid ) }, session );
+        return response.is_valid && ( 15 == response.varbinds.value( 0 ).number );
+    }
+}
+
+void tst_Transport::defaults() {
+    QtSnmpSubagent*const subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_transport" );
+    QCOMPARE( subagent->masterAddress(), QString( "tcp:localhost:705" ) );
+    QCOMPARE( subagent->applicationName(), QString( "tst_transport" ) );
+    QVERIFY( subagent->timeout() < 0 );
+    QVERIFY( subagent->retries() < 0 );
+
+    // set before start() and read back from any thread
+    subagent->setMasterAddress( "unix:/var/agentx/master" );
+    subagent->setApplicationName( "renamed" );
+    subagent->setTimeout( 2500 );
+    subagent->setRetries( 3 );
+    QCOMPARE( subagent->masterAddress(), QString( "unix:/var/agentx/master" ) );
+    QCOMPARE( subagent->applicationName(), QString( "renamed" ) );
+    QCOMPARE( subagent->timeout(), 2500 );
+    QCOMPARE( subagent->retries(), 3 );
+    QCOMPARE( subagent->connectionState(), QtSnmpSubagent::StateStopped );
+    QtSnmpTestSupport::destroySubagent( subagent );
+}
+
+void tst_Transport::serve_data() {
+    QTest::addColumn< QString >( "transport" );
+    QTest::newRow( "unix" ) << QString( "unix" );
+    QTest::newRow( "tcp" ) << QString( "tcp" );
+}
+
+void tst_Transport::serve() {
+    QFETCH( QString, transport );
+
+    QtSnmpFakeMaster master;
+    QVERIFY( master.listen( QtSnmpTestSupport::masterAddress( transport, "tst_transport" ) ) );
+    QVERIFY( master.address().startsWith( transport + ":" ) );
+    QtSnmpSubagent*const subagent = create_subagent( "transport over " + transport );
+    // whole seconds in the Open PDU, rounded up
+    subagent->setTimeout( 2500 );
+    const bool is_started = ( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+    const bool is_get_served = is_started && is_served( master, 0 );
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QVERIFY( is_started );
+    QVERIFY( is_get_served );
+    QCOMPARE( master.sessions(), 1 );
+    QCOMPARE( master.sessionDescription( 0 ), "transport over " + transport );
+    QCOMPARE( master.sessionTimeout( 0 ), 3 );
+}
+
+void tst_Transport::changeMaster() {
+    QtSnmpFakeMaster first;
+    QtSnmpFakeMaster second;
+    QVERIFY( first.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_transport_first" ) ) );
+    QVERIFY( second.listen( QtSnmpTestSupport::masterAddress( "tcp", "tst_transport_second" ) ) );
+    QtSnmpSubagent*const subagent = create_subagent( "tst_transport" );
+    QAtomicInt ready( 0 );
+    QObject::connect( subagent, &QtSnmpSubagent::ready, [ &ready ]() { ready.ref(); } );
+    const bool is_started = ( QtSnmpTestSupport::startSubagent( subagent, first, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+
+    // the running subagent leaves the first master and registers with the second
+    subagent->setMasterAddress( second.address() );
+    const bool is_moved = second.waitForRegistrations( 1 )
+                          && first.waitUntil( [ &first ]() { return not first.isOpen( 0 ); } );
+    // the new session is reported as a reconnect
+    const bool is_reconnected = second.waitUntil( [ subagent ]() {
+        return 1 == subagent->sessionStatistics().reconnects;
+    } );
+    const bool is_get_served = is_moved && is_served( second, 0 );
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QVERIFY( is_started );
+    QVERIFY( is_moved );
+    QVERIFY( is_reconnected );
+    QCOMPARE( ready.load(), 2 );
+    QVERIFY( is_get_served );
+    QCOMPARE( first.sessions(), 1 );
+    QCOMPARE( second.sessions(), 1 );
+}
+
+void tst_Transport::changeApplicationName() {
+    QtSnmpFakeMaster master;
+    QVERIFY( master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_transport" ) ) );
+    QtSnmpSubagent*const subagent = create_subagent( "first name" );
+    QAtomicInt ready( 0 );
+    QObject::connect( subagent, &QtSnmpSubagent::ready, [ &ready ]() { ready.ref(); } );
+    const bool is_started = ( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+
+    // the name is sent in the Open PDU of a new session, which connects the subagent once more
+    subagent->setApplicationName( "second name" );
+    const bool is_reopened = master.waitUntil( [ &master ]() {
+        return ( 2 == master.sessions() ) && master.isOpen( 1 ) && not master.isOpen( 0 );
+    } ) && master.waitUntil( [ subagent ]() {
+        return 1 == subagent->sessionStatistics().reconnects;
+    } );
+    const bool is_get_served = is_reopened && is_served( master, 1 );
+    QtSnmpTestSupport::destroySubagent( subagent );
+
+    QVERIFY( is_started );
+    QVERIFY( is_reopened );
+    QCOMPARE( ready.load(), 2 );
+    QVERIFY( is_get_served );
+    QCOMPARE( master.sessionDescription( 0 ), QString( "first name" ) );
+    QCOMPARE( master.sessionDescription( 1 ), QString( "second name" ) );
+}
+
+void tst_Transport::deleteRunning() {
+    QtSnmpFakeMaster master;
+    QVERIFY( master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_transport" ) ) );
+    QtSnmpSubagent*const subagent = create_subagent( "tst_transport" );
+    QVERIFY( QtSnmpTestSupport::startSubagent( subagent, master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+
+    // deleted by another thread without stop(), the agent thread closes the session first;
+    // the thread quits and is deleted once the subagent is gone
+    delete subagent;
+    QVERIFY( master.waitUntil( [ &master ]() { return not master.isOpen( 0 ); } ) );
+    QCOMPARE( master.sessions(), 1 );
+}
+
+QTEST_GUILESS_MAIN( tst_Transport )
+#include "tst_transport.moc"
@@ -0,0 +1,152 @@
+#include <QtTest>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Values are kept in their wire form: every type is encoded once when it is published and
+// a GET sends the stored bytes under the ASN type of the object
+class tst_Types : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void wireForm_data();
+    Q_SLOT void wireForm();
+    Q_SLOT void realText_data();
+    Q_SLOT void realText();
+    Q_SLOT void stringAfterUpdate();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+    int m_next_index = 1;
+};
+
+namespace {
+    const int branch = 7;
+    const char*const subtree = ".1.3.6.1.4.1.99999.7";
+}
+
+void tst_Types::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_types" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_types" );
+    // objects are registered by the tests, the session serves the whole branch
+    QVERIFY( m_subagent->registerSnmpSubtree( subtree ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_Types::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Types::wireForm_data() {
+    QTest::addColumn< int >( "type" );
+    QTest::addColumn< QVariant >( "value" );
+    QTest::addColumn< int >( "asn_type" );
+    QTest::addColumn< quint64 >( "number" );
+    QTest::addColumn< QByteArray >( "octets" );
+
+    typedef QtSnmpObjectDescription Description;
+    typedef QtSnmpFakeMaster Master;
+    QTest::newRow( "integer" ) << int( Description::TypeInterger ) << QVariant( 42 )
+                               << int( Master::TypeInteger ) << quint64( 42 ) << QByteArray();
+    QTest::newRow( "negative integer" ) << int( Description::TypeInterger ) << QVariant( -5 )
+                                        << int( Master::TypeInteger ) << quint64( 0xFFFFFFFBu ) << QByteArray();
+    QTest::newRow( "enum" ) << int( Description::TypeEnum ) << QVariant( 3 )
+                            << int( Master::TypeInteger ) << quint64( 3 ) << QByteArray();
+    QTest::newRow( "unsigned" ) << int( Description::TypeUnsigned ) << QVariant( 7u )
+                                << int( Master::TypeGauge32 ) << quint64( 7 ) << QByteArray();
+    QTest::newRow( "gauge" ) << int( Description::TypeGauge ) << QVariant( 4000000000u )
+                             << int( Master::TypeGauge32 ) << quint64( 4000000000u ) << QByteArray();
+    QTest::newRow( "counter" ) << int( Description::TypeCounter ) << QVariant( 4294967295u )
+                               << int( Master::TypeCounter32 ) << quint64( 4294967295u ) << QByteArray();
+    QTest::newRow( "time ticks" ) << int( Description::TypeTimeTicks ) << QVariant( 12345u )
+                                  << int( Master::TypeTimeTicks ) << quint64( 12345 ) << QByteArray();
+    QTest::newRow( "ip address" ) << int( Description::TypeIpAddress ) << QVariant( "192.168.1.20" )
+                                  << int( Master::TypeIpAddress ) << quint64( 0 ) << QByteArray( "\xc0\xa8\x01\x14", 4 );
+    QTest::newRow( "string" ) << int( Description::TypeString ) << QVariant( "hello" )
+                              << int( Master::TypeOctetString ) << quint64( 0 ) << QByteArray( "hello" );
+    QTest::newRow( "empty string" ) << int( Description::TypeString ) << QVariant( "" )
+                                    << int( Master::TypeOctetString ) << quint64( 0 ) << QByteArray();
+    QTest::newRow( "real" ) << int( Description::TypeReal ) << QVariant( 1.5 )
+                            << int( Master::TypeOctetString ) << quint64( 0 ) << QByteArray( "1.5" );
+    QTest::newRow( "counter64" ) << int( Description::TypeCounter64 ) << QVariant( Q_UINT64_C( 0x123456789ABCDEF0 ) )
+                                 << int( Master::TypeCounter64 ) << Q_UINT64_C( 0x123456789ABCDEF0 ) << QByteArray();
+}
+
+void tst_Types::wireForm() {
+    QFETCH( int, type );
+    QFETCH( QVariant, value );
+    QFETCH( int, asn_type );
+    QFETCH( quint64, number );
+    QFETCH( QByteArray, octets );
+
+    const QString oid = QtSnmpTestSupport::objectOid( branch, m_next_index++ );
+    QtSnmpObjectDescription description( oid, static_cast< QtSnmpObjectDescription::Type >( type ) );
+    description.setReadOnly( true );
+    QVERIFY( m_subagent->registerSnmpObject( description, value ) );
+
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpOid::fromString( oid ) } );
+    QVERIFY( response.is_valid );
+    QCOMPARE( response.error, quint16( QtSnmpFakeMaster::NoError ) );
+    QCOMPARE( response.varbinds.size(), 1 );
+    const QtSnmpFakeMaster::Varbind& varbind = response.varbinds.first();
+    QCOMPARE( int( varbind.type ), asn_type );
+    QCOMPARE( varbind.number, number );
+    QCOMPARE( varbind.octets, octets );
+
+    // the application reads back what it has published
+    QCOMPARE( m_subagent->value( oid ).toString(), value.toString() );
+}
+
+void tst_Types::realText_data() {
+    QTest::addColumn< double >( "value" );
+    QTest::addColumn< QByteArray >( "text" );
+
+    QTest::newRow( "fraction" ) << 2.25 << QByteArray( "2.25" );
+    QTest::newRow( "nine digits" ) << 3.14159265358979 << QByteArray( "3.14159265" );
+    QTest::newRow( "negative" ) << -0.001 << QByteArray( "-0.001" );
+    QTest::newRow( "large" ) << 1e20 << QByteArray( "1e+20" );
+    QTest::newRow( "zero" ) << 0.0 << QByteArray( "0" );
+}
+
+void tst_Types::realText() {
+    QFETCH( double, value );
+    QFETCH( QByteArray, text );
+
+    const QString oid = QtSnmpTestSupport::objectOid( branch, m_next_index++ );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeReal ), 100.0 ) );
+    QtSnmpHandle< double > handle = m_subagent->handle< double >( oid );
+    QVERIFY( not handle.isNull() );
+
+    // the text follows the value however it is published
+    m_subagent->setValue( oid, value );
+    QCOMPARE( m_master.get( { QtSnmpOid::fromString( oid ) } ).varbinds.value( 0 ).octets, text );
+    QVERIFY( handle.set( value + 1.0 ) );
+    QCOMPARE( m_master.get( { QtSnmpOid::fromString( oid ) } ).varbinds.value( 0 ).octets,
+              QByteArray::number( value + 1.0, 'g', 9 ) );
+    QVERIFY( handle.set( value ) );
+    QCOMPARE( m_master.get( { QtSnmpOid::fromString( oid ) } ).varbinds.value( 0 ).octets, text );
+    QCOMPARE( m_subagent->value( oid ).toDouble(), value );
+}
+
+void tst_Types::stringAfterUpdate() {
+    const QString oid = QtSnmpTestSupport::objectOid( branch, m_next_index++ );
+    QVERIFY( m_subagent->registerSnmpObject( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeString ), "first" ) );
+    QtSnmpHandle< QByteArray > handle = m_subagent->handle< QByteArray >( oid );
+    QVERIFY( not handle.isNull() );
+
+    const QVector< QtSnmpOid > oids = { QtSnmpOid::fromString( oid ) };
+    QCOMPARE( m_master.get( oids ).varbinds.value( 0 ).octets, QByteArray( "first" ) );
+    m_subagent->setValue( oid, "a longer second value" );
+    QCOMPARE( m_master.get( oids ).varbinds.value( 0 ).octets, QByteArray( "a longer second value" ) );
+    QVERIFY( handle.set( QByteArray( "3" ) ) );
+    QCOMPARE( m_master.get( oids ).varbinds.value( 0 ).octets, QByteArray( "3" ) );
+    QCOMPARE( m_subagent->value( oid ).toString(), QString( "3" ) );
+    // a handle of another type is refused
+    QVERIFY( m_subagent->handle< qint32 >( oid ).isNull() );
+}
+
+QTEST_GUILESS_MAIN( tst_Types )
+#include "tst_types.moc"
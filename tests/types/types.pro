@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_types
+SOURCES *= $${PWD}/tst_types.cpp
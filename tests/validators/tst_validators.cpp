@@ -0,0 +1,181 @@
+#include <QtTest>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpValidator.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Validators are interned: objects of equal constraints share one, so two validators must be
+// equal exactly when they accept the same values, and each object keeps its own limits
+class tst_Validators : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void equalConstraints();
+    Q_SLOT void differentConstraints();
+    Q_SLOT void checks();
+    Q_SLOT void inconsistentConstraints();
+    Q_SLOT void sharedLimits();
+    Q_SLOT void reregistered();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+};
+
+namespace {
+    const int shared_objects = 100;
+    const int shared_maximum = 50;
+
+    QtSnmpObjectDescription limited( const QString& oid,
+                                     const QtSnmpObjectDescription::Type type,
+                                     const QVariant& minimum,
+                                     const QVariant& maximum )
+    {
+        QtSnmpObjectDescription result( oid, type );
+        result.setLimits( minimum, maximum );
+        return result;
+    }
+
+    QtSnmpObjectDescription enumeration( const QString& oid, const QList< QVariant >& values ) {
+        QtSnmpObjectDescription result( oid, QtSnmpObjectDescription::TypeEnum );
+        result.setAvailableValues( values );
+        return result;
+    }
+
+    QtSnmpSubagent::ObjectList shared_list( const int branch, const int maximum ) {
+        QtSnmpSubagent::ObjectList result;
+        for ( int index = 1; index <= shared_objects; ++index ) {
+            result << qMakePair( limited( QtSnmpTestSupport::objectOid( branch, index ), QtSnmpObjectDescription::TypeInterger, 0, maximum ),
+                                 QVariant( 0 ) );
+        }
+        return result;
+    }
+}
+
+void tst_Validators::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_validators" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_validators" );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_Validators::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Validators::equalConstraints() {
+    const QtSnmpValidator first( limited( ".1.3.6.1.4.1.99999.1.1.0", QtSnmpObjectDescription::TypeInterger, 0, 100 ) );
+    // the OID and the access are not constraints
+    QtSnmpObjectDescription other_object = limited( ".1.3.6.1.4.1.99999.2.7.0", QtSnmpObjectDescription::TypeInterger, 0, 100 );
+    other_object.setReadOnly( true );
+    const QtSnmpValidator second( other_object );
+    QVERIFY( first == second );
+    QCOMPARE( qHash( first ), qHash( second ) );
+
+    // the values of an enumeration are compared as a set
+    const QtSnmpValidator ordered( enumeration( ".1.3.6.1.4.1.99999.1.2.0", { 1, 2, 5 } ) );
+    const QtSnmpValidator unordered( enumeration( ".1.3.6.1.4.1.99999.1.3.0", { 5, 1, 2 } ) );
+    QVERIFY( ordered == unordered );
+    QCOMPARE( qHash( ordered ), qHash( unordered ) );
+
+    // limits given as other QVariant types convert to the same native ones
+    const QtSnmpValidator text_limits( limited( ".1.3.6.1.4.1.99999.1.4.0", QtSnmpObjectDescription::TypeInterger, "0", "100" ) );
+    QVERIFY( first == text_limits );
+}
+
+void tst_Validators::differentConstraints() {
+    const QString oid = QtSnmpTestSupport::objectOid( 1, 1 );
+    const QtSnmpValidator base( limited( oid, QtSnmpObjectDescription::TypeInterger, 0, 100 ) );
+    QtSnmpObjectDescription with_step = limited( oid, QtSnmpObjectDescription::TypeInterger, 0, 100 );
+    with_step.setStep( 5 );
+
+    QVERIFY( base != QtSnmpValidator( limited( oid, QtSnmpObjectDescription::TypeInterger, 0, 101 ) ) );
+    QVERIFY( base != QtSnmpValidator( limited( oid, QtSnmpObjectDescription::TypeInterger, 1, 100 ) ) );
+    QVERIFY( base != QtSnmpValidator( with_step ) );
+    QVERIFY( base != QtSnmpValidator( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeInterger ) ) );
+    // the same limits of another type
+    QVERIFY( base != QtSnmpValidator( limited( oid, QtSnmpObjectDescription::TypeGauge, 0u, 100u ) ) );
+    QVERIFY( QtSnmpValidator( enumeration( oid, { 1, 2 } ) ) != QtSnmpValidator( enumeration( oid, { 1, 2, 3 } ) ) );
+    QVERIFY( QtSnmpValidator( limited( oid, QtSnmpObjectDescription::TypeDouble, 0.0, 1.0 ) )
+             != QtSnmpValidator( limited( oid, QtSnmpObjectDescription::TypeFloat, 0.0, 1.0 ) ) );
+}
+
+void tst_Validators::checks() {
+    const QString oid = QtSnmpTestSupport::objectOid( 1, 1 );
+    QtSnmpObjectDescription stepped = limited( oid, QtSnmpObjectDescription::TypeInterger, -10, 10 );
+    stepped.setStep( 5 );
+    const QtSnmpValidator integer( stepped );
+    QVERIFY( integer.check( -10 ) );
+    QVERIFY( integer.check( 5 ) );
+    QVERIFY( not integer.check( 6 ) );
+    QVERIFY( not integer.check( 15 ) );
+
+    const QtSnmpValidator enum_values( enumeration( oid, { 3, 1, 2 } ) );
+    QVERIFY( enum_values.check( 2 ) );
+    QVERIFY( not enum_values.check( 4 ) );
+
+    const QtSnmpValidator counter64( limited( oid, QtSnmpObjectDescription::TypeCounter64,
+                                              QVariant::fromValue( Q_UINT64_C( 0x100000000 ) ),
+                                              QVariant::fromValue( Q_UINT64_C( 0x200000000 ) ) ) );
+    QVERIFY( counter64.checkUnsigned( Q_UINT64_C( 0x180000000 ) ) );
+    QVERIFY( not counter64.checkUnsigned( 5 ) );
+
+    const QtSnmpValidator real( limited( oid, QtSnmpObjectDescription::TypeDouble, -0.5, 0.5 ) );
+    QVERIFY( real.checkReal( 0.25 ) );
+    QVERIFY( not real.checkReal( 0.75 ) );
+
+    const QtSnmpValidator unconstrained( QtSnmpObjectDescription( oid, QtSnmpObjectDescription::TypeString ) );
+    QVERIFY( unconstrained.check( QString( "any text" ) ) );
+}
+
+void tst_Validators::inconsistentConstraints() {
+    // limits the type can not hold refuse every value instead of a wrong one
+    const QtSnmpValidator validator( limited( QtSnmpTestSupport::objectOid( 1, 1 ), QtSnmpObjectDescription::TypeInterger, "low", "high" ) );
+    QVERIFY( not validator.check( 0 ) );
+    QVERIFY( not validator.checkInteger( 1 ) );
+    QVERIFY( validator != QtSnmpValidator( limited( QtSnmpTestSupport::objectOid( 1, 1 ), QtSnmpObjectDescription::TypeInterger, 0, 0 ) ) );
+}
+
+void tst_Validators::sharedLimits() {
+    // objects of one shared validator and one object of nearly the same limits
+    QVERIFY( m_subagent->registerSnmpObjects( shared_list( 2, shared_maximum ) ) );
+    const QString neighbour = QtSnmpTestSupport::objectOid( 3, 1 );
+    QVERIFY( m_subagent->registerSnmpObject( limited( neighbour, QtSnmpObjectDescription::TypeInterger, 0, shared_maximum + 1 ), 0 ) );
+    QVERIFY( m_master.waitForRegistrations( 2 ) );
+
+    for ( const int index : { 1, shared_objects / 2, shared_objects } ) {
+        const QtSnmpOid oid = QtSnmpTestSupport::objectKey( 2, index );
+        QCOMPARE( m_master.set( { QtSnmpFakeMaster::integerVarbind( oid, shared_maximum ) } ).error,
+                  quint16( QtSnmpFakeMaster::NoError ) );
+        QCOMPARE( m_master.set( { QtSnmpFakeMaster::integerVarbind( oid, shared_maximum + 1 ) } ).error,
+                  quint16( QtSnmpFakeMaster::WrongValue ) );
+    }
+    QCOMPARE( m_master.set( { QtSnmpFakeMaster::integerVarbind( QtSnmpOid::fromString( neighbour ), shared_maximum + 1 ) } ).error,
+              quint16( QtSnmpFakeMaster::NoError ) );
+
+    // the handles check the same limits
+    QtSnmpHandle< qint32 > shared = m_subagent->handle< qint32 >( QtSnmpTestSupport::objectOid( 2, 7 ) );
+    QtSnmpHandle< qint32 > own = m_subagent->handle< qint32 >( neighbour );
+    QVERIFY( not shared.set( shared_maximum + 1 ) );
+    QVERIFY( own.set( shared_maximum + 1 ) );
+    QCOMPARE( shared.get(), 0 );
+}
+
+void tst_Validators::reregistered() {
+    // a validator no object uses any more is not handed out again, the new objects get their own limits
+    QVERIFY( m_subagent->unregisterSnmpSubtree( ".1.3.6.1.4.1.99999.2" ) );
+    QVERIFY( m_subagent->registerSnmpObjects( shared_list( 4, shared_maximum * 2 ) ) );
+    QtSnmpHandle< qint32 > handle = m_subagent->handle< qint32 >( QtSnmpTestSupport::objectOid( 4, 1 ) );
+    QVERIFY( handle.set( shared_maximum * 2 ) );
+    QVERIFY( not handle.set( shared_maximum * 2 + 1 ) );
+
+    // the same constraints as before the removal are shared again
+    QVERIFY( m_subagent->registerSnmpObjects( shared_list( 2, shared_maximum ) ) );
+    handle = m_subagent->handle< qint32 >( QtSnmpTestSupport::objectOid( 2, shared_objects ) );
+    QVERIFY( handle.set( shared_maximum ) );
+    QVERIFY( not handle.set( shared_maximum + 1 ) );
+}
+
+QTEST_GUILESS_MAIN( tst_Validators )
+#include "tst_validators.moc"
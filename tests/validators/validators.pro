@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_validators
+SOURCES *= $${PWD}/tst_validators.cpp
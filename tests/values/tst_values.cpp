@@ -0,0 +1,252 @@
+#include <QtTest>
+#include <QAtomicInt>
+#include <memory>
+#include <vector>
+#include "QtSnmpSubagent.h"
+#include "QtSnmpFakeMaster.h"
+#include "QtSnmpTestSupport.h"
+
+// Producers publish values from threads of their own while the test thread and the agent
+// thread read them; a reader must see every value whole, either the old or the new one
+class tst_Values : public QObject {
+    Q_OBJECT
+
+private:
+    Q_SLOT void initTestCase();
+    Q_SLOT void cleanupTestCase();
+    Q_SLOT void setValueFromProducers();
+    Q_SLOT void handlesFromProducers();
+    Q_SLOT void getWhileProducing();
+    Q_SLOT void registerWhileProducing();
+
+private:
+    QtSnmpFakeMaster m_master;
+    QtSnmpSubagent* m_subagent = nullptr;
+};
+
+namespace {
+    typedef std::vector< std::unique_ptr< QtSnmpTestSupport::Worker > > WorkerList;
+
+    const int producers = 4;
+    const int updates = 20000;
+    const int late_objects = 1000;
+
+    const QString shared_counter = QtSnmpTestSupport::objectOid( 4, 1 );
+    const QString shared_string = QtSnmpTestSupport::objectOid( 3, 1 );
+
+    // the index of the object a producer alone writes
+    QString own_integer( const int producer ) {
+        return QtSnmpTestSupport::objectOid( 1, producer + 1 );
+    }
+
+    // both halves carry the same number, a torn value does not
+    quint64 counter_value( const quint32 number ) {
+        return ( static_cast< quint64 >( number ) << 32 ) | number;
+    }
+
+    bool is_whole_counter( const quint64 value ) {
+        return ( value >> 32 ) == ( value & 0xFFFFFFFFu );
+    }
+
+    // one repeated letter, the letter determines the length
+    QByteArray string_value( const int number ) {
+        const int letter = number % 26;
+        return QByteArray( 8 + 3 * letter, static_cast< char >( 'a' + letter ) );
+    }
+
+    bool is_whole_string( const QByteArray& value ) {
+        if ( value.isEmpty() ) {
+            return false;
+        }
+        const char letter = value.at( 0 );
+        if ( ( letter < 'a' ) || ( letter > 'z' ) || ( value.size() != 8 + 3 * ( letter - 'a' ) ) ) {
+            return false;
+        }
+        for ( const char octet : value ) {
+            if ( octet != letter ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void start( WorkerList& workers, const std::function< void( int ) >& body ) {
+        for ( int producer = 0; producer < producers; ++producer ) {
+            workers.emplace_back( new QtSnmpTestSupport::Worker( [ body, producer ]() { body( producer ); } ) );
+            workers.back()->start();
+        }
+    }
+
+    bool is_running( const WorkerList& workers ) {
+        for ( const auto& worker : workers ) {
+            if ( not worker->isFinished() ) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void wait( WorkerList& workers ) {
+        for ( const auto& worker : workers ) {
+            worker->wait();
+        }
+    }
+}
+
+void tst_Values::initTestCase() {
+    QVERIFY( m_master.listen( QtSnmpTestSupport::masterAddress( "unix", "tst_values" ) ) );
+    m_subagent = QtSnmpTestSupport::createSubagent( "agentx", "tst_values" );
+    QtSnmpSubagent::ObjectList objects;
+    for ( int producer = 0; producer < producers; ++producer ) {
+        objects << qMakePair( QtSnmpObjectDescription( own_integer( producer ), QtSnmpObjectDescription::TypeInterger ),
+                              QVariant( -1 ) );
+    }
+    objects << qMakePair( QtSnmpObjectDescription( shared_counter, QtSnmpObjectDescription::TypeCounter64 ),
+                          QVariant( static_cast< qulonglong >( counter_value( 0 ) ) ) );
+    objects << qMakePair( QtSnmpObjectDescription( shared_string, QtSnmpObjectDescription::TypeString ),
+                          QVariant( QString::fromLatin1( string_value( 0 ) ) ) );
+    QVERIFY( m_subagent->registerSnmpObjects( objects ) );
+    QVERIFY( QtSnmpTestSupport::startSubagent( m_subagent, m_master, QtSnmpFakeMaster::DefaultTimeout ) >= 0 );
+}
+
+void tst_Values::cleanupTestCase() {
+    QtSnmpTestSupport::destroySubagent( m_subagent );
+}
+
+void tst_Values::setValueFromProducers() {
+    WorkerList workers;
+    start( workers, [ this ]( const int producer ) {
+        for ( int i = 0; i < updates; ++i ) {
+            const quint32 number = static_cast< quint32 >( producer * updates + i );
+            m_subagent->setValue( shared_counter, static_cast< qulonglong >( counter_value( number ) ) );
+            m_subagent->setValue( shared_string, QString::fromLatin1( string_value( i ) ) );
+            m_subagent->setValue( own_integer( producer ), i );
+        }
+    } );
+
+    int reads = 0;
+    int torn = 0;
+    while ( is_running( workers ) ) {
+        torn += is_whole_counter( m_subagent->value( shared_counter ).toULongLong() ) ? 0 : 1;
+        torn += is_whole_string( m_subagent->value( shared_string ).toString().toLatin1() ) ? 0 : 1;
+        ++reads;
+    }
+    wait( workers );
+    QVERIFY( reads > 0 );
+    QCOMPARE( torn, 0 );
+
+    // no update is lost or applied late
+    for ( int producer = 0; producer < producers; ++producer ) {
+        QCOMPARE( m_subagent->value( own_integer( producer ) ).toInt(), updates - 1 );
+    }
+    QVERIFY( is_whole_counter( m_subagent->value( shared_counter ).toULongLong() ) );
+}
+
+void tst_Values::handlesFromProducers() {
+    QtSnmpHandle< quint64 > counter = m_subagent->handle< quint64 >( shared_counter );
+    QtSnmpHandle< QByteArray > string = m_subagent->handle< QByteArray >( shared_string );
+    QVERIFY( not counter.isNull() );
+    QVERIFY( not string.isNull() );
+
+    QAtomicInt refused( 0 );
+    WorkerList workers;
+    start( workers, [ & ]( const int producer ) {
+        for ( int i = 0; i < updates; ++i ) {
+            const quint32 number = static_cast< quint32 >( producer * updates + i );
+            if ( not counter.set( counter_value( number ) ) || not string.set( string_value( i ) ) ) {
+                refused.ref();
+            }
+        }
+    } );
+
+    int torn = 0;
+    while ( is_running( workers ) ) {
+        torn += is_whole_counter( counter.get() ) ? 0 : 1;
+        torn += is_whole_string( string.get() ) ? 0 : 1;
+        // the registry reads the same value
+        torn += is_whole_counter( m_subagent->value( shared_counter ).toULongLong() ) ? 0 : 1;
+    }
+    wait( workers );
+    QCOMPARE( torn, 0 );
+    QCOMPARE( refused.load(), 0 );
+    QCOMPARE( m_subagent->value( shared_counter ).toULongLong(), counter.get() );
+}
+
+void tst_Values::getWhileProducing() {
+    QAtomicInt stop( 0 );
+    WorkerList workers;
+    start( workers, [ & ]( const int producer ) {
+        for ( quint32 i = 0; 0 == stop.load(); ++i ) {
+            m_subagent->setValue( shared_counter, static_cast< qulonglong >( counter_value( i * producers + producer ) ) );
+            m_subagent->setValue( shared_string, QString::fromLatin1( string_value( static_cast< int >( i ) ) ) );
+        }
+    } );
+
+    // the agent thread encodes the values while they change
+    const QVector< QtSnmpOid > oids = { QtSnmpOid::fromString( shared_counter ), QtSnmpOid::fromString( shared_string ) };
+    bool is_whole = true;
+    for ( int i = 0; ( i < 500 ) && is_whole; ++i ) {
+        const QtSnmpFakeMaster::Response response = m_master.get( oids );
+        is_whole = response.is_valid
+                   && ( QtSnmpFakeMaster::NoError == response.error )
+                   && ( 2 == response.varbinds.size() )
+                   && ( QtSnmpFakeMaster::TypeCounter64 == response.varbinds.at( 0 ).type )
+                   && is_whole_counter( response.varbinds.at( 0 ).number )
+                   && ( QtSnmpFakeMaster::TypeOctetString == response.varbinds.at( 1 ).type )
+                   && is_whole_string( response.varbinds.at( 1 ).octets );
+    }
+    stop.ref();
+    wait( workers );
+    QVERIFY( is_whole );
+}
+
+void tst_Values::registerWhileProducing() {
+    // one thread extends the registry while the others publish
+    QtSnmpTestSupport::Worker registrar( [ this ]() {
+        for ( int index = 1; index <= late_objects; ++index ) {
+            m_subagent->registerSnmpObject( QtSnmpObjectDescription( QtSnmpTestSupport::objectOid( 2, index ),
+                                                                     QtSnmpObjectDescription::TypeGauge ),
+                                            static_cast< uint >( index ) );
+        }
+    } );
+    WorkerList workers;
+    start( workers, [ this ]( const int producer ) {
+        for ( int i = 0; i < updates; ++i ) {
+            m_subagent->setValue( own_integer( producer ), i );
+        }
+    } );
+    registrar.start();
+
+    int wrong = 0;
+    while ( not registrar.isFinished() ) {
+        // not registered yet or registered with its value
+        const QVariant value = m_subagent->value( QtSnmpTestSupport::objectOid( 2, late_objects / 2 ) );
+        wrong += ( not value.isValid() || ( static_cast< uint >( late_objects / 2 ) == value.toUInt() ) ) ? 0 : 1;
+    }
+    registrar.wait();
+    wait( workers );
+    QCOMPARE( wrong, 0 );
+
+    for ( int index = 1; index <= late_objects; ++index ) {
+        QCOMPARE( m_subagent->value( QtSnmpTestSupport::objectOid( 2, index ) ).toUInt(), static_cast< uint >( index ) );
+    }
+    for ( int producer = 0; producer < producers; ++producer ) {
+        QCOMPARE( m_subagent->value( own_integer( producer ) ).toInt(), updates - 1 );
+    }
+    // registered with the master by the agent thread and served
+    QVERIFY( m_master.waitUntil( [ this ]() {
+        for ( const auto& registration : m_master.registrations() ) {
+            if ( QtSnmpTestSupport::objectKey( 2, late_objects ) == registration.root ) {
+                return true;
+            }
+        }
+        return false;
+    } ) );
+    const QtSnmpFakeMaster::Response response = m_master.get( { QtSnmpTestSupport::objectKey( 2, late_objects ) } );
+    QCOMPARE( response.varbinds.size(), 1 );
+    QCOMPARE( response.varbinds.first().type, quint16( QtSnmpFakeMaster::TypeGauge32 ) );
+    QCOMPARE( response.varbinds.first().number, quint64( late_objects ) );
+}
+
+QTEST_GUILESS_MAIN( tst_Values )
+#include "tst_values.moc"
@@ -0,0 +1,3 @@
+include( $${PWD}/../tests.pri )
+TARGET = tst_values
+SOURCES *= $${PWD}/tst_values.cpp